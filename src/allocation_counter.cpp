@@ -0,0 +1,86 @@
+// allocation_counter.cpp
+
+#include "allocation_counter.hpp"
+
+#ifdef COMPILADOR_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> allocations{0};
+
+void* allocate(std::size_t size, std::size_t alignment) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) {
+        size = 1;
+    }
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+    // aligned_alloc exige um tamanho múltiplo do alinhamento
+    return std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+}
+
+} // namespace
+
+// As versões de array e as nothrow de delete usam estas por padrão
+void* operator new(std::size_t size) {
+    if (void* ptr = allocate(size, alignof(std::max_align_t))) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = allocate(size, static_cast<std::size_t>(alignment))) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+bool allocationsCounted() {
+    return true;
+}
+
+size_t allocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+#else
+
+bool allocationsCounted() {
+    return false;
+}
+
+size_t allocationCount() {
+    return 0;
+}
+
+#endif // COMPILADOR_COUNT_ALLOCATIONS
@@ -0,0 +1,15 @@
+// allocation_counter.hpp
+
+#ifndef ALLOCATION_COUNTER_HPP
+#define ALLOCATION_COUNTER_HPP
+
+#include <cstddef>
+
+// Alocações feitas pelo operator new global, usadas pelos benchmarks para medir
+// alocações por token/nó. Só o executável de benchmarks (compilado com
+// COMPILADOR_COUNT_ALLOCATIONS) troca o operator new global para contá-las; no
+// compilador o alocador padrão fica intacto e a contagem é sempre 0.
+bool allocationsCounted();
+size_t allocationCount();
+
+#endif // ALLOCATION_COUNTER_HPP
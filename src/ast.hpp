@@ -3,24 +3,96 @@
 #ifndef AST_HPP
 #define AST_HPP
 
-#include <string>
-#include <vector>
 #include <memory>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "ast_arena.hpp"
 #include "operator_type.hpp"
+#include "token.hpp"
+#include "type_table.hpp"
 
 // Declarações antecipadas
 class Visitor;
 class Value; // Certifique-se de incluir ou declarar a classe 'Value'
+class Node;
+
+// Todos os nós são alocados no AstArena da compilação e nunca são destruídos
+// individualmente: a árvore inteira é liberada junto com o arena. Por isso os
+// ponteiros entre nós não liberam nada, nomes são visões sobre texto copiado
+// para o arena e as listas usam o arena como memory_resource. Membros de nós
+// não devem possuir memória fora do arena.
+struct ArenaDeleter {
+    void operator()(Node*) const noexcept {}
+};
+
+template <typename T>
+using NodePtr = std::unique_ptr<T, ArenaDeleter>;
+
+template <typename T>
+using NodeList = std::pmr::vector<NodePtr<T>>;
+
+// Cria um nó no arena
+template <typename T, typename... Args>
+NodePtr<T> makeNode(AstArena& arena, Args&&... args) {
+    void* memory = arena.allocate(sizeof(T), alignof(T));
+    return NodePtr<T>(new (memory) T(std::forward<Args>(args)...));
+}
+
+// Classe concreta de um nó, gravada nele na construção. Passes que tratam cada
+// tipo de nó de um jeito (ex.: o otimizador) fazem um switch em Node::kind e um
+// static_cast, em vez de uma cadeia de dynamic_cast
+enum class NodeKind : uint8_t {
+    PROGRAM,
+    VARIABLE_DECLARATION,
+    ARRAY_DECLARATION,
+    ASSIGNMENT,
+    RETURN_STATEMENT,
+    IF_STATEMENT,
+    WHILE_STATEMENT,
+    FOR_STATEMENT,
+    FUNCTION,
+    BLOCK_STATEMENT,
+    EXPRESSION_STATEMENT,
+    IDENTIFIER,
+    NUMBER,
+    BOOLEAN_LITERAL,
+    BINARY_OPERATION,
+    UNARY_OPERATION,
+    FUNCTION_CALL,
+    ARRAY_ACCESS,
+};
 
 // Classe base para todos os nós do AST
 class Node {
 public:
+    const NodeKind kind;
+
+    explicit Node(NodeKind kind) : kind(kind) {}
     virtual ~Node() = default;
 };
 
+// O nó como T (uma classe concreta), ou nullptr se for de outra classe
+template <typename T>
+T* nodeAs(Node* node) {
+    return node && node->kind == T::KIND ? static_cast<T*>(node) : nullptr;
+}
+
+template <typename T>
+const T* nodeAs(const Node* node) {
+    return node && node->kind == T::KIND ? static_cast<const T*>(node) : nullptr;
+}
+
 // Classe base para todas as declarações (statements)
 class Statement : public Node {
 public:
+    // Linha do fonte onde a declaração começa; só as de nível superior a
+    // recebem do parser (0: desconhecida, ex.: árvore reconstruída do cache)
+    int line = 0;
+
+    explicit Statement(NodeKind kind) : Node(kind) {}
     virtual ~Statement() = default;
     virtual void accept(Visitor& visitor) = 0; // Retorno 'void'
 };
@@ -28,206 +100,315 @@ public:
 // Classe base para todas as expressões
 class Expression : public Node {
 public:
+    // Tipo resolvido pela análise semântica (NO_TYPE antes dela)
+    TypeId type = NO_TYPE;
+
+    explicit Expression(NodeKind kind) : Node(kind) {}
     virtual ~Expression() = default;
     virtual Value accept(Visitor& visitor) = 0; // Retorno 'Value'
 };
 
 // Definição das classes de declaração com o método accept
 
-// Representa um programa que contém uma lista de declarações
+// Representa um programa que contém uma lista de declarações.
+// É o dono dos arenas onde estão os nós da árvore (mais de um quando
+// a árvore é montada a partir de partes, como no parsing paralelo).
 class Program : public Statement {
+private:
+    std::vector<std::shared_ptr<AstArena>> arenas;
+
 public:
-    std::vector<std::unique_ptr<Statement>> statements;
+    static constexpr NodeKind KIND = NodeKind::PROGRAM;
 
-    void addStatement(std::unique_ptr<Statement> stmt) {
+    NodeList<Statement> statements;
+    uint32_t globalSlots = 0; // Variáveis globais, contadas pela análise semântica
+
+    explicit Program(std::shared_ptr<AstArena> arena)
+        : Statement(KIND), arenas{arena}, statements(arena.get()) {}
+
+    void addStatement(NodePtr<Statement> stmt) {
         statements.push_back(std::move(stmt));
     }
 
+    // Arena principal, usado para criar nós novos (ex.: no otimizador)
+    AstArena& arena() const {
+        return *arenas.front();
+    }
+
+    // Mantém vivos os arenas de outro programa cujos nós foram movidos para este
+    void adoptArenas(const Program& other) {
+        arenas.insert(arenas.end(), other.arenas.begin(), other.arenas.end());
+    }
+
     void accept(Visitor& visitor) override;
 };
 
+// Seção em que uma variável foi declarada
+enum class VarSection : uint8_t {
+    LOCAL,  // VAR (ou VAR_GLOBAL, fora das POUs)
+    INPUT,  // VAR_INPUT: parâmetro de entrada da POU
+    OUTPUT, // VAR_OUTPUT: parâmetro de saída da POU
+};
+
 class VariableDeclaration : public Statement {
 public:
-    std::string name;
-    std::string type;
-    std::unique_ptr<Expression> initializer;
+    static constexpr NodeKind KIND = NodeKind::VARIABLE_DECLARATION;
+
+    std::string_view name;
+    std::string_view type;
+    NodePtr<Expression> initializer;
+    VarSection section = VarSection::LOCAL;
+    uint32_t slot = 0; // Slot reservado pela análise semântica (global ou local)
 
-    VariableDeclaration(const std::string& name, const std::string& type, std::unique_ptr<Expression> initializer = nullptr)
-        : name(name), type(type), initializer(std::move(initializer)) {}
+    VariableDeclaration(std::string_view name, std::string_view type, NodePtr<Expression> initializer = nullptr)
+        : Statement(KIND), name(name), type(type), initializer(std::move(initializer)) {}
 
     void accept(Visitor& visitor) override;
 };
 
 class ArrayDeclaration : public Statement {
 public:
-    std::string name;
-    std::string baseType;
-    std::vector<std::pair<int, int>> dimensions;
-    std::unique_ptr<Expression> initializer;
+    static constexpr NodeKind KIND = NodeKind::ARRAY_DECLARATION;
 
-    ArrayDeclaration(const std::string& name, const std::string& baseType, const std::vector<std::pair<int, int>>& dimensions, std::unique_ptr<Expression> initializer = nullptr)
-        : name(name), baseType(baseType), dimensions(dimensions), initializer(std::move(initializer)) {}
+    std::string_view name;
+    std::string_view baseType;
+    std::pmr::vector<std::pair<int, int>> dimensions;
+    NodePtr<Expression> initializer;
+    VarSection section = VarSection::LOCAL;
+    uint32_t slot = 0; // Slot reservado pela análise semântica (global ou local)
+
+    ArrayDeclaration(std::string_view name, std::string_view baseType, std::pmr::vector<std::pair<int, int>> dimensions, NodePtr<Expression> initializer = nullptr)
+        : Statement(KIND), name(name), baseType(baseType), dimensions(std::move(dimensions)), initializer(std::move(initializer)) {}
 
     void accept(Visitor& visitor) override;
 };
 
 class Assignment : public Statement {
 public:
-    std::unique_ptr<Expression> left;
-    std::unique_ptr<Expression> right;
+    static constexpr NodeKind KIND = NodeKind::ASSIGNMENT;
+
+    NodePtr<Expression> left;
+    NodePtr<Expression> right;
 
-    Assignment(std::unique_ptr<Expression> left, std::unique_ptr<Expression> right)
-        : left(std::move(left)), right(std::move(right)) {}
+    Assignment(NodePtr<Expression> left, NodePtr<Expression> right)
+        : Statement(KIND), left(std::move(left)), right(std::move(right)) {}
 
     void accept(Visitor& visitor) override;
 };
 
 class ReturnStatement : public Statement {
 public:
-    std::unique_ptr<Expression> value;
+    static constexpr NodeKind KIND = NodeKind::RETURN_STATEMENT;
 
-    ReturnStatement(std::unique_ptr<Expression> value)
-        : value(std::move(value)) {}
+    NodePtr<Expression> value;
+
+    ReturnStatement(NodePtr<Expression> value)
+        : Statement(KIND), value(std::move(value)) {}
 
     void accept(Visitor& visitor) override;
 };
 
 class IfStatement : public Statement {
 public:
-    std::unique_ptr<Expression> condition;
-    std::unique_ptr<Statement> thenBranch;
-    std::unique_ptr<Statement> elseBranch;
+    static constexpr NodeKind KIND = NodeKind::IF_STATEMENT;
+
+    NodePtr<Expression> condition;
+    NodePtr<Statement> thenBranch;
+    NodePtr<Statement> elseBranch;
 
-    IfStatement(std::unique_ptr<Expression> condition, std::unique_ptr<Statement> thenBranch, std::unique_ptr<Statement> elseBranch = nullptr)
-        : condition(std::move(condition)), thenBranch(std::move(thenBranch)), elseBranch(std::move(elseBranch)) {}
+    IfStatement(NodePtr<Expression> condition, NodePtr<Statement> thenBranch, NodePtr<Statement> elseBranch = nullptr)
+        : Statement(KIND), condition(std::move(condition)), thenBranch(std::move(thenBranch)), elseBranch(std::move(elseBranch)) {}
 
     void accept(Visitor& visitor) override;
 };
 
 class WhileStatement : public Statement {
 public:
-    std::unique_ptr<Expression> condition;
-    std::unique_ptr<Statement> body;
+    static constexpr NodeKind KIND = NodeKind::WHILE_STATEMENT;
+
+    NodePtr<Expression> condition;
+    NodePtr<Statement> body;
 
-    WhileStatement(std::unique_ptr<Expression> condition, std::unique_ptr<Statement> body)
-        : condition(std::move(condition)), body(std::move(body)) {}
+    WhileStatement(NodePtr<Expression> condition, NodePtr<Statement> body)
+        : Statement(KIND), condition(std::move(condition)), body(std::move(body)) {}
 
     void accept(Visitor& visitor) override;
 };
 
 class ForStatement : public Statement {
 public:
-    std::unique_ptr<Assignment> initializer;
-    std::unique_ptr<Expression> endCondition;
-    std::unique_ptr<Statement> body;
+    static constexpr NodeKind KIND = NodeKind::FOR_STATEMENT;
 
-    ForStatement(std::unique_ptr<Assignment> initializer, std::unique_ptr<Expression> endCondition, std::unique_ptr<Statement> body)
-        : initializer(std::move(initializer)), endCondition(std::move(endCondition)), body(std::move(body)) {}
+    NodePtr<Assignment> initializer;
+    NodePtr<Expression> endCondition;
+    NodePtr<Statement> body;
+
+    ForStatement(NodePtr<Assignment> initializer, NodePtr<Expression> endCondition, NodePtr<Statement> body)
+        : Statement(KIND), initializer(std::move(initializer)), endCondition(std::move(endCondition)), body(std::move(body)) {}
 
     void accept(Visitor& visitor) override;
 };
 
+// Tipo de unidade de programa representada por um Function
+enum class PouKind : uint8_t {
+    FUNCTION,
+    FUNCTION_BLOCK,
+    PROGRAM,
+};
+
 class Function : public Statement {
 public:
-    std::string name;
-    std::string returnType;
-    std::vector<std::unique_ptr<Statement>> body;
+    static constexpr NodeKind KIND = NodeKind::FUNCTION;
 
-    Function(const std::string& name) : name(name) {}
+    std::string_view name;
+    std::string_view returnType;
+    NodeList<Statement> body;
+    PouKind pouKind;
+    uint32_t frameSlots = 0; // Variáveis locais, contadas pela análise semântica
+
+    Function(std::string_view name, std::string_view returnType, NodeList<Statement> body, PouKind pouKind = PouKind::FUNCTION)
+        : Statement(KIND), name(name), returnType(returnType), body(std::move(body)), pouKind(pouKind) {}
 
     void accept(Visitor& visitor) override;
 };
 
 class BlockStatement : public Statement {
 public:
-    std::vector<std::unique_ptr<Statement>> statements;
+    static constexpr NodeKind KIND = NodeKind::BLOCK_STATEMENT;
+
+    NodeList<Statement> statements;
 
-    BlockStatement(std::vector<std::unique_ptr<Statement>> statements)
-        : statements(std::move(statements)) {}
+    BlockStatement(NodeList<Statement> statements)
+        : Statement(KIND), statements(std::move(statements)) {}
 
     void accept(Visitor& visitor) override;
 };
 
 class ExpressionStatement : public Statement {
 public:
-    std::unique_ptr<Expression> expression;
+    static constexpr NodeKind KIND = NodeKind::EXPRESSION_STATEMENT;
+
+    NodePtr<Expression> expression;
 
-    ExpressionStatement(std::unique_ptr<Expression> expression)
-        : expression(std::move(expression)) {}
+    ExpressionStatement(NodePtr<Expression> expression)
+        : Statement(KIND), expression(std::move(expression)) {}
 
     void accept(Visitor& visitor) override;
 };
 
 // Definição das classes de expressão com o método accept
 
+// Onde está a variável de um Identifier, segundo a análise semântica
+enum class Storage : uint8_t {
+    UNRESOLVED,
+    GLOBAL, // slot em Program::globalSlots
+    LOCAL,  // slot no quadro da POU (Function::frameSlots)
+    RESULT, // Nome da função: o valor de retorno
+};
+
 class Identifier : public Expression {
 public:
-    std::string name;
+    static constexpr NodeKind KIND = NodeKind::IDENTIFIER;
 
-    Identifier(const std::string& name) : name(name) {}
+    std::string_view name;
+    Storage storage = Storage::UNRESOLVED;
+    uint32_t slot = 0;
+
+    Identifier(std::string_view name) : Expression(KIND), name(name) {}
 
     Value accept(Visitor& visitor) override;
 };
 
 class Number : public Expression {
 public:
+    static constexpr NodeKind KIND = NodeKind::NUMBER;
+
     double value;
+    LiteralKind literal; // Como foi escrito: INTEGER ou REAL (um '7.0' é REAL)
 
-    Number(double value) : value(value) {}
+    Number(double value, LiteralKind literal) : Expression(KIND), value(value), literal(literal) {}
 
     Value accept(Visitor& visitor) override;
 };
 
 class BooleanLiteral : public Expression {
 public:
+    static constexpr NodeKind KIND = NodeKind::BOOLEAN_LITERAL;
+
     bool value;
 
-    BooleanLiteral(bool value) : value(value) {}
+    BooleanLiteral(bool value) : Expression(KIND), value(value) {}
 
     Value accept(Visitor& visitor) override;
 };
 
 class BinaryOperation : public Expression {
 public:
+    static constexpr NodeKind KIND = NodeKind::BINARY_OPERATION;
+
     OperatorType op;
-    std::unique_ptr<Expression> left;
-    std::unique_ptr<Expression> right;
+    NodePtr<Expression> left;
+    NodePtr<Expression> right;
 
-    BinaryOperation(OperatorType op, std::unique_ptr<Expression> left, std::unique_ptr<Expression> right)
-        : op(op), left(std::move(left)), right(std::move(right)) {}
+    BinaryOperation(OperatorType op, NodePtr<Expression> left, NodePtr<Expression> right)
+        : Expression(KIND), op(op), left(std::move(left)), right(std::move(right)) {}
 
     Value accept(Visitor& visitor) override;
 };
 
 class UnaryOperation : public Expression {
 public:
+    static constexpr NodeKind KIND = NodeKind::UNARY_OPERATION;
+
     OperatorType op;
-    std::unique_ptr<Expression> operand;
+    NodePtr<Expression> operand;
 
-    UnaryOperation(OperatorType op, std::unique_ptr<Expression> operand)
-        : op(op), operand(std::move(operand)) {}
+    UnaryOperation(OperatorType op, NodePtr<Expression> operand)
+        : Expression(KIND), op(op), operand(std::move(operand)) {}
 
     Value accept(Visitor& visitor) override;
 };
 
+// Como um argumento de uma chamada chega ao parâmetro da POU chamada
+struct ArgumentBinding {
+    std::string_view parameter; // Nome dado na chamada ('x := 1', 'y => v'); vazio se posicional
+    bool output = false;        // 'y => v': a variável recebe a saída 'y' depois da chamada
+    uint32_t slot = 0;          // Slot do parâmetro no quadro da POU chamada (análise semântica)
+};
+
 class FunctionCall : public Expression {
 public:
-    std::string functionName;
-    std::vector<std::unique_ptr<Expression>> arguments;
+    static constexpr NodeKind KIND = NodeKind::FUNCTION_CALL;
+
+    std::string_view functionName;
+    NodeList<Expression> arguments;
+    std::pmr::vector<ArgumentBinding> bindings; // Um por argumento
+
+    // Ligados pela análise semântica: a POU chamada e, numa chamada de
+    // instância de bloco funcional, onde está a instância (UNRESOLVED numa função)
+    Function* callee = nullptr;
+    Storage storage = Storage::UNRESOLVED;
+    uint32_t slot = 0;
 
-    FunctionCall(const std::string& functionName, std::vector<std::unique_ptr<Expression>> arguments)
-        : functionName(functionName), arguments(std::move(arguments)) {}
+    FunctionCall(std::string_view functionName, NodeList<Expression> arguments)
+        : Expression(KIND), functionName(functionName), arguments(std::move(arguments)),
+          bindings(this->arguments.size(), this->arguments.get_allocator()) {}
+
+    FunctionCall(std::string_view functionName, NodeList<Expression> arguments, std::pmr::vector<ArgumentBinding> bindings)
+        : Expression(KIND), functionName(functionName), arguments(std::move(arguments)), bindings(std::move(bindings)) {}
 
     Value accept(Visitor& visitor) override;
 };
 
 class ArrayAccess : public Expression {
 public:
-    std::unique_ptr<Expression> array;
-    std::vector<std::unique_ptr<Expression>> indices;
+    static constexpr NodeKind KIND = NodeKind::ARRAY_ACCESS;
+
+    NodePtr<Expression> array;
+    NodeList<Expression> indices;
 
-    ArrayAccess(std::unique_ptr<Expression> array, std::vector<std::unique_ptr<Expression>> indices)
-        : array(std::move(array)), indices(std::move(indices)) {}
+    ArrayAccess(NodePtr<Expression> array, NodeList<Expression> indices)
+        : Expression(KIND), array(std::move(array)), indices(std::move(indices)) {}
 
     Value accept(Visitor& visitor) override;
 };
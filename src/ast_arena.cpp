@@ -0,0 +1,55 @@
+// ast_arena.cpp
+
+#include "ast_arena.hpp"
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+AstArena::~AstArena() {
+    while (blocks) {
+        Block* next = blocks->next;
+        ::operator delete(blocks);
+        blocks = next;
+    }
+}
+
+std::string_view AstArena::copyString(std::string_view text) {
+    if (text.empty()) return {};
+    char* copy = static_cast<char*>(allocate(text.size(), 1));
+    std::memcpy(copy, text.data(), text.size());
+    return std::string_view(copy, text.size());
+}
+
+void* AstArena::do_allocate(size_t bytes, size_t alignment) {
+    auto address = reinterpret_cast<uintptr_t>(cursor);
+    uintptr_t aligned = (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    if (!cursor || aligned + bytes > reinterpret_cast<uintptr_t>(limit)) {
+        grow(bytes + alignment);
+        address = reinterpret_cast<uintptr_t>(cursor);
+        aligned = (address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    }
+    cursor = reinterpret_cast<char*>(aligned + bytes);
+    used += bytes;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void AstArena::do_deallocate(void*, size_t, size_t) {
+    // A memória só é devolvida quando o arena inteiro é destruído
+}
+
+bool AstArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void AstArena::grow(size_t minimum) {
+    // Blocos dobram de tamanho até 1 MiB para manter poucas alocações
+    size_t size = nextBlockSize;
+    while (size < minimum) size *= 2;
+    if (nextBlockSize < 1024 * 1024) nextBlockSize *= 2;
+
+    auto* block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+    block->next = blocks;
+    blocks = block;
+    cursor = reinterpret_cast<char*>(block + 1);
+    limit = cursor + size;
+}
@@ -0,0 +1,49 @@
+// ast_arena.hpp
+
+#ifndef AST_ARENA_HPP
+#define AST_ARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <string_view>
+
+// Alocador por incremento (bump) que possui todos os nós do AST de uma compilação.
+// Nada é liberado individualmente: os blocos são devolvidos de uma vez quando o
+// arena é destruído. Também serve de memory_resource para os std::pmr::vector
+// e guarda as cópias dos nomes usados pelos nós.
+class AstArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t FIRST_BLOCK_SIZE = 64 * 1024;
+
+    // Arenas de árvores pequenas (ex.: uma única POU) podem começar com um bloco menor
+    explicit AstArena(size_t firstBlockSize = FIRST_BLOCK_SIZE) : nextBlockSize(firstBlockSize) {}
+    ~AstArena() override;
+
+    AstArena(const AstArena&) = delete;
+    AstArena& operator=(const AstArena&) = delete;
+
+    // Copia o texto para o arena; a visão devolvida vive tanto quanto o arena
+    std::string_view copyString(std::string_view text);
+
+    size_t bytesAllocated() const { return used; }
+
+private:
+    // Cabeçalho de cada bloco; os dados vêm logo em seguida
+    struct Block {
+        Block* next;
+    };
+
+    Block* blocks = nullptr;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t nextBlockSize;
+    size_t used = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    void grow(size_t minimum);
+};
+
+#endif // AST_ARENA_HPP
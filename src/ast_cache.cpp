@@ -0,0 +1,182 @@
+// ast_cache.cpp
+
+#include "ast_cache.hpp"
+#include "source_hash.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+constexpr uint32_t CACHE_MAGIC = 0x43415453; // "STAC"; lido ao contrário em outra ordem de bytes
+
+enum Section {
+    NODES,
+    CHILDREN,
+    DIMENSIONS,
+    NUMBERS,
+    NAME_TEXT,
+    NAME_OFFSETS,
+    NAME_LENGTHS,
+    SECTION_COUNT
+};
+
+// Posição de um array no arquivo: deslocamento desde o início e número de elementos
+struct CacheSection {
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    CacheSection sections[SECTION_COUNT];
+};
+
+constexpr size_t SECTION_ALIGNMENT = 8;
+
+static_assert(std::is_trivially_copyable_v<FlatNode> && sizeof(FlatNode) == 24,
+              "Mudar FlatNode exige incrementar AstCache::FORMAT_VERSION");
+static_assert(sizeof(CacheHeader) % SECTION_ALIGNMENT == 0);
+
+// Visão tipada de uma seção, se ela estiver alinhada e dentro do arquivo
+template <typename T>
+bool sectionView(std::string_view file, const CacheSection& section, std::span<const T>& view) {
+    if (section.offset % alignof(T) != 0 || section.offset > file.size() ||
+        section.count > (file.size() - section.offset) / sizeof(T)) {
+        return false;
+    }
+    view = std::span<const T>(reinterpret_cast<const T*>(file.data() + section.offset), section.count);
+    return true;
+}
+
+} // namespace
+
+AstCache::AstCache(std::string directory) : directory(std::move(directory)) {}
+
+std::string AstCache::entryPath(uint64_t sourceHash) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.stac", static_cast<unsigned long long>(sourceHash));
+    return (std::filesystem::path(directory) / name).string();
+}
+
+std::optional<FlatAst> AstCache::load(std::string_view source) const {
+    uint64_t hash = hashSource(source);
+    std::string path = entryPath(hash);
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        return std::nullopt;
+    }
+
+    std::shared_ptr<const SourceFile> mapping;
+    try {
+        mapping = std::make_shared<const SourceFile>(path);
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+    std::string_view file = mapping->text();
+
+    // O cabeçalho e os limites das seções protegem contra arquivos truncados, de
+    // outra versão ou de outro fonte; uma passada sobre os nós, contra conteúdo
+    // corrompido, que seria lido fora das seções ao reconstruir a árvore
+    CacheHeader header;
+    if (file.size() < sizeof(header)) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != CACHE_MAGIC || header.version != FORMAT_VERSION ||
+        header.sourceHash != hash || header.sourceSize != source.size()) {
+        return std::nullopt;
+    }
+
+    FlatAst ast;
+    std::span<const char> nameText;
+    const CacheSection* sections = header.sections;
+    if (!sectionView(file, sections[NODES], ast.nodes) ||
+        !sectionView(file, sections[CHILDREN], ast.children) ||
+        !sectionView(file, sections[DIMENSIONS], ast.dimensions) ||
+        !sectionView(file, sections[NUMBERS], ast.numbers) ||
+        !sectionView(file, sections[NAME_TEXT], nameText) ||
+        !sectionView(file, sections[NAME_OFFSETS], ast.nameOffsets) ||
+        !sectionView(file, sections[NAME_LENGTHS], ast.nameLengths)) {
+        return std::nullopt;
+    }
+    ast.nameText = std::string_view(nameText.data(), nameText.size());
+    if (!ast.isWellFormed()) {
+        return std::nullopt;
+    }
+    ast.mapping = std::move(mapping);
+    return ast;
+}
+
+bool AstCache::store(std::string_view source, const FlatAst& ast) const {
+    CacheHeader header{};
+    header.magic = CACHE_MAGIC;
+    header.version = FORMAT_VERSION;
+    header.sourceHash = hashSource(source);
+    header.sourceSize = source.size();
+
+    // Conteúdo de cada seção, na ordem de Section
+    struct Payload {
+        const void* data;
+        size_t count;
+        size_t elementSize;
+    };
+    const Payload payloads[SECTION_COUNT] = {
+        {ast.nodes.data(), ast.nodes.size(), sizeof(FlatNode)},
+        {ast.children.data(), ast.children.size(), sizeof(NodeId)},
+        {ast.dimensions.data(), ast.dimensions.size(), sizeof(std::pair<int, int>)},
+        {ast.numbers.data(), ast.numbers.size(), sizeof(double)},
+        {ast.nameText.data(), ast.nameText.size(), 1},
+        {ast.nameOffsets.data(), ast.nameOffsets.size(), sizeof(uint32_t)},
+        {ast.nameLengths.data(), ast.nameLengths.size(), sizeof(uint32_t)},
+    };
+    uint64_t offset = sizeof(header);
+    for (int i = 0; i < SECTION_COUNT; i++) {
+        offset = (offset + SECTION_ALIGNMENT - 1) & ~uint64_t{SECTION_ALIGNMENT - 1};
+        header.sections[i] = {offset, payloads[i].count};
+        offset += payloads[i].count * payloads[i].elementSize;
+    }
+
+    // Grava num arquivo temporário e renomeia: quem carrega o cache ao mesmo
+    // tempo nunca vê uma entrada pela metade
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    std::string path = entryPath(header.sourceHash);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        const char padding[SECTION_ALIGNMENT] = {};
+        uint64_t written = sizeof(header);
+        for (int i = 0; i < SECTION_COUNT; i++) {
+            file.write(padding, static_cast<std::streamsize>(header.sections[i].offset - written));
+            size_t bytes = payloads[i].count * payloads[i].elementSize;
+            if (bytes > 0) {
+                file.write(static_cast<const char*>(payloads[i].data), static_cast<std::streamsize>(bytes));
+            }
+            written = header.sections[i].offset + bytes;
+        }
+        if (!file) {
+            file.close();
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,42 @@
+// ast_cache.hpp
+
+#ifndef AST_CACHE_HPP
+#define AST_CACHE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "flat_ast.hpp"
+
+// Cache em disco de ASTs, indexado pelo hash do fonte (hashSource).
+// Cada entrada é um FlatAst serializado num formato binário versionado: um
+// cabeçalho seguido dos arrays do FlatAst, alinhados a 8 bytes e localizados
+// por deslocamentos relativos ao início do arquivo. Carregar uma entrada é
+// mapear o arquivo e apontar as visões do FlatAst para o mapeamento: nenhum
+// nó é lido ou convertido.
+//
+// O formato usa a ordem de bytes e o layout de FlatNode da máquina, então o
+// cache é local. Entradas de outra versão do formato são ignoradas.
+class AstCache {
+public:
+    // Incrementar ao mudar o cabeçalho, FlatNode, FlatKind ou o significado dos campos
+    static constexpr uint32_t FORMAT_VERSION = 4;
+
+    explicit AstCache(std::string directory);
+
+    // AST do fonte, se houver uma entrada válida para ele
+    std::optional<FlatAst> load(std::string_view source) const;
+
+    // Grava (ou substitui) a entrada do fonte. Falhas de escrita não são erros
+    // de compilação: devolve false e o cache simplesmente não é usado.
+    bool store(std::string_view source, const FlatAst& ast) const;
+
+    // Arquivo da entrada de um fonte com este hash
+    std::string entryPath(uint64_t sourceHash) const;
+
+private:
+    std::string directory;
+};
+
+#endif // AST_CACHE_HPP
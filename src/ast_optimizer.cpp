@@ -1,113 +1,948 @@
 // ast_optimizer.cpp
 
 #include "ast_optimizer.hpp"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+using Rule = SimplificationRule;
+using Side = SimplificationRule::Side;
+using Rewrite = SimplificationRule::Rewrite;
+constexpr uint8_t INTEGER = Rule::ON_INTEGER;
+constexpr uint8_t NUMERIC = Rule::ON_INTEGER | Rule::ON_REAL;
+constexpr uint8_t BOOLEAN = Rule::ON_BOOLEAN;
+
+// Regras de simplificação, na ordem em que são tentadas. As do REAL seguem a
+// aritmética IEEE do Interpreter: x - 0, x * 1, x / 1, x * -1, x / -1 e x * 2
+// (como x + x) são exatas para todo x, inclusive -0.0, infinitos e NaN
+constexpr Rule RULES[] = {
+    {"x + 0", OperatorType::ADD, Side::RIGHT, 0, INTEGER, Rewrite::OTHER},
+    {"0 + x", OperatorType::ADD, Side::LEFT, 0, INTEGER, Rewrite::OTHER},
+    {"x - 0", OperatorType::SUBTRACT, Side::RIGHT, 0, NUMERIC, Rewrite::OTHER},
+    {"x * 1", OperatorType::MULTIPLY, Side::RIGHT, 1, NUMERIC, Rewrite::OTHER},
+    {"1 * x", OperatorType::MULTIPLY, Side::LEFT, 1, NUMERIC, Rewrite::OTHER},
+    {"x / 1", OperatorType::DIVIDE, Side::RIGHT, 1, NUMERIC, Rewrite::OTHER},
+    {"x * 0", OperatorType::MULTIPLY, Side::RIGHT, 0, INTEGER, Rewrite::CONSTANT},
+    {"0 * x", OperatorType::MULTIPLY, Side::LEFT, 0, INTEGER, Rewrite::CONSTANT},
+    {"x * -1", OperatorType::MULTIPLY, Side::RIGHT, -1, NUMERIC, Rewrite::NEGATE},
+    {"-1 * x", OperatorType::MULTIPLY, Side::LEFT, -1, NUMERIC, Rewrite::NEGATE},
+    {"x / -1", OperatorType::DIVIDE, Side::RIGHT, -1, NUMERIC, Rewrite::NEGATE},
+    {"x * 2", OperatorType::MULTIPLY, Side::RIGHT, 2, NUMERIC, Rewrite::DOUBLE},
+    {"2 * x", OperatorType::MULTIPLY, Side::LEFT, 2, NUMERIC, Rewrite::DOUBLE},
+    {"b AND TRUE", OperatorType::AND, Side::RIGHT, 1, BOOLEAN, Rewrite::OTHER},
+    {"TRUE AND b", OperatorType::AND, Side::LEFT, 1, BOOLEAN, Rewrite::OTHER},
+    {"b AND FALSE", OperatorType::AND, Side::RIGHT, 0, BOOLEAN, Rewrite::CONSTANT},
+    {"FALSE AND b", OperatorType::AND, Side::LEFT, 0, BOOLEAN, Rewrite::CONSTANT},
+    {"b OR FALSE", OperatorType::OR, Side::RIGHT, 0, BOOLEAN, Rewrite::OTHER},
+    {"FALSE OR b", OperatorType::OR, Side::LEFT, 0, BOOLEAN, Rewrite::OTHER},
+    {"b OR TRUE", OperatorType::OR, Side::RIGHT, 1, BOOLEAN, Rewrite::CONSTANT},
+    {"TRUE OR b", OperatorType::OR, Side::LEFT, 1, BOOLEAN, Rewrite::CONSTANT},
+    {"b = TRUE", OperatorType::EQUAL_EQUAL, Side::RIGHT, 1, BOOLEAN, Rewrite::OTHER},
+    {"TRUE = b", OperatorType::EQUAL_EQUAL, Side::LEFT, 1, BOOLEAN, Rewrite::OTHER},
+    {"b != FALSE", OperatorType::NOT_EQUAL, Side::RIGHT, 0, BOOLEAN, Rewrite::OTHER},
+    {"FALSE != b", OperatorType::NOT_EQUAL, Side::LEFT, 0, BOOLEAN, Rewrite::OTHER},
+    {"NOT NOT b", OperatorType::NOT, Side::RIGHT, 0, BOOLEAN, Rewrite::INNER},
+    {"-(-x)", OperatorType::SUBTRACT, Side::RIGHT, 0, NUMERIC, Rewrite::INNER}, // INTEGER: o estouro dá a volta nos dois sentidos
+};
+
+// Tipos de resultado (Rule::ON_*) de uma expressão anotada
+uint8_t typeFlag(TypeId type) {
+    switch (type) {
+        case TypeTable::INTEGER: return Rule::ON_INTEGER;
+        case TypeTable::REAL: return Rule::ON_REAL;
+        case TypeTable::BOOLEAN: return Rule::ON_BOOLEAN;
+        default: return 0;
+    }
+}
+
+// O operando é a constante da regra (um Number nas numéricas, um BooleanLiteral nas BOOLEAN)
+bool matchesConstant(const Rule& rule, const Expression& operand) {
+    if (rule.types == BOOLEAN) {
+        auto literal = nodeAs<BooleanLiteral>(&operand);
+        return literal && literal->value == (rule.constant != 0);
+    }
+    // O sinal também conta: -0.0 == 0, mas x - (-0.0) dá +0.0 quando x é -0.0
+    auto number = nodeAs<Number>(&operand);
+    return number && (number->type == TypeTable::INTEGER || number->type == TypeTable::REAL) &&
+           number->value == rule.constant && std::signbit(number->value) == std::signbit(rule.constant);
+}
+
+// Avaliar a expressão não tem efeito nem pode falhar: pode ser descartada sem
+// mudar a execução. Chamadas, acessos a array e divisões por não constantes ficam
+bool canDiscard(const Expression* expr) {
+    switch (expr->kind) {
+        case NodeKind::IDENTIFIER:
+        case NodeKind::NUMBER:
+        case NodeKind::BOOLEAN_LITERAL:
+            return true;
+        case NodeKind::UNARY_OPERATION:
+            return canDiscard(static_cast<const UnaryOperation*>(expr)->operand.get());
+        case NodeKind::BINARY_OPERATION: {
+            auto binOp = static_cast<const BinaryOperation*>(expr);
+            if (binOp->op == OperatorType::DIVIDE) {
+                auto divisor = nodeAs<Number>(binOp->right.get());
+                if (!divisor || divisor->value == 0) {
+                    return false;
+                }
+            }
+            return canDiscard(binOp->left.get()) && canDiscard(binOp->right.get());
+        }
+        default:
+            return false;
+    }
+}
+
+// Valor de execução de uma constante já anotada pela análise semântica: um Number
+// lido como o Interpreter o lê (pelo tipo anotado) ou um BooleanLiteral
+bool constantValue(const Expression& expr, Value& value) {
+    if (expr.kind == NodeKind::BOOLEAN_LITERAL) {
+        value = Value(static_cast<const BooleanLiteral&>(expr).value);
+        return true;
+    }
+    if (expr.kind != NodeKind::NUMBER) {
+        return false;
+    }
+    double number = static_cast<const Number&>(expr).value;
+    if (expr.type == TypeTable::REAL) {
+        value = Value(number);
+        return true;
+    }
+    if (expr.type == TypeTable::INTEGER && number >= std::numeric_limits<int>::min() &&
+        number <= std::numeric_limits<int>::max()) {
+        value = Value(static_cast<int>(number));
+        return true;
+    }
+    return false; // Sem tipo (programa não analisado) ou fora do INTEGER de execução
+}
+
+// Resultado INTEGER, se couber no int da execução; um estouro fica para a execução
+bool integerResult(int64_t value, Value& result) {
+    if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    result = Value(static_cast<int>(value));
+    return true;
+}
+
+// Dobra 'left op right' com a semântica do Interpreter: aritmética e comparações
+// INTEGER quando os dois operandos são INTEGER, senão REAL. Não dobra o que
+// falharia na execução (divisão por zero, estouro, ordem entre BOOLEANs) nem
+// resultados REAL não finitos
+bool foldBinary(OperatorType op, const Value& left, const Value& right, Value& result) {
+    using Type = Value::Type;
+    if (left.getType() == Type::BOOLEAN || right.getType() == Type::BOOLEAN) {
+        if (left.getType() != right.getType()) {
+            return false;
+        }
+        bool l = left.getBoolValue();
+        bool r = right.getBoolValue();
+        switch (op) {
+            case OperatorType::AND: result = Value(l && r); return true;
+            case OperatorType::OR: result = Value(l || r); return true;
+            case OperatorType::EQUAL_EQUAL: result = Value(l == r); return true;
+            case OperatorType::NOT_EQUAL: result = Value(l != r); return true;
+            default: return false;
+        }
+    }
+
+    if (left.getType() == Type::INTEGER && right.getType() == Type::INTEGER) {
+        int64_t l = left.getIntValue();
+        int64_t r = right.getIntValue();
+        switch (op) {
+            case OperatorType::ADD: return integerResult(l + r, result);
+            case OperatorType::SUBTRACT: return integerResult(l - r, result);
+            case OperatorType::MULTIPLY: return integerResult(l * r, result);
+            case OperatorType::DIVIDE: return r != 0 && integerResult(l / r, result); // Trunca, como em C++
+            case OperatorType::LESS: result = Value(l < r); return true;
+            case OperatorType::LESS_EQUAL: result = Value(l <= r); return true;
+            case OperatorType::GREATER: result = Value(l > r); return true;
+            case OperatorType::GREATER_EQUAL: result = Value(l >= r); return true;
+            case OperatorType::EQUAL_EQUAL: result = Value(l == r); return true;
+            case OperatorType::NOT_EQUAL: result = Value(l != r); return true;
+            default: return false;
+        }
+    }
+
+    double l = left.getRealValue();
+    double r = right.getRealValue();
+    double value;
+    switch (op) {
+        case OperatorType::ADD: value = l + r; break;
+        case OperatorType::SUBTRACT: value = l - r; break;
+        case OperatorType::MULTIPLY: value = l * r; break;
+        case OperatorType::DIVIDE:
+            if (r == 0.0) {
+                return false;
+            }
+            value = l / r;
+            break;
+        case OperatorType::LESS: result = Value(l < r); return true;
+        case OperatorType::LESS_EQUAL: result = Value(l <= r); return true;
+        case OperatorType::GREATER: result = Value(l > r); return true;
+        case OperatorType::GREATER_EQUAL: result = Value(l >= r); return true;
+        case OperatorType::EQUAL_EQUAL: result = Value(l == r); return true;
+        case OperatorType::NOT_EQUAL: result = Value(l != r); return true;
+        default: return false;
+    }
+    if (!std::isfinite(value)) {
+        return false;
+    }
+    result = Value(value);
+    return true;
+}
+
+bool foldUnary(OperatorType op, const Value& operand, Value& result) {
+    switch (op) {
+        case OperatorType::SUBTRACT:
+            if (operand.getType() == Value::Type::INTEGER) {
+                return integerResult(-static_cast<int64_t>(operand.getIntValue()), result);
+            }
+            if (operand.getType() == Value::Type::REAL) {
+                result = Value(-operand.getRealValue());
+                return true;
+            }
+            return false;
+        case OperatorType::NOT:
+            if (operand.getType() != Value::Type::BOOLEAN) {
+                return false;
+            }
+            result = Value(!operand.getBoolValue());
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Nós da subárvore de 'node' (0 se nulo)
+size_t countNodes(const Node* node) {
+    if (!node) {
+        return 0;
+    }
+    size_t count = 1;
+    auto list = [&](const auto& nodes) {
+        for (const auto& child : nodes) count += countNodes(child.get());
+    };
+    switch (node->kind) {
+        case NodeKind::PROGRAM: list(static_cast<const Program*>(node)->statements); break;
+        case NodeKind::VARIABLE_DECLARATION: count += countNodes(static_cast<const VariableDeclaration*>(node)->initializer.get()); break;
+        case NodeKind::ARRAY_DECLARATION: count += countNodes(static_cast<const ArrayDeclaration*>(node)->initializer.get()); break;
+        case NodeKind::ASSIGNMENT: {
+            auto assignment = static_cast<const Assignment*>(node);
+            count += countNodes(assignment->left.get()) + countNodes(assignment->right.get());
+            break;
+        }
+        case NodeKind::RETURN_STATEMENT: count += countNodes(static_cast<const ReturnStatement*>(node)->value.get()); break;
+        case NodeKind::IF_STATEMENT: {
+            auto ifStmt = static_cast<const IfStatement*>(node);
+            count += countNodes(ifStmt->condition.get()) + countNodes(ifStmt->thenBranch.get()) + countNodes(ifStmt->elseBranch.get());
+            break;
+        }
+        case NodeKind::WHILE_STATEMENT: {
+            auto whileStmt = static_cast<const WhileStatement*>(node);
+            count += countNodes(whileStmt->condition.get()) + countNodes(whileStmt->body.get());
+            break;
+        }
+        case NodeKind::FOR_STATEMENT: {
+            auto forStmt = static_cast<const ForStatement*>(node);
+            count += countNodes(forStmt->initializer.get()) + countNodes(forStmt->endCondition.get()) + countNodes(forStmt->body.get());
+            break;
+        }
+        case NodeKind::FUNCTION: list(static_cast<const Function*>(node)->body); break;
+        case NodeKind::BLOCK_STATEMENT: list(static_cast<const BlockStatement*>(node)->statements); break;
+        case NodeKind::EXPRESSION_STATEMENT: count += countNodes(static_cast<const ExpressionStatement*>(node)->expression.get()); break;
+        case NodeKind::BINARY_OPERATION: {
+            auto binOp = static_cast<const BinaryOperation*>(node);
+            count += countNodes(binOp->left.get()) + countNodes(binOp->right.get());
+            break;
+        }
+        case NodeKind::UNARY_OPERATION: count += countNodes(static_cast<const UnaryOperation*>(node)->operand.get()); break;
+        case NodeKind::FUNCTION_CALL: list(static_cast<const FunctionCall*>(node)->arguments); break;
+        case NodeKind::ARRAY_ACCESS: {
+            auto arrayAccess = static_cast<const ArrayAccess*>(node);
+            count += countNodes(arrayAccess->array.get());
+            list(arrayAccess->indices);
+            break;
+        }
+        default:
+            break;
+    }
+    return count;
+}
+
+bool isEmptyBlock(const Statement* stmt) {
+    return stmt->kind == NodeKind::BLOCK_STATEMENT && static_cast<const BlockStatement*>(stmt)->statements.empty();
+}
+
+// Todo caminho pelo comando termina num RETURN: o que vem depois dele na lista nunca executa
+bool alwaysReturns(const Statement* stmt) {
+    switch (stmt->kind) {
+        case NodeKind::RETURN_STATEMENT:
+            return true;
+        case NodeKind::BLOCK_STATEMENT: {
+            // Os comandos depois de um que sempre retorna já foram removidos
+            auto& statements = static_cast<const BlockStatement*>(stmt)->statements;
+            return !statements.empty() && alwaysReturns(statements.back().get());
+        }
+        case NodeKind::IF_STATEMENT: {
+            auto ifStmt = static_cast<const IfStatement*>(stmt);
+            return ifStmt->elseBranch && alwaysReturns(ifStmt->thenBranch.get()) && alwaysReturns(ifStmt->elseBranch.get());
+        }
+        default:
+            return false;
+    }
+}
+
+// Chave de uma variável na numeração de valores (o resultado da POU não tem slot)
+uint64_t variableKey(Storage storage, uint32_t slot) {
+    return static_cast<uint64_t>(storage) << 32 | (storage == Storage::RESULT ? 0 : slot);
+}
+
+// A expressão não chama nenhuma POU
+bool isPure(const Expression* expr) {
+    switch (expr->kind) {
+        case NodeKind::FUNCTION_CALL:
+            return false;
+        case NodeKind::BINARY_OPERATION: {
+            auto binOp = static_cast<const BinaryOperation*>(expr);
+            return isPure(binOp->left.get()) && isPure(binOp->right.get());
+        }
+        case NodeKind::UNARY_OPERATION:
+            return isPure(static_cast<const UnaryOperation*>(expr)->operand.get());
+        case NodeKind::ARRAY_ACCESS: {
+            auto arrayAccess = static_cast<const ArrayAccess*>(expr);
+            return isPure(arrayAccess->array.get()) &&
+                   std::all_of(arrayAccess->indices.begin(), arrayAccess->indices.end(),
+                               [](const auto& index) { return isPure(index.get()); });
+        }
+        default:
+            return true;
+    }
+}
+
+// Junta em 'writes' as variáveis em que o comando pode escrever. Devolve false se
+// ele chama alguma POU, que pode escrever em qualquer global e, com 'y => v', em
+// variáveis de quem chama
+bool collectWrites(const Statement* stmt, std::vector<uint64_t>& writes) {
+    if (!stmt) {
+        return true;
+    }
+    switch (stmt->kind) {
+        case NodeKind::ASSIGNMENT: {
+            auto assignment = static_cast<const Assignment*>(stmt);
+            const Expression* target = assignment->left.get();
+            if (auto arrayAccess = nodeAs<ArrayAccess>(target)) {
+                target = arrayAccess->array.get();
+            }
+            if (auto variable = nodeAs<Identifier>(target)) {
+                writes.push_back(variableKey(variable->storage, variable->slot));
+            }
+            return isPure(assignment->left.get()) && isPure(assignment->right.get());
+        }
+        case NodeKind::VARIABLE_DECLARATION: {
+            auto varDecl = static_cast<const VariableDeclaration*>(stmt);
+            writes.push_back(variableKey(Storage::LOCAL, varDecl->slot));
+            return !varDecl->initializer || isPure(varDecl->initializer.get());
+        }
+        case NodeKind::ARRAY_DECLARATION: {
+            auto arrayDecl = static_cast<const ArrayDeclaration*>(stmt);
+            writes.push_back(variableKey(Storage::LOCAL, arrayDecl->slot));
+            return !arrayDecl->initializer || isPure(arrayDecl->initializer.get());
+        }
+        case NodeKind::RETURN_STATEMENT:
+            writes.push_back(variableKey(Storage::RESULT, 0));
+            return isPure(static_cast<const ReturnStatement*>(stmt)->value.get());
+        case NodeKind::IF_STATEMENT: {
+            auto ifStmt = static_cast<const IfStatement*>(stmt);
+            return isPure(ifStmt->condition.get()) && collectWrites(ifStmt->thenBranch.get(), writes) &&
+                   collectWrites(ifStmt->elseBranch.get(), writes);
+        }
+        case NodeKind::WHILE_STATEMENT: {
+            auto whileStmt = static_cast<const WhileStatement*>(stmt);
+            return isPure(whileStmt->condition.get()) && collectWrites(whileStmt->body.get(), writes);
+        }
+        case NodeKind::FOR_STATEMENT: {
+            auto forStmt = static_cast<const ForStatement*>(stmt);
+            return collectWrites(forStmt->initializer.get(), writes) && isPure(forStmt->endCondition.get()) &&
+                   collectWrites(forStmt->body.get(), writes);
+        }
+        case NodeKind::BLOCK_STATEMENT:
+            return std::all_of(static_cast<const BlockStatement*>(stmt)->statements.begin(),
+                               static_cast<const BlockStatement*>(stmt)->statements.end(),
+                               [&](const auto& inner) { return collectWrites(inner.get(), writes); });
+        case NodeKind::EXPRESSION_STATEMENT:
+            return isPure(static_cast<const ExpressionStatement*>(stmt)->expression.get());
+        default:
+            return false;
+    }
+}
+
+// Eliminação de subexpressões comuns nas listas de comandos de uma POU, por
+// numeração de valores: cada expressão recebe um número, o mesmo para nós com a
+// mesma operação, o mesmo tipo e operandos de mesmo número. Uma variável ganha
+// um número novo a cada escrita, então o que a lê depois não casa com o que foi
+// calculado antes; um comando com chamada renumera todas. Uma operação ou acesso
+// a array com o número de uma ocorrência anterior vira a leitura de uma
+// temporária, atribuída logo antes do comando da primeira ocorrência.
+//
+// Só são numerados os comandos sem chamadas, e o valor é levado de um comando ao
+// seguinte da mesma lista: um IF, FOR ou bloco conta como um comando (a condição
+// do IF e o valor inicial do FOR são avaliados no lugar dele) e o que ele escreve
+// nos ramos renumera as variáveis; as listas internas começam do zero.
+class CommonSubexpressions {
+public:
+    CommonSubexpressions(AstArena& arena, Function& function) : arena(arena), function(function) {}
+
+    void eliminate(NodeList<Statement>& statements);
+
+    size_t hits = 0;
+    size_t temporaries = 0;
+
+private:
+    struct Entry {
+        NodeKind kind;
+        OperatorType op;
+        TypeId type;
+        uint32_t operands;          // Início dos números dos operandos em Block::operands
+        uint32_t operandCount;
+        NodePtr<Expression>* first; // Primeira ocorrência; nullptr em variáveis e constantes
+        size_t statement;           // Índice na lista do comando da primeira ocorrência
+        Identifier* temporary;      // Criada na segunda ocorrência
+    };
+
+    // Temporária atribuída antes do comando 'statement'; 'value' ordena as do
+    // mesmo comando na ordem de avaliação (as de dentro antes das de fora)
+    struct Hoisted {
+        size_t statement;
+        uint32_t value;
+        NodePtr<Statement> assignment;
+    };
+
+    // Numeração de uma lista de comandos
+    struct Block {
+        std::vector<Entry> entries; // O número de um valor é o índice da entrada
+        std::vector<uint32_t> operands;
+        std::unordered_multimap<uint64_t, uint32_t> index; // Hash da chave -> número
+        std::unordered_map<uint64_t, uint32_t> variables;  // variableKey -> número atual
+        std::unordered_map<const Expression*, uint32_t> numbered; // Operações do comando atual
+        std::vector<Hoisted> hoisted;
+        std::vector<uint64_t> writes;
+    };
+
+    AstArena& arena;
+    Function& function;
+
+    void nested(Statement* stmt);
+    void share(Block& block, NodePtr<Expression>& expr, size_t statement);
+    uint32_t number(Block& block, NodePtr<Expression>& expr, size_t statement);
+    uint32_t intern(Block& block, const Expression& node, OperatorType op, std::span<const uint32_t> operands,
+                    NodePtr<Expression>* first, size_t statement);
+    uint32_t fresh(Block& block);
+    void replace(Block& block, NodePtr<Expression>& expr);
+    NodePtr<Expression> read(Block& block, uint32_t value);
+};
+
+void CommonSubexpressions::eliminate(NodeList<Statement>& statements) {
+    Block block;
+    for (size_t i = 0; i < statements.size(); i++) {
+        Statement* stmt = statements[i].get();
+        switch (stmt->kind) {
+            case NodeKind::ASSIGNMENT: {
+                auto assignment = static_cast<Assignment*>(stmt);
+                if (isPure(assignment->left.get()) && isPure(assignment->right.get())) {
+                    share(block, assignment->right, i);
+                }
+                break;
+            }
+            case NodeKind::RETURN_STATEMENT: {
+                auto returnStmt = static_cast<ReturnStatement*>(stmt);
+                if (isPure(returnStmt->value.get())) {
+                    share(block, returnStmt->value, i);
+                }
+                break;
+            }
+            case NodeKind::EXPRESSION_STATEMENT: {
+                auto exprStmt = static_cast<ExpressionStatement*>(stmt);
+                if (isPure(exprStmt->expression.get())) {
+                    share(block, exprStmt->expression, i);
+                }
+                break;
+            }
+            case NodeKind::IF_STATEMENT: {
+                auto ifStmt = static_cast<IfStatement*>(stmt);
+                if (isPure(ifStmt->condition.get())) {
+                    share(block, ifStmt->condition, i);
+                }
+                nested(ifStmt->thenBranch.get());
+                nested(ifStmt->elseBranch.get());
+                break;
+            }
+            case NodeKind::FOR_STATEMENT: {
+                // O fim é avaliado depois de atribuir a variável de controle: fica de fora
+                auto forStmt = static_cast<ForStatement*>(stmt);
+                Assignment* initializer = forStmt->initializer.get();
+                if (isPure(initializer->left.get()) && isPure(initializer->right.get())) {
+                    share(block, initializer->right, i);
+                }
+                nested(forStmt->body.get());
+                break;
+            }
+            default:
+                // A condição do WHILE é reavaliada a cada volta e não entra na numeração
+                nested(stmt);
+                break;
+        }
+
+        // Depois do comando, as variáveis que ele escreve têm valor novo
+        block.writes.clear();
+        if (collectWrites(stmt, block.writes)) {
+            for (uint64_t variable : block.writes) {
+                block.variables.erase(variable);
+            }
+        } else {
+            block.variables.clear();
+        }
+    }
+
+    if (block.hoisted.empty()) {
+        return;
+    }
+    std::sort(block.hoisted.begin(), block.hoisted.end(), [](const Hoisted& a, const Hoisted& b) {
+        return a.statement != b.statement ? a.statement < b.statement : a.value < b.value;
+    });
+    NodeList<Statement> result(statements.get_allocator());
+    result.reserve(statements.size() + block.hoisted.size());
+    auto next = block.hoisted.begin();
+    for (size_t i = 0; i < statements.size(); i++) {
+        for (; next != block.hoisted.end() && next->statement == i; ++next) {
+            result.push_back(std::move(next->assignment));
+        }
+        result.push_back(std::move(statements[i]));
+    }
+    statements = std::move(result);
+}
+
+void CommonSubexpressions::nested(Statement* stmt) {
+    if (!stmt) {
+        return;
+    }
+    switch (stmt->kind) {
+        case NodeKind::BLOCK_STATEMENT:
+            eliminate(static_cast<BlockStatement*>(stmt)->statements);
+            break;
+        case NodeKind::IF_STATEMENT: {
+            // ELSIF: a condição fica como está, não há lista onde pôr a temporária
+            auto ifStmt = static_cast<IfStatement*>(stmt);
+            nested(ifStmt->thenBranch.get());
+            nested(ifStmt->elseBranch.get());
+            break;
+        }
+        case NodeKind::WHILE_STATEMENT:
+            nested(static_cast<WhileStatement*>(stmt)->body.get());
+            break;
+        case NodeKind::FOR_STATEMENT:
+            nested(static_cast<ForStatement*>(stmt)->body.get());
+            break;
+        default:
+            break;
+    }
+}
+
+void CommonSubexpressions::share(Block& block, NodePtr<Expression>& expr, size_t statement) {
+    // Numera a árvore de baixo para cima e troca de cima para baixo: a maior
+    // expressão repetida vira uma temporária só
+    block.numbered.clear();
+    number(block, expr, statement);
+    replace(block, expr);
+}
+
+uint32_t CommonSubexpressions::number(Block& block, NodePtr<Expression>& expr, size_t statement) {
+    Expression* node = expr.get();
+    uint32_t value;
+    switch (node->kind) {
+        case NodeKind::IDENTIFIER: {
+            auto identifier = static_cast<Identifier*>(node);
+            if (identifier->storage == Storage::UNRESOLVED) {
+                return fresh(block);
+            }
+            auto [it, inserted] = block.variables.try_emplace(variableKey(identifier->storage, identifier->slot), 0);
+            if (inserted) {
+                it->second = fresh(block);
+            }
+            return it->second;
+        }
+        case NodeKind::NUMBER: {
+            uint64_t bits;
+            std::memcpy(&bits, &static_cast<Number*>(node)->value, sizeof bits);
+            const uint32_t key[] = {static_cast<uint32_t>(bits), static_cast<uint32_t>(bits >> 32)};
+            return intern(block, *node, OperatorType{}, key, nullptr, statement);
+        }
+        case NodeKind::BOOLEAN_LITERAL: {
+            const uint32_t key[] = {static_cast<BooleanLiteral*>(node)->value};
+            return intern(block, *node, OperatorType{}, key, nullptr, statement);
+        }
+        case NodeKind::BINARY_OPERATION: {
+            auto binOp = static_cast<BinaryOperation*>(node);
+            const uint32_t key[] = {number(block, binOp->left, statement), number(block, binOp->right, statement)};
+            value = intern(block, *node, binOp->op, key, &expr, statement);
+            break;
+        }
+        case NodeKind::UNARY_OPERATION: {
+            auto unaryOp = static_cast<UnaryOperation*>(node);
+            const uint32_t key[] = {number(block, unaryOp->operand, statement)};
+            value = intern(block, *node, unaryOp->op, key, &expr, statement);
+            break;
+        }
+        case NodeKind::ARRAY_ACCESS: {
+            auto arrayAccess = static_cast<ArrayAccess*>(node);
+            std::vector<uint32_t> key;
+            key.reserve(1 + arrayAccess->indices.size());
+            key.push_back(number(block, arrayAccess->array, statement));
+            for (auto& index : arrayAccess->indices) {
+                key.push_back(number(block, index, statement));
+            }
+            value = intern(block, *node, OperatorType{}, key, &expr, statement);
+            break;
+        }
+        default:
+            return fresh(block); // Chamadas não chegam aqui: comandos com elas não são numerados
+    }
+    block.numbered.emplace(node, value);
+    return value;
+}
+
+uint32_t CommonSubexpressions::intern(Block& block, const Expression& node, OperatorType op,
+                                      std::span<const uint32_t> operands, NodePtr<Expression>* first,
+                                      size_t statement) {
+    constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ull;
+    uint64_t hash = (static_cast<uint64_t>(node.kind) << 40 | static_cast<uint64_t>(op) << 32 | node.type) * MULTIPLIER;
+    for (uint32_t operand : operands) {
+        hash = (hash ^ operand) * MULTIPLIER;
+        hash ^= hash >> 29;
+    }
+    auto [begin, end] = block.index.equal_range(hash);
+    for (auto it = begin; it != end; ++it) {
+        const Entry& entry = block.entries[it->second];
+        if (entry.kind == node.kind && entry.op == op && entry.type == node.type && entry.operandCount == operands.size() &&
+            std::equal(operands.begin(), operands.end(), block.operands.begin() + entry.operands)) {
+            return it->second;
+        }
+    }
+    auto value = static_cast<uint32_t>(block.entries.size());
+    block.entries.push_back({node.kind, op, node.type, static_cast<uint32_t>(block.operands.size()),
+                             static_cast<uint32_t>(operands.size()), first, statement, nullptr});
+    block.operands.insert(block.operands.end(), operands.begin(), operands.end());
+    block.index.emplace(hash, value);
+    return value;
+}
+
+uint32_t CommonSubexpressions::fresh(Block& block) {
+    // Um número que não está no índice: não casa com nada
+    auto value = static_cast<uint32_t>(block.entries.size());
+    block.entries.push_back({NodeKind::IDENTIFIER, OperatorType{}, NO_TYPE, 0, 0, nullptr, 0, nullptr});
+    return value;
+}
+
+void CommonSubexpressions::replace(Block& block, NodePtr<Expression>& expr) {
+    Expression* node = expr.get();
+    auto it = block.numbered.find(node);
+    if (it == block.numbered.end()) {
+        return; // Variáveis e constantes
+    }
+    const Entry& entry = block.entries[it->second];
+    if (entry.first && entry.first != &expr) {
+        expr = read(block, it->second);
+        hits++;
+        return;
+    }
+    switch (node->kind) {
+        case NodeKind::BINARY_OPERATION: {
+            auto binOp = static_cast<BinaryOperation*>(node);
+            replace(block, binOp->left);
+            replace(block, binOp->right);
+            break;
+        }
+        case NodeKind::UNARY_OPERATION:
+            replace(block, static_cast<UnaryOperation*>(node)->operand);
+            break;
+        case NodeKind::ARRAY_ACCESS: {
+            auto arrayAccess = static_cast<ArrayAccess*>(node);
+            replace(block, arrayAccess->array);
+            for (auto& index : arrayAccess->indices) {
+                replace(block, index);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+NodePtr<Expression> CommonSubexpressions::read(Block& block, uint32_t value) {
+    Entry& entry = block.entries[value];
+    auto makeRead = [&](const Identifier& temporary) {
+        auto identifier = makeNode<Identifier>(arena, temporary.name);
+        identifier->storage = Storage::LOCAL;
+        identifier->slot = temporary.slot;
+        identifier->type = temporary.type;
+        return identifier;
+    };
+    if (!entry.temporary) {
+        // A primeira ocorrência passa para a atribuição da temporária e também a lê
+        uint32_t slot = function.frameSlots++;
+        auto target = makeNode<Identifier>(arena, arena.copyString("$t" + std::to_string(slot)));
+        target->storage = Storage::LOCAL;
+        target->slot = slot;
+        target->type = entry.type;
+        entry.temporary = target.get();
+        NodePtr<Expression> computed = std::move(*entry.first);
+        *entry.first = makeRead(*entry.temporary);
+        block.hoisted.push_back({entry.statement, value, makeNode<Assignment>(arena, std::move(target), std::move(computed))});
+        temporaries++;
+    }
+    return makeRead(*entry.temporary);
+}
+
+} // namespace
+
+std::span<const SimplificationRule> ASTOptimizer::simplificationRules() {
+    return RULES;
+}
 
 void ASTOptimizer::optimize(Program* program) {
+    arena = &program->arena();
+    removed = 0;
+    simplified = 0;
+    cseHits.clear();
     optimizeProgram(program);
 }
 
 void ASTOptimizer::optimizeProgram(Program* program) {
-    for (auto& stmt : program->statements) {
+    optimizeStatements(program->statements);
+}
+
+void ASTOptimizer::optimizeStatements(NodeList<Statement>& statements) {
+    size_t kept = 0;
+    bool returned = false;
+    for (auto& stmt : statements) {
+        if (returned) {
+            removed += countNodes(stmt.get());
+            continue;
+        }
         optimizeStatement(stmt);
+        if (!stmt) {
+            continue; // Comando eliminado (já contado)
+        }
+        if (isEmptyBlock(stmt.get())) {
+            removed++;
+            continue;
+        }
+        returned = alwaysReturns(stmt.get());
+        if (&statements[kept] != &stmt) {
+            statements[kept] = std::move(stmt);
+        }
+        kept++;
     }
+    statements.erase(statements.begin() + static_cast<ptrdiff_t>(kept), statements.end());
 }
 
-void ASTOptimizer::optimizeStatement(std::unique_ptr<Statement>& stmt) {
-    if (auto varDecl = dynamic_cast<VariableDeclaration*>(stmt.get())) {
-        optimizeVariableDeclaration(varDecl);
-    } else if (auto arrayDecl = dynamic_cast<ArrayDeclaration*>(stmt.get())) {
-        optimizeArrayDeclaration(arrayDecl);
-    } else if (auto assignment = dynamic_cast<Assignment*>(stmt.get())) {
-        optimizeAssignment(assignment);
-    } else if (auto returnStmt = dynamic_cast<ReturnStatement*>(stmt.get())) {
-        optimizeReturnStatement(returnStmt);
-    } else if (auto ifStmt = dynamic_cast<IfStatement*>(stmt.get())) {
-        optimizeIfStatement(ifStmt);
-    } else if (auto whileStmt = dynamic_cast<WhileStatement*>(stmt.get())) {
-        optimizeWhileStatement(whileStmt);
-    } else if (auto forStmt = dynamic_cast<ForStatement*>(stmt.get())) {
-        optimizeForStatement(forStmt);
-    } else if (auto function = dynamic_cast<Function*>(stmt.get())) {
-        optimizeFunction(function);
-    } else if (auto blockStmt = dynamic_cast<BlockStatement*>(stmt.get())) {
-        optimizeBlockStatement(blockStmt);
-    } else if (auto exprStmt = dynamic_cast<ExpressionStatement*>(stmt.get())) {
-        optimizeExpressionStatement(exprStmt);
-    }
-}
-
-void ASTOptimizer::optimizeExpression(std::unique_ptr<Expression>& expr) {
-    if (auto binOp = dynamic_cast<BinaryOperation*>(expr.get())) {
-        // Otimiza os operandos
-        optimizeExpression(binOp->left);
-        optimizeExpression(binOp->right);
-
-        // Tenta realizar a dobra de constantes
-        if (auto leftNum = dynamic_cast<Number*>(binOp->left.get())) {
-            if (auto rightNum = dynamic_cast<Number*>(binOp->right.get())) {
-                double result = 0;
-                bool canOptimize = true;
-                switch (binOp->op) {
-                    case OperatorType::ADD:
-                        result = leftNum->value + rightNum->value;
-                        break;
-                    case OperatorType::SUBTRACT:
-                        result = leftNum->value - rightNum->value;
-                        break;
-                    case OperatorType::MULTIPLY:
-                        result = leftNum->value * rightNum->value;
-                        break;
-                    case OperatorType::DIVIDE:
-                        if (rightNum->value != 0) {
-                            result = leftNum->value / rightNum->value;
-                        } else {
-                            // Evita divisão por zero
-                            canOptimize = false;
-                        }
-                        break;
-                    default:
-                        canOptimize = false;
-                        break;
-                }
-                if (canOptimize) {
-                    // Substitui a operação pelo resultado constante
-                    expr = std::make_unique<Number>(result);
-                }
+void ASTOptimizer::optimizeStatement(NodePtr<Statement>& stmt) {
+    Statement* node = stmt.get();
+    switch (node->kind) {
+        case NodeKind::VARIABLE_DECLARATION:
+            optimizeVariableDeclaration(static_cast<VariableDeclaration*>(node));
+            break;
+        case NodeKind::ARRAY_DECLARATION:
+            optimizeArrayDeclaration(static_cast<ArrayDeclaration*>(node));
+            break;
+        case NodeKind::ASSIGNMENT:
+            optimizeAssignment(static_cast<Assignment*>(node));
+            break;
+        case NodeKind::RETURN_STATEMENT:
+            optimizeReturnStatement(static_cast<ReturnStatement*>(node));
+            break;
+        case NodeKind::IF_STATEMENT:
+            optimizeIfStatement(stmt);
+            break;
+        case NodeKind::WHILE_STATEMENT:
+            optimizeWhileStatement(stmt);
+            break;
+        case NodeKind::FOR_STATEMENT:
+            optimizeForStatement(static_cast<ForStatement*>(node));
+            break;
+        case NodeKind::FUNCTION:
+            optimizeFunction(static_cast<Function*>(node));
+            break;
+        case NodeKind::BLOCK_STATEMENT:
+            optimizeBlockStatement(static_cast<BlockStatement*>(node));
+            break;
+        case NodeKind::EXPRESSION_STATEMENT:
+            optimizeExpressionStatement(static_cast<ExpressionStatement*>(node));
+            break;
+        default:
+            break;
+    }
+}
+
+void ASTOptimizer::optimizeExpression(NodePtr<Expression>& expr) {
+    switch (expr->kind) {
+        case NodeKind::BINARY_OPERATION:
+            optimizeBinaryOperation(expr);
+            break;
+        case NodeKind::UNARY_OPERATION:
+            optimizeUnaryOperation(expr);
+            break;
+        case NodeKind::FUNCTION_CALL:
+            for (auto& arg : static_cast<FunctionCall&>(*expr).arguments) {
+                optimizeExpression(arg);
+            }
+            break;
+        case NodeKind::ARRAY_ACCESS: {
+            auto& arrayAccess = static_cast<ArrayAccess&>(*expr);
+            optimizeExpression(arrayAccess.array);
+            for (auto& index : arrayAccess.indices) {
+                optimizeExpression(index);
             }
+            break;
         }
-    } else if (auto unaryOp = dynamic_cast<UnaryOperation*>(expr.get())) {
-        optimizeExpression(unaryOp->operand);
+        default:
+            // Para Number, Identifier, BooleanLiteral, não há nada a fazer
+            break;
+    }
+}
+
+void ASTOptimizer::optimizeBinaryOperation(NodePtr<Expression>& expr) {
+    auto binOp = static_cast<BinaryOperation*>(expr.get());
+    // Otimiza os operandos
+    optimizeExpression(binOp->left);
+    optimizeExpression(binOp->right);
+
+    // Tenta realizar a dobra de constantes
+    Value left;
+    Value right;
+    Value result;
+    if (constantValue(*binOp->left, left) && constantValue(*binOp->right, right) &&
+        foldBinary(binOp->op, left, right, result)) {
+        expr = makeConstant(result);
+    } else {
+        simplifyBinaryOperation(expr);
+    }
+}
 
-        if (auto operandNum = dynamic_cast<Number*>(unaryOp->operand.get())) {
-            double result = 0;
-            bool canOptimize = true;
-            switch (unaryOp->op) {
-                case OperatorType::SUBTRACT:
-                    result = -operandNum->value;
-                    break;
-                // Outros operadores unários podem ser adicionados aqui
-                default:
-                    canOptimize = false;
-                    break;
+void ASTOptimizer::optimizeUnaryOperation(NodePtr<Expression>& expr) {
+    auto unaryOp = static_cast<UnaryOperation*>(expr.get());
+    optimizeExpression(unaryOp->operand);
+
+    Value operand;
+    Value result;
+    if (constantValue(*unaryOp->operand, operand) && foldUnary(unaryOp->op, operand, result)) {
+        expr = makeConstant(result);
+    } else {
+        simplifyUnaryOperation(expr);
+    }
+}
+
+void ASTOptimizer::simplifyBinaryOperation(NodePtr<Expression>& expr) {
+    auto binOp = static_cast<BinaryOperation*>(expr.get());
+    // Toda regra binária tem uma constante num dos lados: o caso comum nem olha a tabela
+    auto isLiteral = [](const Expression& operand) {
+        return operand.kind == NodeKind::NUMBER || operand.kind == NodeKind::BOOLEAN_LITERAL;
+    };
+    if (!isLiteral(*binOp->left) && !isLiteral(*binOp->right)) {
+        return;
+    }
+    uint8_t type = typeFlag(binOp->type);
+    for (const Rule& rule : RULES) {
+        if (rule.op != binOp->op || rule.rewrite == Rewrite::INNER || (rule.types & type) == 0) {
+            continue;
+        }
+        bool constantOnLeft = rule.constantSide == Side::LEFT;
+        NodePtr<Expression>& constant = constantOnLeft ? binOp->left : binOp->right;
+        NodePtr<Expression>& other = constantOnLeft ? binOp->right : binOp->left;
+        if (!matchesConstant(rule, *constant)) {
+            continue;
+        }
+        // Exceto com CONSTANT, o resultado é o outro operando: ele já tem de ter o
+        // tipo da operação (INTEGER * 1 REAL é REAL e não pode virar o INTEGER)
+        if (rule.rewrite != Rewrite::CONSTANT && other->type != binOp->type) {
+            continue;
+        }
+        switch (rule.rewrite) {
+            case Rewrite::OTHER:
+                expr = std::move(other);
+                break;
+            case Rewrite::CONSTANT: {
+                if (!canDiscard(other.get())) {
+                    continue;
+                }
+                TypeId resultType = binOp->type;
+                expr = std::move(constant);
+                expr->type = resultType; // 0 INTEGER, ou TRUE/FALSE
+                break;
             }
-            if (canOptimize) {
-                // Substitui a operação pelo resultado constante
-                expr = std::make_unique<Number>(result);
+            case Rewrite::NEGATE: {
+                auto negated = makeNode<UnaryOperation>(*arena, OperatorType::SUBTRACT, std::move(other));
+                negated->type = binOp->type;
+                expr = std::move(negated);
+                simplifyUnaryOperation(expr); // x * -1 com x = -y
+                break;
             }
+            case Rewrite::DOUBLE: {
+                // Só para variáveis: avaliar uma expressão duas vezes custaria mais que a multiplicação
+                auto variable = nodeAs<Identifier>(other.get());
+                if (!variable) {
+                    continue;
+                }
+                auto copy = makeNode<Identifier>(*arena, variable->name);
+                copy->storage = variable->storage;
+                copy->slot = variable->slot;
+                copy->type = variable->type;
+                binOp->op = OperatorType::ADD;
+                constant = std::move(copy);
+                break;
+            }
+            case Rewrite::INNER:
+                break;
         }
-    } else if (auto funcCall = dynamic_cast<FunctionCall*>(expr.get())) {
-        for (auto& arg : funcCall->arguments) {
-            optimizeExpression(arg);
-        }
-    } else if (auto arrayAccess = dynamic_cast<ArrayAccess*>(expr.get())) {
-        optimizeExpression(arrayAccess->array);
-        for (auto& index : arrayAccess->indices) {
-            optimizeExpression(index);
+        simplified++;
+        return;
+    }
+}
+
+void ASTOptimizer::simplifyUnaryOperation(NodePtr<Expression>& expr) {
+    auto unaryOp = static_cast<UnaryOperation*>(expr.get());
+    auto inner = nodeAs<UnaryOperation>(unaryOp->operand.get());
+    if (!inner || inner->op != unaryOp->op || inner->operand->type != unaryOp->type) {
+        return;
+    }
+    uint8_t type = typeFlag(unaryOp->type);
+    for (const Rule& rule : RULES) {
+        if (rule.rewrite == Rewrite::INNER && rule.op == unaryOp->op && (rule.types & type) != 0) {
+            expr = std::move(inner->operand);
+            simplified++;
+            return;
         }
     }
-    // Para Number, Identifier, BooleanLiteral, não há nada a fazer
+}
+
+NodePtr<Expression> ASTOptimizer::makeConstant(const Value& value) {
+    // O nó leva o tipo do valor: um REAL de valor inteiro continua REAL
+    if (value.getType() == Value::Type::BOOLEAN) {
+        auto literal = makeNode<BooleanLiteral>(*arena, value.getBoolValue());
+        literal->type = TypeTable::BOOLEAN;
+        return literal;
+    }
+    bool integer = value.getType() == Value::Type::INTEGER;
+    auto number = makeNode<Number>(*arena, value.getRealValue(), integer ? LiteralKind::INTEGER : LiteralKind::REAL);
+    number->type = integer ? TypeTable::INTEGER : TypeTable::REAL;
+    return number;
 }
 
 void ASTOptimizer::optimizeVariableDeclaration(VariableDeclaration* varDecl) {
@@ -131,17 +966,46 @@ void ASTOptimizer::optimizeReturnStatement(ReturnStatement* returnStmt) {
     optimizeExpression(returnStmt->value);
 }
 
-void ASTOptimizer::optimizeIfStatement(IfStatement* ifStmt) {
+void ASTOptimizer::optimizeIfStatement(NodePtr<Statement>& stmt) {
+    auto ifStmt = static_cast<IfStatement*>(stmt.get());
     optimizeExpression(ifStmt->condition);
     optimizeStatement(ifStmt->thenBranch);
     if (ifStmt->elseBranch) {
         optimizeStatement(ifStmt->elseBranch);
+        // Um ELSIF eliminado deixa o ramo nulo; um ELSE vazio não faz nada
+        if (ifStmt->elseBranch && isEmptyBlock(ifStmt->elseBranch.get())) {
+            removed++;
+            ifStmt->elseBranch = nullptr;
+        }
+    }
+
+    // Condição constante: o IF vira o ramo que sempre executa (ou nada)
+    if (auto condition = nodeAs<BooleanLiteral>(ifStmt->condition.get())) {
+        NodePtr<Statement>& taken = condition->value ? ifStmt->thenBranch : ifStmt->elseBranch;
+        NodePtr<Statement>& skipped = condition->value ? ifStmt->elseBranch : ifStmt->thenBranch;
+        removed += 2 + countNodes(skipped.get()); // O IF e a condição
+        stmt = std::move(taken);
+        return;
+    }
+
+    // Sem ramo com comandos, só resta avaliar a condição
+    if (isEmptyBlock(ifStmt->thenBranch.get()) && !ifStmt->elseBranch && canDiscard(ifStmt->condition.get())) {
+        removed += countNodes(ifStmt);
+        stmt = nullptr;
     }
 }
 
-void ASTOptimizer::optimizeWhileStatement(WhileStatement* whileStmt) {
+void ASTOptimizer::optimizeWhileStatement(NodePtr<Statement>& stmt) {
+    auto whileStmt = static_cast<WhileStatement*>(stmt.get());
     optimizeExpression(whileStmt->condition);
     optimizeStatement(whileStmt->body);
+
+    // WHILE FALSE nunca executa o corpo (WHILE TRUE só termina com RETURN e fica)
+    auto condition = nodeAs<BooleanLiteral>(whileStmt->condition.get());
+    if (condition && !condition->value) {
+        removed += countNodes(whileStmt);
+        stmt = nullptr;
+    }
 }
 
 void ASTOptimizer::optimizeForStatement(ForStatement* forStmt) {
@@ -151,15 +1015,18 @@ void ASTOptimizer::optimizeForStatement(ForStatement* forStmt) {
 }
 
 void ASTOptimizer::optimizeFunction(Function* function) {
-    for (auto& stmt : function->body) {
-        optimizeStatement(stmt);
+    optimizeStatements(function->body);
+
+    // Depois da dobra e da simplificação, que deixam as expressões na forma final
+    CommonSubexpressions cse(*arena, *function);
+    cse.eliminate(function->body);
+    if (cse.hits > 0) {
+        cseHits.push_back({function->name, cse.hits, cse.temporaries});
     }
 }
 
 void ASTOptimizer::optimizeBlockStatement(BlockStatement* blockStmt) {
-    for (auto& stmt : blockStmt->statements) {
-        optimizeStatement(stmt);
-    }
+    optimizeStatements(blockStmt->statements);
 }
 
 void ASTOptimizer::optimizeExpressionStatement(ExpressionStatement* exprStmt) {
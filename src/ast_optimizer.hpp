@@ -3,16 +3,98 @@
 #ifndef AST_OPTIMIZER_HPP
 #define AST_OPTIMIZER_HPP
 
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
 #include "ast.hpp"
+#include "operator_type.hpp"
+#include "value.hpp"
 
+// Regra de simplificação algébrica: a operação 'op' com a constante 'constant'
+// no lado 'constantSide' vira 'rewrite'. A regra só vale para os tipos de
+// resultado em 'types'; as que mudariam o resultado de um REAL (ex.: x + 0 com
+// x = -0.0, x * 0 com x infinito) não têm ON_REAL.
+struct SimplificationRule {
+    enum class Side : uint8_t { LEFT, RIGHT };
+    enum class Rewrite : uint8_t {
+        OTHER,    // O outro operando: x * 1 -> x
+        CONSTANT, // A constante; o outro operando precisa poder ser descartado: x * 0 -> 0
+        NEGATE,   // Menos o outro operando: x * -1 -> -x
+        DOUBLE,   // O outro operando, uma variável, somado a si mesmo: x * 2 -> x + x
+        INNER,    // Operação unária aplicada duas vezes: o operando de dentro (sem constante)
+    };
+    static constexpr uint8_t ON_INTEGER = 1;
+    static constexpr uint8_t ON_REAL = 2;
+    static constexpr uint8_t ON_BOOLEAN = 4; // A constante é TRUE (1) ou FALSE (0)
+
+    const char* name;
+    OperatorType op;
+    Side constantSide;
+    double constant;
+    uint8_t types;
+    Rewrite rewrite;
+};
+
+// Subexpressões comuns reaproveitadas numa POU
+struct CseHits {
+    std::string_view pou;
+    size_t hits;        // Ocorrências trocadas pela leitura de uma temporária
+    size_t temporaries; // Temporárias criadas (slots a mais no quadro da POU)
+};
+
+// Otimizações sobre um programa já analisado: usa os tipos anotados nos nós
+//   - dobra de constantes com a semântica do Interpreter (aritmética INTEGER ou
+//     REAL pelo tipo dos operandos, comparações e operadores lógicos);
+//   - simplificação algébrica e redução de força pela tabela de regras
+//     (simplificationRules()), depois da dobra;
+//   - eliminação de código morto: IF e WHILE com condição constante são
+//     trocados pelo ramo que executa, e somem das listas de comandos os blocos
+//     vazios e o que vem depois de um comando que sempre executa RETURN;
+//   - eliminação de subexpressões comuns em cada lista de comandos das POUs:
+//     uma expressão sem chamadas que se repete sem que os operandos mudem é
+//     calculada uma vez numa temporária criada pelo compilador (um slot novo
+//     no quadro, com nome '$t<slot>', que não existe no fonte).
 class ASTOptimizer {
 public:
     void optimize(Program* program);
 
+    // Nós removidos pela eliminação de código morto na última chamada de optimize()
+    size_t removedNodes() const { return removed; }
+
+    // Regras aplicadas na última chamada de optimize()
+    size_t simplifications() const { return simplified; }
+
+    // POUs com subexpressões comuns na última chamada de optimize(), na ordem do programa
+    const std::vector<CseHits>& commonSubexpressions() const { return cseHits; }
+
+    static std::span<const SimplificationRule> simplificationRules();
+
 private:
-    void optimizeExpression(std::unique_ptr<Expression>& expr);
+    // Arena do programa em otimização, onde são criados os nós substitutos
+    AstArena* arena = nullptr;
+    size_t removed = 0;
+    size_t simplified = 0;
+    std::vector<CseHits> cseHits;
+
+    // Despacham pelo Node::kind do nó
+    void optimizeExpression(NodePtr<Expression>& expr);
+    void optimizeStatement(NodePtr<Statement>& stmt); // Pode deixar 'stmt' nulo (IF e WHILE eliminados)
+
+    // Expressões que podem ser substituídas por outro nó
+    void optimizeBinaryOperation(NodePtr<Expression>& expr);
+    void optimizeUnaryOperation(NodePtr<Expression>& expr);
+
+    // Aplica a primeira regra de simplificação que casa com a operação em 'expr'
+    void simplifyBinaryOperation(NodePtr<Expression>& expr);
+    void simplifyUnaryOperation(NodePtr<Expression>& expr);
+
+    // Constante criada pelo otimizador, no arena do programa
+    NodePtr<Expression> makeConstant(const Value& value);
 
-    void optimizeStatement(std::unique_ptr<Statement>& stmt);
+    // Otimiza cada comando da lista e tira dela os eliminados (que ficam nulos),
+    // os blocos vazios e os que vêm depois de um RETURN
+    void optimizeStatements(NodeList<Statement>& statements);
 
     // Métodos de otimização para cada tipo de nó
     void optimizeProgram(Program* program);
@@ -20,8 +102,8 @@ private:
     void optimizeArrayDeclaration(ArrayDeclaration* arrayDecl);
     void optimizeAssignment(Assignment* assignment);
     void optimizeReturnStatement(ReturnStatement* returnStmt);
-    void optimizeIfStatement(IfStatement* ifStmt);
-    void optimizeWhileStatement(WhileStatement* whileStmt);
+    void optimizeIfStatement(NodePtr<Statement>& stmt);
+    void optimizeWhileStatement(NodePtr<Statement>& stmt);
     void optimizeForStatement(ForStatement* forStmt);
     void optimizeFunction(Function* function);
     void optimizeBlockStatement(BlockStatement* blockStmt);
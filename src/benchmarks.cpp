@@ -0,0 +1,704 @@
+// benchmarks.cpp
+
+#include "benchmarks.hpp"
+#include "allocation_counter.hpp"
+#include "ast_cache.hpp"
+#include "ast_optimizer.hpp"
+#include "compiler.hpp"
+#include "flat_ast.hpp"
+#include "incremental_parser.hpp"
+#include "parallel_parser.hpp"
+#include "parser.hpp"
+#include "scanner.hpp"
+#include "scanner_simd.hpp"
+#include "semantic_analyzer.hpp"
+#include "source_file.hpp"
+#include "source_hash.hpp"
+#include "symbol_table.hpp"
+#include "token_class.hpp"
+#include "value.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Measurement {
+    double seconds;
+    size_t allocations;
+};
+
+// Executa 'body' 'iterations' vezes e devolve o tempo e as alocações médias
+Measurement measure(int iterations, const std::function<void()>& body) {
+    size_t allocationsBefore = allocationCount();
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        body();
+    }
+    auto end = std::chrono::steady_clock::now();
+    size_t allocations = allocationCount() - allocationsBefore;
+    return {std::chrono::duration<double>(end - begin).count() / iterations, allocations / iterations};
+}
+
+std::string writeTemporarySource(const std::string& code) {
+    std::string path = (std::filesystem::temp_directory_path() / "compilador_bench.st").string();
+    std::ofstream file(path, std::ios::binary);
+    file << code;
+    return path;
+}
+
+void benchmarkScanner() {
+    const int iterations = 5;
+    std::string code = generateBenchmarkSource(5000);
+    std::string path = writeTemporarySource(code);
+
+    size_t tokenCount = 0;
+    Measurement inMemory = measure(iterations, [&] {
+        Scanner scanner(code);
+        tokenCount = scanner.scanTokens().size();
+    });
+
+    Measurement mapped = measure(iterations, [&] {
+        SourceFile file(path);
+        Scanner scanner(file.text());
+        tokenCount = scanner.scanTokens().size();
+    });
+
+    std::printf("scanner: %zu bytes, %zu tokens\n", code.size(), tokenCount);
+    std::printf("  %-10s %12.0f tokens/s  %6.3f alocações/token\n", "memória",
+                tokenCount / inMemory.seconds, double(inMemory.allocations) / tokenCount);
+    std::printf("  %-10s %12.0f tokens/s  %6.3f alocações/token\n", "mmap",
+                tokenCount / mapped.seconds, double(mapped.allocations) / tokenCount);
+
+    std::remove(path.c_str());
+}
+
+// Fonte típico exportado por fornecedores: cabeçalhos de comentário grandes e muita indentação
+std::string generateCommentHeavySource(int units) {
+    std::string code;
+    std::string indent(16, ' ');
+    for (int i = 0; i < units; i++) {
+        code += "(**********************************************************************\n";
+        for (int j = 0; j < 12; j++) {
+            code += " * Bloco " + std::to_string(i) + ", linha " + std::to_string(j) +
+                    ": descrição gerada automaticamente pelo exportador do fornecedor\n";
+        }
+        code += " **********************************************************************)\n";
+        code += "FUNCTION Func" + std::to_string(i) + " : INTEGER\n";
+        code += "VAR\n" + indent + "acc : INTEGER := 0;\nEND_VAR\n";
+        code += indent + indent + "acc := acc + 1;      (* incremento *)\n";
+        code += indent + "Func" + std::to_string(i) + " := acc;\n";
+        code += "END_FUNCTION\n\n\n";
+    }
+    return code;
+}
+
+// Fonte dominado por expressões longas que passam por todos os níveis de precedência
+std::string generateExpressionHeavySource(int units) {
+    std::string code;
+    for (int i = 0; i < units; i++) {
+        std::string name = "Expr" + std::to_string(i);
+        code += "FUNCTION " + name + " : BOOLEAN\n";
+        code += "VAR\n    a : INTEGER := 1;\n    b : INTEGER := 2;\n    c : REAL := 0.5;\n    flag : BOOLEAN := TRUE;\nEND_VAR\n";
+        for (int j = 0; j < 8; j++) {
+            code += "a := (a + b * 3 - (b - 1) / 2) * -a + b * (a + " + std::to_string(j) + ");\n";
+            code += "flag := a + b * 2 > c * 4 - 1 AND NOT flag OR a <= b AND b - a != 3 OR a * a = b;\n";
+        }
+        code += name + " := flag;\n";
+        code += "END_FUNCTION\n\n";
+    }
+    return code;
+}
+
+void benchmarkExpressions() {
+    const int iterations = 5;
+    std::string code = generateExpressionHeavySource(5000);
+    TokenBuffer buffer = Scanner(code).scanBuffer();
+
+    // Os tokens já estão escaneados: mede só o parser
+    Measurement parse = measure(iterations, [&] {
+        Parser parser(buffer);
+        parser.parse();
+    });
+    std::printf("expressoes: %zu tokens\n", buffer.size());
+    std::printf("  parse          %8.1f ms  %8.1f Mtokens/s\n", parse.seconds * 1e3, buffer.size() / parse.seconds / 1e6);
+}
+
+// Fonte dominado por blocos VAR, onde o parser mais testa classes de tokens
+std::string generateDeclarationHeavySource(int units) {
+    static const char* types[] = {"INTEGER", "REAL", "BOOLEAN", "Motor"};
+    std::string code;
+    for (int i = 0; i < units; i++) {
+        code += "FUNCTION_BLOCK Bloco" + std::to_string(i) + "\nVAR_INPUT\n";
+        for (int j = 0; j < 10; j++) {
+            code += "    in" + std::to_string(j) + " : " + types[j % 4] + ";\n";
+        }
+        code += "END_VAR\nVAR_OUTPUT\n    pronto : BOOLEAN := FALSE;\nEND_VAR\nVAR\n";
+        for (int j = 0; j < 30; j++) {
+            code += "    v" + std::to_string(j) + " : " + types[j % 4] + ";\n";
+        }
+        code += "    tabela : ARRAY[0..9, 1..4] OF REAL;\nEND_VAR\n";
+        code += "pronto := TRUE;\nEND_FUNCTION_BLOCK\n\n";
+    }
+    return code;
+}
+
+void benchmarkDeclarations() {
+    const int iterations = 5;
+    std::string code = generateDeclarationHeavySource(10000);
+    TokenBuffer buffer = Scanner(code).scanBuffer();
+
+    Measurement parse = measure(iterations, [&] {
+        Parser parser(buffer);
+        parser.parse();
+    });
+    // Só a classificação: laço sobre a lista de candidatos vs. teste de bit
+    const std::initializer_list<TokenType> typeNames = {TokenType::REAL, TokenType::INTEGER, TokenType::BOOLEAN, TokenType::IDENTIFIER};
+    size_t listHits = 0;
+    size_t maskHits = 0;
+    Measurement list = measure(iterations * 4, [&] {
+        listHits = 0;
+        for (size_t i = 0; i < buffer.size(); i++) {
+            TokenType type = buffer.type(i);
+            for (TokenType candidate : typeNames) {
+                if (type != TokenType::EOF_TOKEN && type == candidate) {
+                    listHits++;
+                    break;
+                }
+            }
+        }
+    });
+    Measurement mask = measure(iterations * 4, [&] {
+        maskHits = 0;
+        for (size_t i = 0; i < buffer.size(); i++) {
+            maskHits += token_class::TYPE_NAME.contains(buffer.type(i));
+        }
+    });
+    if (listHits != maskHits) std::abort();
+
+    std::printf("declaracoes: %zu tokens\n", buffer.size());
+    std::printf("  parse          %8.1f ms  %8.1f Mtokens/s\n", parse.seconds * 1e3, buffer.size() / parse.seconds / 1e6);
+    std::printf("  classe (lista) %8.2f ms\n", list.seconds * 1e3);
+    std::printf("  classe (bits)  %8.2f ms  speedup %5.2fx\n", mask.seconds * 1e3, list.seconds / mask.seconds);
+}
+
+// Procura o fim de cada comentário e salta os espaços que o seguem com as funções dadas
+template <typename SkipBlanks, typename FindCommentEnd>
+int skipComments(std::string_view code, const std::vector<size_t>& commentStarts,
+                 SkipBlanks skipBlanks, FindCommentEnd findCommentEnd) {
+    int line = 1;
+    for (size_t start : commentStarts) {
+        size_t close = findCommentEnd(code.data(), start + 2, code.size(), line);
+        skipBlanks(code.data(), close + 2, code.size(), line);
+    }
+    return line;
+}
+
+void benchmarkCommentSkipping() {
+    const int iterations = 20;
+    std::string code = generateCommentHeavySource(5000);
+    double megabytes = code.size() / (1024.0 * 1024.0);
+
+    std::vector<size_t> commentStarts;
+    for (size_t pos = code.find("(*"); pos != std::string::npos; pos = code.find("(*", pos + 2)) {
+        commentStarts.push_back(pos);
+    }
+
+    int scalarLines = 0;
+    int vectorLines = 0;
+    Measurement scalar = measure(iterations, [&] {
+        scalarLines = skipComments(code, commentStarts, simd_scan::skipBlanksScalar, simd_scan::findCommentEndScalar);
+    });
+    Measurement vector = measure(iterations, [&] {
+        vectorLines = skipComments(code, commentStarts, simd_scan::skipBlanks, simd_scan::findCommentEnd);
+    });
+
+    size_t tokenCount = 0;
+    Measurement scanner = measure(iterations, [&] {
+        Scanner tokenizer(code);
+        tokenCount = tokenizer.scanTokens().size();
+    });
+
+    std::printf("comentarios: %.1f MiB, %zu tokens, variante %s\n", megabytes, tokenCount, simd_scan::VARIANT);
+    std::printf("  pular escalar   %8.0f MiB/s (%d linhas)\n", megabytes / scalar.seconds, scalarLines);
+    std::printf("  pular vetorial  %8.0f MiB/s (%d linhas)\n", megabytes / vector.seconds, vectorLines);
+    std::printf("  scanner         %8.0f MiB/s %12.0f tokens/s\n", megabytes / scanner.seconds, tokenCount / scanner.seconds);
+}
+
+void benchmarkStreamingParser() {
+    const int iterations = 5;
+    std::string code = generateBenchmarkSource(20000);
+
+    size_t tokenBytes = 0;
+    size_t statements = 0;
+    Measurement batch = measure(iterations, [&] {
+        Scanner scanner(code);
+        auto tokens = scanner.scanTokens();
+        tokenBytes = tokens.capacity() * sizeof(Token);
+        Parser parser(tokens);
+        statements = parser.parse()->statements.size();
+    });
+
+    Measurement streaming = measure(iterations, [&] {
+        Scanner scanner(code);
+        Parser parser(scanner);
+        statements = parser.parse()->statements.size();
+    });
+
+    std::printf("fluxo: %zu bytes de fonte, %zu unidades\n", code.size(), statements);
+    std::printf("  vetor de tokens  %8.2f ms  buffer de tokens %10zu bytes\n", batch.seconds * 1e3, tokenBytes);
+    std::printf("  em fluxo         %8.2f ms  buffer de tokens %10zu bytes\n", streaming.seconds * 1e3, sizeof(Token) * Parser::WINDOW_SIZE);
+}
+
+void benchmarkTokenLayout() {
+    const int iterations = 5;
+    std::string code = generateBenchmarkSource(20000);
+
+    Scanner vectorScanner(code);
+    auto tokens = vectorScanner.scanTokens();
+    Scanner bufferScanner(code);
+    TokenBuffer buffer = bufferScanner.scanBuffer();
+
+    Measurement arrayOfStructs = measure(iterations, [&] {
+        Parser parser(tokens);
+        parser.parse();
+    });
+    Measurement structOfArrays = measure(iterations, [&] {
+        Parser parser(buffer);
+        parser.parse();
+    });
+
+    double megabytes = code.size() / (1024.0 * 1024.0);
+    std::printf("layout: %zu tokens\n", tokens.size());
+    std::printf("  vector<Token>  %6.1f bytes/token  parse %8.1f MiB/s\n",
+                double(tokens.capacity() * sizeof(Token)) / tokens.size(), megabytes / arrayOfStructs.seconds);
+    std::printf("  TokenBuffer    %6.1f bytes/token  parse %8.1f MiB/s\n",
+                buffer.bytesPerToken(), megabytes / structOfArrays.seconds);
+}
+
+void benchmarkParallelParser() {
+    const int iterations = 3;
+    std::string code = generateBenchmarkSource(50000);
+
+    Measurement sequential = measure(iterations, [&] {
+        Scanner scanner(code);
+        Parser parser(scanner);
+        parser.parse();
+    });
+    std::printf("paralelo: %zu bytes, %u núcleos\n", code.size(), std::thread::hardware_concurrency());
+    std::printf("  sequencial     %8.1f ms\n", sequential.seconds * 1e3);
+
+    for (unsigned threads : {1u, 2u, 4u, 8u, 16u}) {
+        size_t units = 0;
+        Measurement parallel = measure(iterations, [&] {
+            ParallelParser parser(code, threads);
+            units = parser.parse()->statements.size();
+        });
+        std::printf("  %2u threads     %8.1f ms  speedup %5.2fx (%zu unidades)\n",
+                    threads, parallel.seconds * 1e3, sequential.seconds / parallel.seconds, units);
+    }
+}
+
+void benchmarkAstAllocation() {
+    const int iterations = 5;
+    std::string code = generateBenchmarkSource(20000);
+
+    std::unique_ptr<Program> program;
+    Measurement build = measure(iterations, [&] {
+        Scanner scanner(code);
+        Parser parser(scanner);
+        program = parser.parse();
+        if (program->statements.empty()) std::abort();
+        program.reset();
+    });
+
+    Scanner scanner(code);
+    Parser parser(scanner);
+    program = parser.parse();
+    auto begin = std::chrono::steady_clock::now();
+    program.reset();
+    double release = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::printf("ast: 20000 funções\n");
+    std::printf("  parse + liberação %8.1f ms  %10zu alocações\n", build.seconds * 1e3, build.allocations);
+    std::printf("  liberação         %8.2f ms\n", release * 1e3);
+}
+
+// Percorre a árvore de ponteiros contando identificadores e somando constantes
+class TreeWalker : public Visitor {
+public:
+    size_t identifiers = 0;
+    double total = 0;
+
+    void visitProgram(Program& program) override { for (auto& stmt : program.statements) stmt->accept(*this); }
+    void visitVariableDeclaration(VariableDeclaration& varDecl) override { visit(varDecl.initializer.get()); }
+    void visitArrayDeclaration(ArrayDeclaration& arrayDecl) override { visit(arrayDecl.initializer.get()); }
+    void visitAssignment(Assignment& assignment) override { visit(assignment.left.get()); visit(assignment.right.get()); }
+    void visitReturnStatement(ReturnStatement& returnStmt) override { visit(returnStmt.value.get()); }
+    void visitIfStatement(IfStatement& ifStmt) override {
+        visit(ifStmt.condition.get());
+        ifStmt.thenBranch->accept(*this);
+        if (ifStmt.elseBranch) ifStmt.elseBranch->accept(*this);
+    }
+    void visitWhileStatement(WhileStatement& whileStmt) override { visit(whileStmt.condition.get()); whileStmt.body->accept(*this); }
+    void visitForStatement(ForStatement& forStmt) override {
+        forStmt.initializer->accept(*this);
+        visit(forStmt.endCondition.get());
+        forStmt.body->accept(*this);
+    }
+    void visitFunction(Function& function) override { for (auto& stmt : function.body) stmt->accept(*this); }
+    void visitBlockStatement(BlockStatement& blockStmt) override { for (auto& stmt : blockStmt.statements) stmt->accept(*this); }
+    void visitExpressionStatement(ExpressionStatement& exprStmt) override { visit(exprStmt.expression.get()); }
+
+    Value visitIdentifier(Identifier&) override { identifiers++; return Value::Void(); }
+    Value visitNumber(Number& number) override { total += number.value; return Value::Void(); }
+    Value visitBooleanLiteral(BooleanLiteral&) override { return Value::Void(); }
+    Value visitBinaryOperation(BinaryOperation& binOp) override { visit(binOp.left.get()); visit(binOp.right.get()); return Value::Void(); }
+    Value visitUnaryOperation(UnaryOperation& unaryOp) override { visit(unaryOp.operand.get()); return Value::Void(); }
+    Value visitFunctionCall(FunctionCall& funcCall) override { for (auto& arg : funcCall.arguments) visit(arg.get()); return Value::Void(); }
+    Value visitArrayAccess(ArrayAccess& arrayAccess) override {
+        visit(arrayAccess.array.get());
+        for (auto& index : arrayAccess.indices) visit(index.get());
+        return Value::Void();
+    }
+
+private:
+    void visit(Expression* expr) { if (expr) expr->accept(*this); }
+};
+
+void benchmarkFlatAst() {
+    const int iterations = 20;
+    std::string code = generateBenchmarkSource(20000);
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+
+    FlatAst flat;
+    Measurement build = measure(1, [&] { flat = FlatAst::build(*program); });
+
+    size_t treeIdentifiers = 0;
+    double treeTotal = 0;
+    Measurement tree = measure(iterations, [&] {
+        TreeWalker walker;
+        program->accept(walker);
+        treeIdentifiers = walker.identifiers;
+        treeTotal = walker.total;
+    });
+
+    // A mesma consulta no AST plano é uma varredura linear do array de nós
+    size_t flatIdentifiers = 0;
+    double flatTotal = 0;
+    Measurement scan = measure(iterations, [&] {
+        flatIdentifiers = 0;
+        flatTotal = 0;
+        for (const FlatNode& node : flat.allNodes()) {
+            if (node.kind == FlatKind::IDENTIFIER) flatIdentifiers++;
+        }
+        for (NodeId id = 0; id < flat.size(); id++) {
+            if (flat.kind(id) == FlatKind::NUMBER) flatTotal += flat.number(id);
+        }
+    });
+    if (treeIdentifiers != flatIdentifiers || treeTotal != flatTotal) std::abort();
+
+    std::printf("flat: %zu nós, %zu identificadores\n", flat.size(), flatIdentifiers);
+    std::printf("  arena (ponteiros)  %6.1f bytes/nó\n", double(program->arena().bytesAllocated()) / flat.size());
+    std::printf("  FlatAst            %6.1f bytes/nó  (construção %.1f ms)\n", double(flat.bytesUsed()) / flat.size(), build.seconds * 1e3);
+    std::printf("  percurso Visitor   %8.2f ms\n", tree.seconds * 1e3);
+    std::printf("  varredura linear   %8.2f ms  speedup %5.2fx\n", scan.seconds * 1e3, tree.seconds / scan.seconds);
+}
+
+// Latência de edição: um projeto de ~200 mil linhas em que uma única função muda
+void benchmarkIncrementalParser() {
+    std::string code = generateBenchmarkSource(8500);
+    std::string edited = code;
+    edited.insert(edited.find("Func4000 := acc;"), "acc := acc * 3;\n");
+    size_t lines = static_cast<size_t>(std::count(code.begin(), code.end(), '\n'));
+
+    Measurement full = measure(3, [&]() {
+        Scanner scanner(code);
+        Parser parser(scanner);
+        auto program = parser.parse();
+    });
+
+    IncrementalParser parser;
+    Measurement first = measure(1, [&]() { parser.parse(code); });
+    int version = 0;
+    Measurement edit = measure(20, [&]() { parser.parse(++version % 2 ? edited : code); });
+    if (parser.reparsedUnits() != 1 || parser.getDiagnostics().size() != 0) std::abort();
+
+    Compiler compiler;
+    compiler.compile(code);
+    Measurement compile = measure(20, [&]() { compiler.compile(++version % 2 ? edited : code); });
+    if (compiler.hasErrors()) std::abort();
+
+    std::printf("incremental: %zu linhas, %zu unidades\n", lines, parser.reparsedUnits() + parser.reusedUnits());
+    std::printf("  parsing completo        %8.2f ms\n", full.seconds * 1e3);
+    std::printf("  primeira versão         %8.2f ms\n", first.seconds * 1e3);
+    std::printf("  edição de uma POU       %8.2f ms  (%zu alocações)  speedup %5.1fx\n", edit.seconds * 1e3,
+                edit.allocations, full.seconds / edit.seconds);
+    std::printf("  compilação após edição  %8.2f ms  (análise semântica de %zu POUs)\n", compile.seconds * 1e3,
+                compiler.checkedUnits());
+}
+
+// Inicialização com fonte inalterado: parsing a frio contra carregar o AST do cache
+void benchmarkAstCache() {
+    std::string code = generateBenchmarkSource(20000);
+    std::string directory = (std::filesystem::temp_directory_path() / "compilador_bench_cache").string();
+
+    Measurement cold = measure(3, [&]() {
+        Scanner scanner(code);
+        Parser parser(scanner);
+        auto program = parser.parse();
+    });
+
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+    AstCache cache(directory);
+    Measurement store = measure(1, [&]() { cache.store(code, FlatAst::build(*program)); });
+    auto entrySize = std::filesystem::file_size(cache.entryPath(hashSource(code)));
+
+    // O mapeamento já está no cache de páginas do sistema, como num boot com o disco aquecido
+    size_t nodes = 0;
+    Measurement load = measure(20, [&]() {
+        auto ast = cache.load(code);
+        nodes = ast ? ast->size() : 0;
+    });
+    if (nodes == 0) std::abort();
+    Measurement tree = measure(3, [&]() {
+        auto ast = cache.load(code);
+        FlatAstAdapter adapter(*ast);
+        auto loaded = adapter.releaseProgram();
+    });
+    std::filesystem::remove_all(directory);
+
+    std::printf("cache: %zu nós, entrada de %.1f MiB (gravação %.1f ms)\n", nodes, entrySize / 1048576.0, store.seconds * 1e3);
+    std::printf("  parsing a frio          %8.2f ms\n", cold.seconds * 1e3);
+    std::printf("  mmap do FlatAst         %8.2f ms  (%zu alocações)  speedup %6.1fx\n", load.seconds * 1e3,
+                load.allocations, cold.seconds / load.seconds);
+    std::printf("  mmap + árvore Visitor   %8.2f ms  speedup %6.1fx\n", tree.seconds * 1e3, cold.seconds / tree.seconds);
+}
+
+// Tabela de símbolos: um projeto com 1M variáveis globais e escopos aninhados curtos
+void benchmarkSymbolTable() {
+    constexpr int GLOBALS = 1000000;
+    std::vector<std::string> names;
+    names.reserve(GLOBALS);
+    for (int i = 0; i < GLOBALS; i++) {
+        names.push_back("g" + std::to_string(i));
+    }
+    // Ordem de consulta embaralhada, para não favorecer a localidade da definição
+    std::vector<uint32_t> order(GLOBALS);
+    for (uint32_t i = 0; i < GLOBALS; i++) {
+        order[i] = static_cast<uint32_t>((static_cast<uint64_t>(i) * 2654435761u) % GLOBALS);
+    }
+
+    SymbolTable table;
+    Measurement define = measure(1, [&]() {
+        for (const auto& name : names) {
+            table.define(name, TypeTable::INTEGER, SymbolType::VARIABLE);
+        }
+    });
+    size_t found = 0;
+    Measurement resolve = measure(3, [&]() {
+        for (uint32_t i : order) {
+            found += table.resolve(names[i]) != nullptr;
+        }
+    });
+    if (found != 3u * GLOBALS) std::abort();
+
+    // Blocos aninhados de IF/WHILE: cada um declara os mesmos nomes locais, sombreando os de fora
+    static const char* locals[] = {"i", "acc", "ratio", "flag"};
+    constexpr int NESTED = 100000;
+    Measurement scopes = measure(1, [&]() {
+        for (int i = 0; i < NESTED; i++) {
+            for (int depth = 0; depth < 8; depth++) {
+                table.enterScope();
+                for (const char* local : locals) {
+                    table.define(local, TypeTable::REAL, SymbolType::VARIABLE);
+                }
+            }
+            found += table.resolve(locals[i & 3])->type == TypeTable::REAL;
+            for (int depth = 0; depth < 8; depth++) {
+                table.exitScope();
+            }
+        }
+    });
+    if (table.resolve("i") != nullptr) std::abort();
+
+    // Globais consultadas de dentro de 16 escopos: o custo não depende da profundidade
+    for (int depth = 0; depth < 16; depth++) {
+        table.enterScope();
+        for (const char* local : locals) {
+            table.define(local, TypeTable::REAL, SymbolType::VARIABLE);
+        }
+    }
+    Measurement deep = measure(3, [&]() {
+        for (uint32_t i : order) {
+            found += table.resolve(names[i]) != nullptr;
+        }
+    });
+    if (found != 6u * GLOBALS + NESTED) std::abort();
+
+    std::string code = generateBenchmarkSource(20000);
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+    Measurement analysis = measure(3, [&]() {
+        SemanticAnalyzer analyzer;
+        analyzer.analyze(program.get());
+    });
+
+    std::printf("simbolos: %d globais, tabela com %.1f MiB (%zu bytes por símbolo)\n", GLOBALS,
+                table.bytesUsed() / 1048576.0, table.bytesUsed() / GLOBALS);
+    std::printf("  definição               %8.2f ns/símbolo\n", define.seconds * 1e9 / GLOBALS);
+    std::printf("  resolução               %8.2f ns/consulta\n", resolve.seconds * 1e9 / GLOBALS);
+    std::printf("  resolução a 16 escopos  %8.2f ns/consulta\n", deep.seconds * 1e9 / GLOBALS);
+    std::printf("  escopo com 4 símbolos   %8.2f ns  (%zu alocações)\n", scopes.seconds * 1e9 / (NESTED * 8),
+                scopes.allocations);
+    std::printf("  análise semântica       %8.2f ms  (20000 POUs)\n", analysis.seconds * 1e3);
+}
+
+// Análise semântica de 20000 POUs com 1 thread e com várias na segunda fase
+void benchmarkSemanticAnalysis() {
+    std::string code = generateBenchmarkSource(20000);
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("semantica: 20000 POUs, %u núcleos\n", hardware);
+    SemanticAnalyzer warmup;
+    warmup.analyze(program.get());
+    double sequential = 0;
+    for (unsigned threads = 1; threads <= std::max(8u, hardware); threads *= 2) {
+        Measurement analysis = measure(5, [&]() {
+            SemanticAnalyzer analyzer;
+            analyzer.setThreadCount(threads);
+            analyzer.analyze(program.get());
+        });
+        if (threads == 1) sequential = analysis.seconds;
+        std::printf("  %2u threads              %8.2f ms  speedup %5.2fx\n", threads, analysis.seconds * 1e3,
+                    sequential / analysis.seconds);
+    }
+}
+
+// Otimizador sobre um programa grande já analisado: nós percorridos por segundo
+void benchmarkOptimizer() {
+    std::string code = generateBenchmarkSource(20000);
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+    SemanticAnalyzer analyzer;
+    analyzer.analyze(program.get());
+
+    // A primeira passada dobra as constantes; as seguintes percorrem a mesma árvore
+    ASTOptimizer optimizer;
+    Measurement first = measure(1, [&]() { optimizer.optimize(program.get()); });
+    size_t simplifications = optimizer.simplifications();
+    size_t nodes = FlatAst::build(*program).size();
+    Measurement pass = measure(10, [&]() { optimizer.optimize(program.get()); });
+
+    // Código gerado com chaves de configuração constantes, como o exportado por fornecedores
+    std::string configured;
+    for (int i = 0; i < 5000; i++) {
+        std::string name = "Config" + std::to_string(i);
+        configured += "FUNCTION " + name + " : INTEGER\nVAR\n    x : INTEGER := " + std::to_string(i % 7) + ";\nEND_VAR\n";
+        configured += "IF (FALSE) THEN\n    x := x * 3 + 1;\n    x := x - 2;\nEND_IF\n";
+        configured += "IF (2 > 1) THEN\n    x := x + 1;\nELSE\n    x := 0;\nEND_IF\n";
+        configured += "WHILE (1 = 2) DO\n    x := x + 5;\nEND_WHILE\n";
+        configured += name + " := x;\nRETURN x;\nx := 99;\nEND_FUNCTION\n";
+    }
+    Scanner configScanner(configured);
+    Parser configParser(configScanner);
+    auto configProgram = configParser.parse();
+    analyzer.analyze(configProgram.get());
+    size_t configNodes = FlatAst::build(*configProgram).size();
+    Measurement dce = measure(1, [&]() { optimizer.optimize(configProgram.get()); });
+    size_t removed = optimizer.removedNodes();
+
+    // Intertravamentos que repetem as mesmas comparações a cada varredura
+    std::string interlocks;
+    for (int i = 0; i < 5000; i++) {
+        interlocks += "PROGRAM Interlock" + std::to_string(i) + "\nVAR\n    p : REAL := 2.5;\n    limit : REAL := 4.5;\n";
+        interlocks += "    enable : BOOLEAN := TRUE;\n    trips : INTEGER := 0;\n    alarm : BOOLEAN;\nEND_VAR\n";
+        interlocks += "alarm := p * 1.5 > limit AND enable;\n";
+        interlocks += "IF (p * 1.5 > limit AND enable) THEN\n    trips := trips + 1;\nEND_IF\n";
+        interlocks += "IF (p * 1.5 > limit AND enable OR trips > 3) THEN\n    trips := 0;\nEND_IF\n";
+        interlocks += "END_PROGRAM\n";
+    }
+    Scanner interlockScanner(interlocks);
+    Parser interlockParser(interlockScanner);
+    auto interlockProgram = interlockParser.parse();
+    analyzer.analyze(interlockProgram.get());
+    Measurement cse = measure(1, [&]() { optimizer.optimize(interlockProgram.get()); });
+    size_t cseHits = 0;
+    for (const auto& pou : optimizer.commonSubexpressions()) {
+        cseHits += pou.hits;
+    }
+
+    std::printf("otimizador: 20000 POUs, %zu nós\n", nodes);
+    std::printf("  primeira passada        %8.2f ms  (%zu simplificações)\n", first.seconds * 1e3, simplifications);
+    std::printf("  passada                 %8.2f ms  %6.1f M nós/s\n", pass.seconds * 1e3, nodes / pass.seconds / 1e6);
+    std::printf("  código morto            %8.2f ms  %zu de %zu nós removidos\n", dce.seconds * 1e3,
+                removed, configNodes);
+    std::printf("  subexpressões comuns    %8.2f ms  %zu reaproveitadas em %zu POUs\n", cse.seconds * 1e3, cseHits,
+                optimizer.commonSubexpressions().size());
+}
+
+} // namespace
+
+std::string generateBenchmarkSource(int units) {
+    std::string code;
+    code.reserve(static_cast<size_t>(units) * 512);
+    for (int i = 0; i < units; i++) {
+        std::string name = "Func" + std::to_string(i);
+        code += "(* Unidade gerada " + std::to_string(i) + " *)\n";
+        code += "FUNCTION " + name + " : INTEGER\n";
+        code += "VAR_INPUT\n    a : INTEGER;\n    b : INTEGER;\nEND_VAR\n";
+        code += "VAR\n    i : INTEGER := 0;\n    acc : INTEGER := 0;\n    ratio : REAL := 1.5;\n    flag : BOOLEAN := TRUE;\nEND_VAR\n";
+        code += "acc := a * 2 + b - 3;\n";
+        code += "IF (acc > 10 AND flag) THEN\n    acc := acc - 1;\nELSE\n    acc := acc + 1;\nEND_IF\n";
+        code += "WHILE (i < 10) DO\n    i := i + 1;\nEND_WHILE\n";
+        code += name + " := acc;\n";
+        code += "END_FUNCTION\n\n";
+    }
+    return code;
+}
+
+void runBenchmarks(const std::string& filter) {
+    struct Benchmark {
+        const char* name;
+        void (*run)();
+    };
+    const Benchmark benchmarks[] = {
+        {"scanner", benchmarkScanner},
+        {"comentarios", benchmarkCommentSkipping},
+        {"fluxo", benchmarkStreamingParser},
+        {"layout", benchmarkTokenLayout},
+        {"paralelo", benchmarkParallelParser},
+        {"ast", benchmarkAstAllocation},
+        {"flat", benchmarkFlatAst},
+        {"expressoes", benchmarkExpressions},
+        {"declaracoes", benchmarkDeclarations},
+        {"incremental", benchmarkIncrementalParser},
+        {"cache", benchmarkAstCache},
+        {"simbolos", benchmarkSymbolTable},
+        {"semantica", benchmarkSemanticAnalysis},
+        {"otimizador", benchmarkOptimizer},
+    };
+    if (!allocationsCounted()) {
+        std::printf("(alocações não contadas: use o executável CompiladorBench)\n");
+    }
+    for (const auto& benchmark : benchmarks) {
+        if (filter.empty() || std::string(benchmark.name).find(filter) != std::string::npos) {
+            benchmark.run();
+        }
+    }
+}
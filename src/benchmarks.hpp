@@ -0,0 +1,14 @@
+// benchmarks.hpp
+
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+#include <string>
+
+// Gera um código-fonte ST sintético com 'units' funções (usado nos benchmarks)
+std::string generateBenchmarkSource(int units);
+
+// Executa os benchmarks cujo nome contém 'filter' (vazio executa todos)
+void runBenchmarks(const std::string& filter);
+
+#endif // BENCHMARKS_HPP
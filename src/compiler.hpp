@@ -3,16 +3,53 @@
 #ifndef COMPILER_HPP
 #define COMPILER_HPP
 
+#include <memory>
 #include <string>
-#include "symbol_table.hpp"
+#include <vector>
+#include "ast.hpp"
+#include "ast_cache.hpp"
+#include "diagnostic.hpp"
+#include "incremental_parser.hpp"
+#include "semantic_analyzer.hpp"
 
+// Ponto de entrada da compilação. Pensado para ser chamado a cada edição:
+// guarda o resultado da versão anterior e só analisa de novo as POUs cujo
+// texto mudou (ver IncrementalParser) e só verifica de novo as POUs alteradas
+// ou afetadas pela edição (ver SemanticAnalyzer::setIncremental). Com um cache de ASTs, a primeira
+// compilação de um fonte já compilado antes carrega a árvore do cache.
 class Compiler {
 public:
     Compiler();
+
+    // Usa (e preenche) o cache de ASTs em 'cacheDirectory'
+    explicit Compiler(const std::string& cacheDirectory);
+
+    // Compila uma nova versão do fonte; os erros ficam em getDiagnostics()
     void compile(const std::string& sourceCode);
 
+    // Erros de sintaxe ou, se não houver, os erros semânticos
+    const std::vector<Diagnostic>& getDiagnostics() const { return diagnostics; }
+    bool hasErrors() const { return !diagnostics.empty(); }
+
+    // Árvore da última compilação; compartilhada com o cache, não deve ser modificada
+    const Program* getProgram() const { return program.get(); }
+
+    // A última compilação carregou a árvore do cache em vez de analisar o fonte
+    bool loadedFromCache() const { return fromCache; }
+
+    // POUs cuja análise semântica foi refeita na última compilação
+    size_t checkedUnits() const { return analyzer.checkedUnits(); }
+
 private:
-    SymbolTable symbolTable;
+    IncrementalParser parser;
+    bool parsedBefore = false; // O IncrementalParser já tem uma versão anterior
+    SemanticAnalyzer analyzer;  // Incremental: guarda o resultado de cada POU
+    std::unique_ptr<AstCache> cache;
+    bool fromCache = false;
+    std::unique_ptr<Program> program;
+    std::vector<Diagnostic> diagnostics;
+
+    void analyze();
 };
 
 #endif // COMPILER_HPP
@@ -0,0 +1,19 @@
+// diagnostic.hpp
+
+#ifndef DIAGNOSTIC_HPP
+#define DIAGNOSTIC_HPP
+
+#include <string>
+
+// Erro encontrado durante a compilação, com a linha do fonte onde ocorreu
+// (0 se desconhecida)
+struct Diagnostic {
+    int line;
+    std::string message;
+
+    std::string toString() const {
+        return line > 0 ? "linha " + std::to_string(line) + ": " + message : message;
+    }
+};
+
+#endif // DIAGNOSTIC_HPP
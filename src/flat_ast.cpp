@@ -0,0 +1,534 @@
+// flat_ast.cpp
+
+#include "flat_ast.hpp"
+#include "value.hpp"
+#include <stdexcept>
+#include <unordered_map>
+
+// Percorre a árvore de ponteiros e grava os nós em pré-ordem no FlatAst
+class FlatAstBuilder : public Visitor {
+public:
+    explicit FlatAstBuilder(FlatAst& ast) : data(ast.storage) {}
+
+    NodeId add(Statement* stmt) {
+        if (!stmt) return NO_NODE;
+        stmt->accept(*this);
+        return last;
+    }
+
+    NodeId add(Expression* expr) {
+        if (!expr) return NO_NODE;
+        expr->accept(*this);
+        return last;
+    }
+
+    void visitProgram(Program& program) override {
+        NodeId id = open(FlatKind::PROGRAM);
+        closeList(id, addStatements(program.statements));
+    }
+
+    void visitVariableDeclaration(VariableDeclaration& varDecl) override {
+        NodeId id = open(FlatKind::VARIABLE_DECLARATION);
+        data.nodes[id].a = intern(varDecl.name);
+        data.nodes[id].b = intern(varDecl.type);
+        data.nodes[id].flags = static_cast<uint8_t>(varDecl.section);
+        NodeId initializer = add(varDecl.initializer.get());
+        data.nodes[id].c = initializer;
+        last = id;
+    }
+
+    void visitArrayDeclaration(ArrayDeclaration& arrayDecl) override {
+        NodeId id = open(FlatKind::ARRAY_DECLARATION);
+        data.nodes[id].a = intern(arrayDecl.name);
+        data.nodes[id].b = intern(arrayDecl.baseType);
+        data.nodes[id].flags = static_cast<uint8_t>(arrayDecl.section);
+        data.nodes[id].first = static_cast<uint32_t>(data.dimensions.size());
+        data.nodes[id].count = static_cast<uint32_t>(arrayDecl.dimensions.size());
+        data.dimensions.insert(data.dimensions.end(), arrayDecl.dimensions.begin(), arrayDecl.dimensions.end());
+        NodeId initializer = add(arrayDecl.initializer.get());
+        data.nodes[id].c = initializer;
+        last = id;
+    }
+
+    void visitAssignment(Assignment& assignment) override {
+        NodeId id = open(FlatKind::ASSIGNMENT);
+        NodeId left = add(assignment.left.get());
+        NodeId right = add(assignment.right.get());
+        data.nodes[id].a = left;
+        data.nodes[id].b = right;
+        last = id;
+    }
+
+    void visitReturnStatement(ReturnStatement& returnStmt) override {
+        NodeId id = open(FlatKind::RETURN_STATEMENT);
+        NodeId value = add(returnStmt.value.get());
+        data.nodes[id].a = value;
+        last = id;
+    }
+
+    void visitIfStatement(IfStatement& ifStmt) override {
+        NodeId id = open(FlatKind::IF_STATEMENT);
+        NodeId condition = add(ifStmt.condition.get());
+        NodeId thenBranch = add(ifStmt.thenBranch.get());
+        NodeId elseBranch = add(ifStmt.elseBranch.get());
+        data.nodes[id].a = condition;
+        data.nodes[id].b = thenBranch;
+        data.nodes[id].c = elseBranch;
+        last = id;
+    }
+
+    void visitWhileStatement(WhileStatement& whileStmt) override {
+        NodeId id = open(FlatKind::WHILE_STATEMENT);
+        NodeId condition = add(whileStmt.condition.get());
+        NodeId body = add(whileStmt.body.get());
+        data.nodes[id].a = condition;
+        data.nodes[id].b = body;
+        last = id;
+    }
+
+    void visitForStatement(ForStatement& forStmt) override {
+        NodeId id = open(FlatKind::FOR_STATEMENT);
+        NodeId initializer = add(forStmt.initializer.get());
+        NodeId endCondition = add(forStmt.endCondition.get());
+        NodeId body = add(forStmt.body.get());
+        data.nodes[id].a = initializer;
+        data.nodes[id].b = endCondition;
+        data.nodes[id].c = body;
+        last = id;
+    }
+
+    void visitFunction(Function& function) override {
+        NodeId id = open(FlatKind::FUNCTION);
+        data.nodes[id].a = intern(function.name);
+        data.nodes[id].b = intern(function.returnType);
+        data.nodes[id].c = static_cast<uint32_t>(function.pouKind);
+        closeList(id, addStatements(function.body));
+    }
+
+    void visitBlockStatement(BlockStatement& blockStmt) override {
+        NodeId id = open(FlatKind::BLOCK_STATEMENT);
+        closeList(id, addStatements(blockStmt.statements));
+    }
+
+    void visitExpressionStatement(ExpressionStatement& exprStmt) override {
+        NodeId id = open(FlatKind::EXPRESSION_STATEMENT);
+        NodeId expression = add(exprStmt.expression.get());
+        data.nodes[id].a = expression;
+        last = id;
+    }
+
+    Value visitIdentifier(Identifier& identifier) override {
+        NodeId id = open(FlatKind::IDENTIFIER);
+        data.nodes[id].a = intern(identifier.name);
+        last = id;
+        return Value::Void();
+    }
+
+    Value visitNumber(Number& number) override {
+        NodeId id = open(FlatKind::NUMBER);
+        data.nodes[id].a = static_cast<uint32_t>(data.numbers.size());
+        data.nodes[id].flags = static_cast<uint8_t>(number.literal);
+        data.numbers.push_back(number.value);
+        last = id;
+        return Value::Void();
+    }
+
+    Value visitBooleanLiteral(BooleanLiteral& boolLit) override {
+        NodeId id = open(FlatKind::BOOLEAN_LITERAL);
+        data.nodes[id].a = boolLit.value ? 1 : 0;
+        last = id;
+        return Value::Void();
+    }
+
+    Value visitBinaryOperation(BinaryOperation& binOp) override {
+        NodeId id = open(FlatKind::BINARY_OPERATION);
+        data.nodes[id].op = binOp.op;
+        NodeId left = add(binOp.left.get());
+        NodeId right = add(binOp.right.get());
+        data.nodes[id].a = left;
+        data.nodes[id].b = right;
+        last = id;
+        return Value::Void();
+    }
+
+    Value visitUnaryOperation(UnaryOperation& unaryOp) override {
+        NodeId id = open(FlatKind::UNARY_OPERATION);
+        data.nodes[id].op = unaryOp.op;
+        NodeId operand = add(unaryOp.operand.get());
+        data.nodes[id].a = operand;
+        last = id;
+        return Value::Void();
+    }
+
+    Value visitFunctionCall(FunctionCall& funcCall) override {
+        NodeId id = open(FlatKind::FUNCTION_CALL);
+        data.nodes[id].a = intern(funcCall.functionName);
+        size_t mark = pending.size();
+        for (size_t i = 0; i < funcCall.arguments.size(); i++) {
+            const ArgumentBinding& binding = funcCall.bindings[i];
+            if (binding.parameter.empty()) {
+                pending.push_back(add(funcCall.arguments[i].get()));
+                continue;
+            }
+            NodeId argument = open(FlatKind::ARGUMENT);
+            data.nodes[argument].a = intern(binding.parameter);
+            data.nodes[argument].flags = binding.output ? 1 : 0;
+            NodeId value = add(funcCall.arguments[i].get());
+            data.nodes[argument].b = value;
+            pending.push_back(argument);
+        }
+        closeList(id, mark);
+        return Value::Void();
+    }
+
+    Value visitArrayAccess(ArrayAccess& arrayAccess) override {
+        NodeId id = open(FlatKind::ARRAY_ACCESS);
+        NodeId array = add(arrayAccess.array.get());
+        data.nodes[id].a = array;
+        size_t mark = pending.size();
+        for (auto& index : arrayAccess.indices) {
+            pending.push_back(add(index.get()));
+        }
+        closeList(id, mark);
+        return Value::Void();
+    }
+
+private:
+    FlatAst::Storage& data;
+    NodeId last = NO_NODE;
+    std::unordered_map<std::string_view, uint32_t> names;
+
+    // Pilha de filhos ainda não gravados; listas aninhadas ficam acima da
+    // lista do pai e são retiradas antes dele, então cada lista sai contígua
+    std::vector<NodeId> pending;
+
+    NodeId open(FlatKind kind) {
+        if (data.nodes.size() >= NO_NODE) {
+            throw std::runtime_error("AST grande demais para índices de 32 bits.");
+        }
+        NodeId id = static_cast<NodeId>(data.nodes.size());
+        data.nodes.push_back(FlatNode{kind});
+        return id;
+    }
+
+    size_t addStatements(const NodeList<Statement>& statements) {
+        size_t mark = pending.size();
+        for (auto& stmt : statements) {
+            NodeId child = add(stmt.get());
+            if (child != NO_NODE) pending.push_back(child);
+        }
+        return mark;
+    }
+
+    void closeList(NodeId id, size_t mark) {
+        data.nodes[id].first = static_cast<uint32_t>(data.children.size());
+        data.nodes[id].count = static_cast<uint32_t>(pending.size() - mark);
+        data.children.insert(data.children.end(), pending.begin() + mark, pending.end());
+        pending.resize(mark);
+        last = id;
+    }
+
+    uint32_t intern(std::string_view text) {
+        auto [it, inserted] = names.try_emplace(text, static_cast<uint32_t>(data.nameOffsets.size()));
+        if (inserted) {
+            data.nameOffsets.push_back(static_cast<uint32_t>(data.nameText.size()));
+            data.nameLengths.push_back(static_cast<uint32_t>(text.size()));
+            data.nameText.insert(data.nameText.end(), text.begin(), text.end());
+        }
+        return it->second;
+    }
+};
+
+FlatAst FlatAst::build(const Program& program) {
+    FlatAst ast;
+    FlatAstBuilder builder(ast);
+    builder.visitProgram(const_cast<Program&>(program));
+    ast.attach();
+    return ast;
+}
+
+std::span<const NodeId> FlatAst::childrenOf(NodeId id) const {
+    const FlatNode& n = nodes[id];
+    if (n.kind == FlatKind::ARRAY_DECLARATION) return {}; // A faixa aponta para 'dimensions'
+    return std::span<const NodeId>(children.data() + n.first, n.count);
+}
+
+std::span<const std::pair<int, int>> FlatAst::dimensionsOf(NodeId id) const {
+    const FlatNode& n = nodes[id];
+    if (n.kind != FlatKind::ARRAY_DECLARATION) return {};
+    return std::span<const std::pair<int, int>>(dimensions.data() + n.first, n.count);
+}
+
+std::string_view FlatAst::name(uint32_t nameId) const {
+    return std::string_view(nameText.data() + nameOffsets[nameId], nameLengths[nameId]);
+}
+
+bool FlatAst::isWellFormed() const {
+    if (nodes.empty() || nodes.front().kind != FlatKind::PROGRAM || nameOffsets.size() != nameLengths.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < nameOffsets.size(); i++) {
+        if (uint64_t{nameOffsets[i]} + nameLengths[i] > nameText.size()) {
+            return false;
+        }
+    }
+
+    auto isStatement = [](FlatKind kind) { return kind > FlatKind::PROGRAM && kind <= FlatKind::EXPRESSION_STATEMENT; };
+    auto isExpression = [](FlatKind kind) { return kind >= FlatKind::IDENTIFIER && kind <= FlatKind::ARRAY_ACCESS; };
+    auto isArgument = [&](FlatKind kind) { return isExpression(kind) || kind == FlatKind::ARGUMENT; };
+    auto isAssignment = [](FlatKind kind) { return kind == FlatKind::ASSIGNMENT; };
+    auto isName = [&](uint32_t nameId) { return nameId < nameOffsets.size(); };
+
+    // Os filhos vêm depois do pai (o FlatAstAdapter os reconstrói antes dele) e
+    // cada nó tem um só pai
+    std::vector<bool> referenced(nodes.size());
+    auto isChild = [&](NodeId parent, NodeId child, auto accepts, bool optional) {
+        if (child == NO_NODE) {
+            return optional;
+        }
+        if (child <= parent || child >= nodes.size() || referenced[child] || !accepts(nodes[child].kind)) {
+            return false;
+        }
+        referenced[child] = true;
+        return true;
+    };
+    auto isList = [&](NodeId parent, auto accepts) {
+        const FlatNode& n = nodes[parent];
+        if (uint64_t{n.first} + n.count > children.size()) {
+            return false;
+        }
+        for (NodeId child : children.subspan(n.first, n.count)) {
+            if (!isChild(parent, child, accepts, false)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (NodeId id = 0; id < nodes.size(); id++) {
+        const FlatNode& n = nodes[id];
+        bool valid = false;
+        switch (n.kind) {
+            case FlatKind::PROGRAM:
+                valid = id == 0 && isList(id, isStatement);
+                break;
+            case FlatKind::VARIABLE_DECLARATION:
+                valid = isName(n.a) && isName(n.b) && n.flags <= static_cast<uint8_t>(VarSection::OUTPUT) &&
+                        isChild(id, n.c, isExpression, true);
+                break;
+            case FlatKind::ARRAY_DECLARATION:
+                valid = isName(n.a) && isName(n.b) && n.flags <= static_cast<uint8_t>(VarSection::OUTPUT) &&
+                        uint64_t{n.first} + n.count <= dimensions.size() && isChild(id, n.c, isExpression, true);
+                break;
+            case FlatKind::ASSIGNMENT:
+                valid = isChild(id, n.a, isExpression, false) && isChild(id, n.b, isExpression, false);
+                break;
+            case FlatKind::RETURN_STATEMENT:
+            case FlatKind::EXPRESSION_STATEMENT:
+                valid = isChild(id, n.a, isExpression, false);
+                break;
+            case FlatKind::IF_STATEMENT:
+                valid = isChild(id, n.a, isExpression, false) && isChild(id, n.b, isStatement, false) &&
+                        isChild(id, n.c, isStatement, true);
+                break;
+            case FlatKind::WHILE_STATEMENT:
+                valid = isChild(id, n.a, isExpression, false) && isChild(id, n.b, isStatement, false);
+                break;
+            case FlatKind::FOR_STATEMENT:
+                valid = isChild(id, n.a, isAssignment, false) && isChild(id, n.b, isExpression, false) &&
+                        isChild(id, n.c, isStatement, false);
+                break;
+            case FlatKind::FUNCTION:
+                valid = isName(n.a) && isName(n.b) && n.c <= static_cast<uint32_t>(PouKind::PROGRAM) &&
+                        isList(id, isStatement);
+                break;
+            case FlatKind::BLOCK_STATEMENT:
+                valid = isList(id, isStatement);
+                break;
+            case FlatKind::IDENTIFIER:
+                valid = isName(n.a);
+                break;
+            case FlatKind::NUMBER:
+                valid = n.a < numbers.size() && (n.flags == static_cast<uint8_t>(LiteralKind::INTEGER) ||
+                                                  n.flags == static_cast<uint8_t>(LiteralKind::REAL));
+                break;
+            case FlatKind::BOOLEAN_LITERAL:
+                valid = n.a <= 1;
+                break;
+            case FlatKind::BINARY_OPERATION:
+                valid = n.op <= OperatorType::NOT && isChild(id, n.a, isExpression, false) &&
+                        isChild(id, n.b, isExpression, false);
+                break;
+            case FlatKind::UNARY_OPERATION:
+                valid = n.op <= OperatorType::NOT && isChild(id, n.a, isExpression, false);
+                break;
+            case FlatKind::FUNCTION_CALL:
+                valid = isName(n.a) && isList(id, isArgument);
+                break;
+            case FlatKind::ARRAY_ACCESS:
+                valid = isChild(id, n.a, isExpression, false) && isList(id, isExpression);
+                break;
+            case FlatKind::ARGUMENT:
+                valid = isName(n.a) && isChild(id, n.b, isExpression, false);
+                break;
+        }
+        if (!valid) {
+            return false; // Inclui um 'kind' fora de FlatKind
+        }
+    }
+    return true;
+}
+
+void FlatAst::attach() {
+    nodes = storage.nodes;
+    children = storage.children;
+    dimensions = storage.dimensions;
+    numbers = storage.numbers;
+    nameText = std::string_view(storage.nameText.data(), storage.nameText.size());
+    nameOffsets = storage.nameOffsets;
+    nameLengths = storage.nameLengths;
+}
+
+size_t FlatAst::bytesUsed() const {
+    if (mapping) {
+        return nodes.size_bytes() + children.size_bytes() + dimensions.size_bytes() + numbers.size_bytes() +
+               nameText.size() + nameOffsets.size_bytes() + nameLengths.size_bytes();
+    }
+    return storage.nodes.capacity() * sizeof(FlatNode) +
+           storage.children.capacity() * sizeof(NodeId) +
+           storage.dimensions.capacity() * sizeof(std::pair<int, int>) +
+           storage.numbers.capacity() * sizeof(double) +
+           storage.nameText.capacity() +
+           (storage.nameOffsets.capacity() + storage.nameLengths.capacity()) * sizeof(uint32_t);
+}
+
+FlatAstAdapter::FlatAstAdapter(const FlatAst& ast) : ast(ast) {
+    materialize();
+}
+
+std::unique_ptr<Program> FlatAstAdapter::releaseProgram() {
+    materialized.clear();
+    return std::move(tree);
+}
+
+void FlatAstAdapter::accept(Visitor& visitor) {
+    tree->accept(visitor);
+}
+
+void FlatAstAdapter::accept(NodeId id, Visitor& visitor) {
+    static_cast<Statement*>(materialized[id])->accept(visitor);
+}
+
+void FlatAstAdapter::materialize() {
+    auto arena = std::make_shared<AstArena>();
+    tree = std::make_unique<Program>(arena);
+    materialized.assign(ast.size(), nullptr);
+
+    auto name = [&](uint32_t nameId) { return arena->copyString(ast.name(nameId)); };
+    auto statement = [&](NodeId id) {
+        return NodePtr<Statement>(id == NO_NODE ? nullptr : static_cast<Statement*>(materialized[id]));
+    };
+    auto expression = [&](NodeId id) {
+        return NodePtr<Expression>(id == NO_NODE ? nullptr : static_cast<Expression*>(materialized[id]));
+    };
+    auto statements = [&](NodeId id) {
+        NodeList<Statement> list(arena.get());
+        for (NodeId child : ast.childrenOf(id)) list.push_back(statement(child));
+        return list;
+    };
+    auto expressions = [&](NodeId id) {
+        NodeList<Expression> list(arena.get());
+        for (NodeId child : ast.childrenOf(id)) list.push_back(expression(child));
+        return list;
+    };
+
+    // Os filhos têm índices maiores que o pai, então percorrer de trás para
+    // frente reconstrói cada filho antes de quem o referencia
+    for (NodeId id = static_cast<NodeId>(ast.size()); id-- > 0;) {
+        const FlatNode& n = ast.node(id);
+        Node* node = nullptr;
+        switch (n.kind) {
+            case FlatKind::PROGRAM:
+                for (NodeId child : ast.childrenOf(id)) tree->addStatement(statement(child));
+                node = tree.get();
+                break;
+            case FlatKind::VARIABLE_DECLARATION: {
+                auto varDecl = makeNode<VariableDeclaration>(*arena, name(n.a), name(n.b), expression(n.c));
+                varDecl->section = static_cast<VarSection>(n.flags);
+                node = varDecl.release();
+                break;
+            }
+            case FlatKind::ARRAY_DECLARATION: {
+                auto dims = ast.dimensionsOf(id);
+                std::pmr::vector<std::pair<int, int>> dimensions(dims.begin(), dims.end(), arena.get());
+                auto arrayDecl = makeNode<ArrayDeclaration>(*arena, name(n.a), name(n.b), std::move(dimensions), expression(n.c));
+                arrayDecl->section = static_cast<VarSection>(n.flags);
+                node = arrayDecl.release();
+                break;
+            }
+            case FlatKind::ASSIGNMENT:
+                node = makeNode<Assignment>(*arena, expression(n.a), expression(n.b)).release();
+                break;
+            case FlatKind::RETURN_STATEMENT:
+                node = makeNode<ReturnStatement>(*arena, expression(n.a)).release();
+                break;
+            case FlatKind::IF_STATEMENT:
+                node = makeNode<IfStatement>(*arena, expression(n.a), statement(n.b), statement(n.c)).release();
+                break;
+            case FlatKind::WHILE_STATEMENT:
+                node = makeNode<WhileStatement>(*arena, expression(n.a), statement(n.b)).release();
+                break;
+            case FlatKind::FOR_STATEMENT:
+                node = makeNode<ForStatement>(*arena, NodePtr<Assignment>(static_cast<Assignment*>(materialized[n.a])),
+                                              expression(n.b), statement(n.c)).release();
+                break;
+            case FlatKind::FUNCTION:
+                node = makeNode<Function>(*arena, name(n.a), name(n.b), statements(id), static_cast<PouKind>(n.c)).release();
+                break;
+            case FlatKind::BLOCK_STATEMENT:
+                node = makeNode<BlockStatement>(*arena, statements(id)).release();
+                break;
+            case FlatKind::EXPRESSION_STATEMENT:
+                node = makeNode<ExpressionStatement>(*arena, expression(n.a)).release();
+                break;
+            case FlatKind::IDENTIFIER:
+                node = makeNode<Identifier>(*arena, name(n.a)).release();
+                break;
+            case FlatKind::NUMBER:
+                node = makeNode<Number>(*arena, ast.number(id), static_cast<LiteralKind>(n.flags)).release();
+                break;
+            case FlatKind::BOOLEAN_LITERAL:
+                node = makeNode<BooleanLiteral>(*arena, n.a != 0).release();
+                break;
+            case FlatKind::BINARY_OPERATION:
+                node = makeNode<BinaryOperation>(*arena, n.op, expression(n.a), expression(n.b)).release();
+                break;
+            case FlatKind::UNARY_OPERATION:
+                node = makeNode<UnaryOperation>(*arena, n.op, expression(n.a)).release();
+                break;
+            case FlatKind::FUNCTION_CALL: {
+                NodeList<Expression> arguments(arena.get());
+                std::pmr::vector<ArgumentBinding> bindings(arena.get());
+                for (NodeId child : ast.childrenOf(id)) {
+                    const FlatNode& argument = ast.node(child);
+                    if (argument.kind == FlatKind::ARGUMENT) {
+                        arguments.push_back(expression(argument.b));
+                        bindings.push_back({name(argument.a), argument.flags != 0});
+                    } else {
+                        arguments.push_back(expression(child));
+                        bindings.emplace_back();
+                    }
+                }
+                node = makeNode<FunctionCall>(*arena, name(n.a), std::move(arguments), std::move(bindings)).release();
+                break;
+            }
+            case FlatKind::ARRAY_ACCESS:
+                node = makeNode<ArrayAccess>(*arena, expression(n.a), expressions(id)).release();
+                break;
+            case FlatKind::ARGUMENT:
+                node = materialized[n.b]; // Desfeito pela chamada: o argumento é o próprio valor
+                break;
+        }
+        materialized[id] = node;
+    }
+}
@@ -0,0 +1,179 @@
+// flat_ast.hpp
+
+#ifndef FLAT_AST_HPP
+#define FLAT_AST_HPP
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "ast.hpp"
+#include "operator_type.hpp"
+#include "source_file.hpp"
+
+// Índice de um nó dentro do FlatAst
+using NodeId = uint32_t;
+inline constexpr NodeId NO_NODE = std::numeric_limits<NodeId>::max();
+
+enum class FlatKind : uint8_t {
+    PROGRAM,
+    VARIABLE_DECLARATION,
+    ARRAY_DECLARATION,
+    ASSIGNMENT,
+    RETURN_STATEMENT,
+    IF_STATEMENT,
+    WHILE_STATEMENT,
+    FOR_STATEMENT,
+    FUNCTION,
+    BLOCK_STATEMENT,
+    EXPRESSION_STATEMENT,
+    IDENTIFIER,
+    NUMBER,
+    BOOLEAN_LITERAL,
+    BINARY_OPERATION,
+    UNARY_OPERATION,
+    FUNCTION_CALL,
+    ARRAY_ACCESS,
+    ARGUMENT,
+};
+
+// Nó do AST plano. O significado dos campos depende do tipo:
+//
+//   PROGRAM, BLOCK_STATEMENT   children[first, first + count) são as declarações
+//   FUNCTION                   a = nome, b = tipo de retorno, c = PouKind, children = corpo
+//   VARIABLE_DECLARATION       a = nome, b = tipo, c = inicializador, flags = VarSection
+//   ARRAY_DECLARATION          a = nome, b = tipo base, c = inicializador, flags = VarSection,
+//                              dimensions[first, first + count) são os limites
+//   ASSIGNMENT                 a = destino, b = valor
+//   RETURN_STATEMENT           a = valor
+//   IF_STATEMENT               a = condição, b = então, c = senão
+//   WHILE_STATEMENT            a = condição, b = corpo
+//   FOR_STATEMENT              a = inicialização, b = limite, c = corpo
+//   EXPRESSION_STATEMENT       a = expressão
+//   IDENTIFIER                 a = nome
+//   NUMBER                     a = índice em numbers, flags = LiteralKind
+//   BOOLEAN_LITERAL            a = 0 ou 1
+//   BINARY_OPERATION           op, a = esquerda, b = direita
+//   UNARY_OPERATION            op, a = operando
+//   FUNCTION_CALL              a = nome, children = argumentos
+//   ARRAY_ACCESS               a = array, children = índices
+//   ARGUMENT                   a = parâmetro, b = valor, flags = 1 se saída ('=>');
+//                              só para argumentos nomeados (os posicionais são o próprio valor)
+//
+// Nomes são índices na tabela de nomes; filhos ausentes valem NO_NODE.
+struct FlatNode {
+    FlatKind kind;
+    OperatorType op = OperatorType::ADD;
+    uint8_t flags = 0;
+    uint32_t a = NO_NODE;
+    uint32_t b = NO_NODE;
+    uint32_t c = NO_NODE;
+    uint32_t first = 0;
+    uint32_t count = 0;
+};
+
+// Representação plana do AST: os nós ficam em arrays contíguos e se referem
+// uns aos outros por índices de 32 bits. Os nós são gravados em pré-ordem
+// (pai antes dos filhos), então percorrer a árvore inteira é uma varredura
+// linear de 'nodes'. Listas de filhos são faixas contíguas em 'children'.
+//
+// Como não há ponteiros, os arrays podem vir de um arquivo mapeado em memória
+// (ver AstCache) sem conversão: o FlatAst então só guarda visões sobre o
+// mapeamento e o mantém vivo.
+class FlatAst {
+public:
+    FlatAst() = default;
+    FlatAst(FlatAst&&) = default;
+    FlatAst& operator=(FlatAst&&) = default;
+
+    // As visões apontam para os próprios vetores; uma cópia apontaria para os do original
+    FlatAst(const FlatAst&) = delete;
+    FlatAst& operator=(const FlatAst&) = delete;
+
+    // Achata um Program; os nomes são copiados e deduplicados
+    static FlatAst build(const Program& program);
+
+    NodeId root() const { return 0; }
+    size_t size() const { return nodes.size(); }
+    const FlatNode& node(NodeId id) const { return nodes[id]; }
+    FlatKind kind(NodeId id) const { return nodes[id].kind; }
+    std::span<const FlatNode> allNodes() const { return nodes; }
+
+    std::span<const NodeId> childrenOf(NodeId id) const;
+    std::span<const std::pair<int, int>> dimensionsOf(NodeId id) const;
+    std::string_view name(uint32_t nameId) const;
+    double number(NodeId id) const { return numbers[nodes[id].a]; }
+
+    // Todo índice cabe na seção a que se refere e todo filho vem depois do pai,
+    // com um só pai e do tipo que ele espera. Um AST vindo de fora (o cache)
+    // precisa disto antes de ser percorrido ou reconstruído
+    bool isWellFormed() const;
+
+    // Bytes ocupados pela representação (capacidade reservada incluída)
+    size_t bytesUsed() const;
+
+private:
+    friend class FlatAstBuilder;
+    friend class AstCache;
+
+    // Arrays do AST: visões sobre 'storage' (AST construído) ou sobre 'mapping'
+    // (AST carregado do cache)
+    std::span<const FlatNode> nodes;
+    std::span<const NodeId> children;
+    std::span<const std::pair<int, int>> dimensions;
+    std::span<const double> numbers;
+
+    // Nomes concatenados em um único buffer, como os lexemas do TokenBuffer
+    std::string_view nameText;
+    std::span<const uint32_t> nameOffsets;
+    std::span<const uint32_t> nameLengths;
+
+    struct Storage {
+        std::vector<FlatNode> nodes;
+        std::vector<NodeId> children;
+        std::vector<std::pair<int, int>> dimensions;
+        std::vector<double> numbers;
+        std::vector<char> nameText; // Não std::string: o buffer curto (SSO) mudaria de lugar ao mover
+        std::vector<uint32_t> nameOffsets;
+        std::vector<uint32_t> nameLengths;
+    };
+    Storage storage;
+    std::shared_ptr<const SourceFile> mapping;
+
+    // Aponta as visões para 'storage'
+    void attach();
+};
+
+// Adaptador para os passes que ainda usam Visitor: reconstrói, uma única vez,
+// a árvore de ponteiros equivalente (num arena próprio) e despacha o Visitor
+// sobre ela. Permite migrar os passes para o FlatAst um de cada vez.
+class FlatAstAdapter {
+public:
+    explicit FlatAstAdapter(const FlatAst& ast);
+
+    // Visita o programa inteiro
+    void accept(Visitor& visitor);
+
+    // Visita apenas a declaração 'id' (ex.: uma única função)
+    void accept(NodeId id, Visitor& visitor);
+
+    // Árvore reconstruída; pertence ao adaptador
+    Program& program() { return *tree; }
+
+    // Entrega a árvore reconstruída (os nomes foram copiados para o arena dela,
+    // então ela não depende do FlatAst); o adaptador não pode mais ser usado
+    std::unique_ptr<Program> releaseProgram();
+
+private:
+    const FlatAst& ast;
+    std::unique_ptr<Program> tree;
+    std::vector<Node*> materialized; // Nó reconstruído para cada NodeId
+
+    void materialize();
+};
+
+#endif // FLAT_AST_HPP
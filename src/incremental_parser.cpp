@@ -0,0 +1,191 @@
+// incremental_parser.cpp
+
+#include "incremental_parser.hpp"
+#include "parser.hpp"
+#include "scanner.hpp"
+#include "source_hash.hpp"
+#include "unit_splitter.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr size_t COMPARE_CHUNK = 4096;
+
+// Tamanho do maior prefixo comum; compara blocos inteiros com memcmp antes de
+// procurar o byte exato
+size_t commonPrefix(std::string_view a, std::string_view b) {
+    size_t limit = std::min(a.size(), b.size());
+    size_t length = 0;
+    while (length + COMPARE_CHUNK <= limit && std::memcmp(a.data() + length, b.data() + length, COMPARE_CHUNK) == 0) {
+        length += COMPARE_CHUNK;
+    }
+    while (length < limit && a[length] == b[length]) {
+        length++;
+    }
+    return length;
+}
+
+// Tamanho do maior sufixo comum que não invade os primeiros 'prefix' bytes
+size_t commonSuffix(std::string_view a, std::string_view b, size_t prefix) {
+    size_t limit = std::min(a.size(), b.size()) - prefix;
+    const char* endA = a.data() + a.size();
+    const char* endB = b.data() + b.size();
+    size_t length = 0;
+    while (length + COMPARE_CHUNK <= limit &&
+           std::memcmp(endA - length - COMPARE_CHUNK, endB - length - COMPARE_CHUNK, COMPARE_CHUNK) == 0) {
+        length += COMPARE_CHUNK;
+    }
+    while (length < limit && *(endA - length - 1) == *(endB - length - 1)) {
+        length++;
+    }
+    return length;
+}
+
+int countLines(std::string_view text) {
+    return static_cast<int>(std::count(text.begin(), text.end(), '\n'));
+}
+
+} // namespace
+
+void IncrementalParser::clear() {
+    previousSource.clear();
+    units.clear();
+    diagnostics.clear();
+    reparsed = 0;
+    reused = 0;
+}
+
+IncrementalParser::Unit IncrementalParser::parseUnit(std::string_view text, size_t offset, int line, uint64_t hash) {
+    // Um arena por unidade, com o primeiro bloco proporcional ao texto: milhares
+    // de POUs pequenas não devem custar um bloco de 64 KiB cada
+    auto arena = std::make_shared<AstArena>(std::max<size_t>(1024, text.size() * 4));
+    Scanner scanner(text, line);
+    Parser parser(scanner, arena);
+    auto tree = parser.parse();
+    return Unit{offset, text.size(), line, hash, std::move(tree), parser.getDiagnostics()};
+}
+
+std::unique_ptr<Program> IncrementalParser::parse(std::string_view source) {
+    reparsed = 0;
+    reused = 0;
+
+    // Região editada: [prefix, source.size() - suffix) no fonte novo e
+    // [prefix, previousSource.size() - suffix) no anterior
+    std::string_view previous = previousSource;
+    size_t prefix = commonPrefix(previous, source);
+    size_t suffix = commonSuffix(previous, source, prefix);
+    size_t editEnd = source.size() - suffix;
+    ptrdiff_t delta = static_cast<ptrdiff_t>(source.size()) - static_cast<ptrdiff_t>(previous.size());
+    int lineDelta = countLines(source.substr(prefix, editEnd - prefix)) -
+                    countLines(previous.substr(prefix, previous.size() - suffix - prefix));
+
+    // Unidades inteiramente antes da edição ficam como estão. A divisão recomeça
+    // uma unidade antes da que contém a edição: a edição pode ter destruído a
+    // palavra-chave que separa as duas.
+    size_t first = 0;
+    if (!units.empty()) {
+        auto after = std::upper_bound(units.begin(), units.end(), prefix,
+                                      [](size_t offset, const Unit& unit) { return offset < unit.offset; });
+        size_t index = static_cast<size_t>(after - units.begin());
+        first = index >= 2 ? index - 2 : 0;
+    }
+    size_t begin = first < units.size() ? units[first].offset : 0;
+    int beginLine = first < units.size() ? units[first].line : 1;
+
+    // Redivide até a primeira fronteira, depois da edição, que já era uma
+    // fronteira antes dela; dali em diante o texto e a divisão são os mesmos
+    std::vector<UnitBoundary> fresh;
+    size_t resync = units.size();
+    UnitSplitter splitter(source, begin, beginLine);
+    for (UnitBoundary boundary{}; splitter.next(boundary);) {
+        if (boundary.offset >= editEnd) {
+            size_t oldOffset = static_cast<size_t>(static_cast<ptrdiff_t>(boundary.offset) - delta);
+            auto old = std::lower_bound(units.begin() + static_cast<ptrdiff_t>(first) + 1, units.end(), oldOffset,
+                                        [](const Unit& unit, size_t offset) { return unit.offset < offset; });
+            if (old != units.end() && old->offset == oldOffset) {
+                resync = static_cast<size_t>(old - units.begin());
+                break;
+            }
+        }
+        fresh.push_back(boundary);
+    }
+    size_t freshEnd = resync < units.size() ? static_cast<size_t>(static_cast<ptrdiff_t>(units[resync].offset) + delta)
+                                            : source.size();
+
+    // Declarações soltas antes da primeira unidade formam um trecho próprio
+    if (first == 0 && (fresh.empty() ? freshEnd > 0 : fresh.front().offset != 0)) {
+        fresh.insert(fresh.begin(), UnitBoundary{0, 1});
+    }
+
+    std::vector<Unit> next;
+    next.reserve(first + fresh.size() + (units.size() - resync));
+    for (size_t i = 0; i < first; i++) {
+        next.push_back(std::move(units[i]));
+    }
+
+    // Trechos redivididos: reaproveita as unidades antigas com o mesmo conteúdo
+    // (ex.: a unidade vizinha à edição) e analisa as demais
+    for (size_t i = 0; i < fresh.size(); i++) {
+        size_t offset = fresh[i].offset;
+        size_t end = i + 1 < fresh.size() ? fresh[i + 1].offset : freshEnd;
+        std::string_view text = source.substr(offset, end - offset);
+        uint64_t hash = hashSource(text);
+
+        Unit* match = nullptr;
+        for (size_t j = first; j < resync; j++) {
+            Unit& old = units[j];
+            if (old.tree && old.hash == hash && old.length == text.size() &&
+                (old.line == fresh[i].line || old.diagnostics.empty()) &&
+                previous.substr(old.offset, old.length) == text) {
+                match = &old;
+                break;
+            }
+        }
+        if (match) {
+            match->offset = offset;
+            match->line = fresh[i].line;
+            next.push_back(std::move(*match));
+            reused++;
+        } else {
+            next.push_back(parseUnit(text, offset, fresh[i].line, hash));
+            reparsed++;
+        }
+    }
+
+    // Unidades depois da edição só mudam de posição (e de linha, inclusive a das
+    // declarações). As que têm erros e mudaram de linha são analisadas de novo:
+    // as mensagens do Scanner citam a linha.
+    reused += first;
+    for (size_t i = resync; i < units.size(); i++) {
+        Unit& unit = units[i];
+        unit.offset = static_cast<size_t>(static_cast<ptrdiff_t>(unit.offset) + delta);
+        unit.line += lineDelta;
+        if (lineDelta != 0 && !unit.diagnostics.empty()) {
+            next.push_back(parseUnit(source.substr(unit.offset, unit.length), unit.offset, unit.line, unit.hash));
+            reparsed++;
+        } else {
+            for (auto& stmt : unit.tree->statements) {
+                stmt->line += lineDelta;
+            }
+            next.push_back(std::move(unit));
+            reused++;
+        }
+    }
+    units = std::move(next);
+    previousSource.assign(source);
+
+    // Junta as subárvores num único Program, na ordem do fonte. Os nós continuam
+    // nos arenas das unidades; o ArenaDeleter não libera nada, então o Program
+    // novo e o cache podem apontar para os mesmos nós.
+    auto program = std::make_unique<Program>(std::make_shared<AstArena>());
+    diagnostics.clear();
+    for (const auto& unit : units) {
+        program->adoptArenas(*unit.tree);
+        for (const auto& stmt : unit.tree->statements) {
+            program->addStatement(NodePtr<Statement>(stmt.get()));
+        }
+        diagnostics.insert(diagnostics.end(), unit.diagnostics.begin(), unit.diagnostics.end());
+    }
+    return program;
+}
@@ -0,0 +1,62 @@
+// incremental_parser.hpp
+
+#ifndef INCREMENTAL_PARSER_HPP
+#define INCREMENTAL_PARSER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ast.hpp"
+#include "diagnostic.hpp"
+
+// Parsing incremental por unidade de programa (POU).
+// Guarda, para cada unidade do fonte anterior, a faixa de texto, o hash do
+// conteúdo, a subárvore e os diagnósticos. A cada nova versão do fonte só as
+// unidades cujo texto mudou são escaneadas e analisadas de novo; as demais
+// têm as subárvores reaproveitadas (os mesmos nós, sem cópia).
+//
+// A região editada é achada pelo maior prefixo e sufixo comuns com a versão
+// anterior; a divisão em unidades é refeita a partir da unidade anterior à
+// edição e para assim que uma fronteira volta a coincidir com uma fronteira
+// antiga depois da região editada.
+class IncrementalParser {
+public:
+    // Analisa uma nova versão do fonte. O Program devolvido mantém vivos os
+    // arenas de todas as unidades, mas compartilha os nós com o cache: ele não
+    // deve ser modificado (ex.: pelo ASTOptimizer), senão as próximas versões
+    // reaproveitariam subárvores alteradas. As anotações da análise semântica
+    // são a exceção: o SemanticAnalyzer incremental as refaz quando mudam.
+    std::unique_ptr<Program> parse(std::string_view source);
+
+    // Erros de sintaxe da última versão, na ordem do fonte
+    const std::vector<Diagnostic>& getDiagnostics() const { return diagnostics; }
+
+    // Unidades analisadas de novo e reaproveitadas na última chamada
+    size_t reparsedUnits() const { return reparsed; }
+    size_t reusedUnits() const { return reused; }
+
+    // Descarta o cache; a próxima chamada analisa o fonte inteiro
+    void clear();
+
+private:
+    struct Unit {
+        size_t offset;
+        size_t length;
+        int line;
+        uint64_t hash;
+        std::unique_ptr<Program> tree;
+        std::vector<Diagnostic> diagnostics;
+    };
+
+    std::string previousSource;
+    std::vector<Unit> units;
+    std::vector<Diagnostic> diagnostics;
+    size_t reparsed = 0;
+    size_t reused = 0;
+
+    Unit parseUnit(std::string_view text, size_t offset, int line, uint64_t hash);
+};
+
+#endif // INCREMENTAL_PARSER_HPP
@@ -0,0 +1,156 @@
+// keywords.hpp
+
+#ifndef KEYWORDS_HPP
+#define KEYWORDS_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include "token.hpp"
+
+// Reconhecimento de palavras-chave por hash perfeito gerado em tempo de compilação.
+// A comparação é case-insensitive e feita diretamente sobre o lexema, sem alocação.
+
+struct Keyword {
+    std::string_view text; // Sempre em maiúsculas
+    TokenType type;
+};
+
+inline constexpr Keyword keywords[] = {
+    {"VAR", TokenType::VAR},
+    {"VAR_INPUT", TokenType::VAR_INPUT},
+    {"VAR_OUTPUT", TokenType::VAR_OUTPUT},
+    {"VAR_GLOBAL", TokenType::VAR_GLOBAL},
+    {"END_VAR", TokenType::END_VAR},
+    {"FUNCTION", TokenType::FUNCTION},
+    {"END_FUNCTION", TokenType::END_FUNCTION},
+    {"FUNCTION_BLOCK", TokenType::FUNCTION_BLOCK},
+    {"END_FUNCTION_BLOCK", TokenType::END_FUNCTION_BLOCK},
+    {"PROGRAM", TokenType::PROGRAM},
+    {"END_PROGRAM", TokenType::END_PROGRAM},
+    {"IF", TokenType::IF},
+    {"THEN", TokenType::THEN},
+    {"ELSE", TokenType::ELSE},
+    {"ELSIF", TokenType::ELSIF},
+    {"END_IF", TokenType::END_IF},
+    {"WHILE", TokenType::WHILE},
+    {"DO", TokenType::DO},
+    {"END_WHILE", TokenType::END_WHILE},
+    {"FOR", TokenType::FOR},
+    {"TO", TokenType::TO},
+    {"END_FOR", TokenType::END_FOR},
+    {"RETURN", TokenType::RETURN},
+    {"ARRAY", TokenType::ARRAY},
+    {"OF", TokenType::OF},
+    {"AND", TokenType::AND},
+    {"OR", TokenType::OR},
+    {"NOT", TokenType::NOT},
+    {"TRUE", TokenType::TRUE},
+    {"FALSE", TokenType::FALSE},
+    // Tipos
+    {"INTEGER", TokenType::INTEGER},
+    {"REAL", TokenType::REAL},
+    {"BOOLEAN", TokenType::BOOLEAN},
+};
+
+namespace keyword_detail {
+
+inline constexpr uint32_t SLOT_BITS = 7; // 128 posições para as palavras-chave
+inline constexpr size_t SLOT_COUNT = size_t(1) << SLOT_BITS;
+inline constexpr size_t KEYWORD_COUNT = sizeof(keywords) / sizeof(keywords[0]);
+static_assert(KEYWORD_COUNT < SLOT_COUNT, "Tabela de palavras-chave cheia demais");
+
+constexpr char toUpperAscii(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// FNV-1a sobre os caracteres convertidos para maiúsculas
+constexpr uint32_t hash(std::string_view text) {
+    uint32_t h = 2166136261u;
+    for (char c : text) {
+        h = (h ^ static_cast<uint8_t>(toUpperAscii(c))) * 16777619u;
+    }
+    return h;
+}
+
+// Mistura o hash com a semente e usa os bits altos como posição na tabela
+constexpr size_t slotOf(uint32_t h, uint32_t seed) {
+    return static_cast<uint32_t>((h ^ seed) * 0x9E3779B1u) >> (32 - SLOT_BITS);
+}
+
+constexpr bool isPerfect(uint32_t seed) {
+    bool used[SLOT_COUNT] = {};
+    for (const auto& keyword : keywords) {
+        size_t slot = slotOf(hash(keyword.text), seed);
+        if (used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+// Procura a primeira semente sem colisões
+constexpr uint32_t findSeed() {
+    uint32_t seed = 0;
+    while (!isPerfect(seed)) seed++;
+    return seed;
+}
+
+inline constexpr uint32_t SEED = findSeed();
+
+constexpr std::array<int8_t, SLOT_COUNT> buildSlots() {
+    std::array<int8_t, SLOT_COUNT> slots{};
+    for (auto& slot : slots) slot = -1;
+    for (size_t i = 0; i < KEYWORD_COUNT; i++) {
+        slots[slotOf(hash(keywords[i].text), SEED)] = static_cast<int8_t>(i);
+    }
+    return slots;
+}
+
+inline constexpr std::array<int8_t, SLOT_COUNT> slots = buildSlots();
+
+constexpr size_t minLength() {
+    size_t length = keywords[0].text.size();
+    for (const auto& keyword : keywords) length = keyword.text.size() < length ? keyword.text.size() : length;
+    return length;
+}
+
+constexpr size_t maxLength() {
+    size_t length = 0;
+    for (const auto& keyword : keywords) length = keyword.text.size() > length ? keyword.text.size() : length;
+    return length;
+}
+
+inline constexpr size_t MIN_LENGTH = minLength();
+inline constexpr size_t MAX_LENGTH = maxLength();
+
+} // namespace keyword_detail
+
+// Retorna o tipo da palavra-chave ou TokenType::IDENTIFIER
+constexpr TokenType lookupKeyword(std::string_view text) {
+    using namespace keyword_detail;
+    if (text.size() < MIN_LENGTH || text.size() > MAX_LENGTH) return TokenType::IDENTIFIER;
+
+    int8_t index = slots[slotOf(hash(text), SEED)];
+    if (index < 0) return TokenType::IDENTIFIER;
+
+    const Keyword& keyword = keywords[index];
+    if (keyword.text.size() != text.size()) return TokenType::IDENTIFIER;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (toUpperAscii(text[i]) != keyword.text[i]) return TokenType::IDENTIFIER;
+    }
+    return keyword.type;
+}
+
+constexpr bool allKeywordsResolve() {
+    for (const auto& keyword : keywords) {
+        if (lookupKeyword(keyword.text) != keyword.type) return false;
+    }
+    return true;
+}
+
+static_assert(allKeywordsResolve(), "Palavra-chave duplicada ou não reconhecida");
+static_assert(lookupKeyword("end_function_block") == TokenType::END_FUNCTION_BLOCK);
+static_assert(lookupKeyword("Var_Global") == TokenType::VAR_GLOBAL);
+static_assert(lookupKeyword("counter") == TokenType::IDENTIFIER);
+
+#endif // KEYWORDS_HPP
@@ -0,0 +1,69 @@
+// name_table.cpp
+
+#include "name_table.hpp"
+#include "source_hash.hpp"
+
+namespace {
+
+constexpr size_t INITIAL_SLOTS = 64;
+
+uint32_t hashName(std::string_view name) {
+    return static_cast<uint32_t>(hashSource(name));
+}
+
+} // namespace
+
+NameTable::NameTable() : slots(INITIAL_SLOTS) {}
+
+size_t NameTable::probe(std::string_view name, uint32_t hash) const {
+    size_t mask = slots.size() - 1;
+    for (size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+        const Slot& slot = slots[pos];
+        if (slot.id == NO_NAME || (slot.hash == hash && this->name(slot.id) == name)) {
+            return pos;
+        }
+    }
+}
+
+NameId NameTable::find(std::string_view name) const {
+    return slots[probe(name, hashName(name))].id;
+}
+
+NameId NameTable::intern(std::string_view name) {
+    uint32_t hash = hashName(name);
+    size_t pos = probe(name, hash);
+    if (slots[pos].id != NO_NAME) {
+        return slots[pos].id;
+    }
+
+    NameId id = static_cast<NameId>(offsets.size());
+    offsets.push_back(static_cast<uint32_t>(text.size()));
+    lengths.push_back(static_cast<uint32_t>(name.size()));
+    text.insert(text.end(), name.begin(), name.end());
+    slots[pos] = Slot{hash, id};
+
+    // Mantém a ocupação em no máximo 1/2 para as sondagens continuarem curtas
+    if (offsets.size() * 2 > slots.size()) {
+        grow();
+    }
+    return id;
+}
+
+void NameTable::grow() {
+    std::vector<Slot> old(slots.size() * 2);
+    old.swap(slots);
+    size_t mask = slots.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.id == NO_NAME) continue;
+        size_t pos = slot.hash & mask;
+        while (slots[pos].id != NO_NAME) {
+            pos = (pos + 1) & mask;
+        }
+        slots[pos] = slot;
+    }
+}
+
+size_t NameTable::bytesUsed() const {
+    return slots.capacity() * sizeof(Slot) + text.capacity() +
+           (offsets.capacity() + lengths.capacity()) * sizeof(uint32_t);
+}
@@ -0,0 +1,56 @@
+// name_table.hpp
+
+#ifndef NAME_TABLE_HPP
+#define NAME_TABLE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+// Identificador de um nome internado. Os ids são densos (0, 1, 2...), então
+// podem indexar vetores diretamente.
+using NameId = uint32_t;
+inline constexpr NameId NO_NAME = std::numeric_limits<NameId>::max();
+
+// Tabela de internação de nomes: cada nome distinto é guardado uma única vez e
+// recebe um NameId. A busca é um hash com endereçamento aberto (sondagem linear,
+// ocupação de no máximo metade), sem alocação por nome; os textos ficam
+// concatenados em um único buffer, como no FlatAst.
+class NameTable {
+public:
+    NameTable();
+
+    // Id do nome, registrando-o se ainda não existir
+    NameId intern(std::string_view name);
+
+    // Id do nome, ou NO_NAME se ele nunca foi internado
+    NameId find(std::string_view name) const;
+
+    // Texto do nome; a visão vale até o próximo intern()
+    std::string_view name(NameId id) const {
+        return std::string_view(text.data() + offsets[id], lengths[id]);
+    }
+
+    size_t size() const { return offsets.size(); }
+
+    // Bytes ocupados pela tabela (capacidade reservada incluída)
+    size_t bytesUsed() const;
+
+private:
+    struct Slot {
+        uint32_t hash;
+        NameId id = NO_NAME; // NO_NAME: posição livre
+    };
+
+    std::vector<Slot> slots; // Tamanho sempre potência de 2
+    std::vector<char> text;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+
+    // Posição do nome em 'slots', ou a posição livre onde ele entraria
+    size_t probe(std::string_view name, uint32_t hash) const;
+    void grow();
+};
+
+#endif // NAME_TABLE_HPP
@@ -3,9 +3,10 @@
 #ifndef OPERATOR_TYPE_HPP
 #define OPERATOR_TYPE_HPP
 
+#include <cstdint>
 #include <string>
 
-enum class OperatorType {
+enum class OperatorType : uint8_t {
     ADD,            // '+'
     SUBTRACT,       // '-'
     MULTIPLY,       // '*'
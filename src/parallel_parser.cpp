@@ -0,0 +1,97 @@
+// parallel_parser.cpp
+
+#include "parallel_parser.hpp"
+#include "parser.hpp"
+#include "scanner.hpp"
+#include "unit_splitter.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+
+ParallelParser::ParallelParser(std::string_view source, unsigned threadCount)
+    : source(source), threadCount(threadCount) {
+    if (this->threadCount == 0) {
+        this->threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+std::vector<UnitBoundary> ParallelParser::splitUnits() const {
+    std::vector<UnitBoundary> boundaries;
+    UnitSplitter splitter(source);
+    for (UnitBoundary boundary{}; splitter.next(boundary);) {
+        boundaries.push_back(boundary);
+    }
+
+    // Declarações soltas antes da primeira unidade formam um trecho próprio
+    if (boundaries.empty() || boundaries.front().offset != 0) {
+        boundaries.insert(boundaries.begin(), UnitBoundary{0, 1});
+    }
+    return boundaries;
+}
+
+std::unique_ptr<Program> ParallelParser::parse() {
+    diagnostics.clear();
+    std::vector<UnitBoundary> units;
+    if (threadCount > 1) {
+        units = splitUnits();
+    }
+
+    // Agrupa as unidades em faixas contíguas; várias faixas por thread equilibram a carga
+    size_t rangeCount = std::min(units.size(), static_cast<size_t>(threadCount) * 8);
+    if (rangeCount <= 1) {
+        Scanner scanner(source);
+        Parser parser(scanner);
+        auto program = parser.parse();
+        diagnostics = parser.getDiagnostics();
+        return program;
+    }
+
+    std::vector<std::unique_ptr<Program>> results(rangeCount);
+    std::vector<std::vector<Diagnostic>> rangeDiagnostics(rangeCount);
+    std::vector<std::exception_ptr> errors(rangeCount);
+    std::atomic<size_t> nextRange{0};
+
+    auto worker = [&]() {
+        for (size_t range = nextRange++; range < rangeCount; range = nextRange++) {
+            size_t first = range * units.size() / rangeCount;
+            size_t last = (range + 1) * units.size() / rangeCount;
+            size_t begin = units[first].offset;
+            size_t end = last < units.size() ? units[last].offset : source.size();
+            try {
+                Scanner scanner(source.substr(begin, end - begin), units[first].line);
+                Parser parser(scanner);
+                results[range] = parser.parse();
+                rangeDiagnostics[range] = parser.getDiagnostics();
+            } catch (...) {
+                errors[range] = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    size_t workerCount = std::min(static_cast<size_t>(threadCount), rangeCount);
+    for (size_t i = 1; i < workerCount; i++) {
+        threads.emplace_back(worker);
+    }
+    worker(); // A thread atual também processa faixas
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Junta os resultados na ordem do fonte; diagnósticos também ficam na ordem do fonte.
+    // Exceções (não erros de sintaxe) são relançadas, a primeira no fonte
+    // Os nós continuam nos arenas de cada faixa, que passam a pertencer ao Program final
+    auto program = std::make_unique<Program>(std::make_shared<AstArena>());
+    for (size_t range = 0; range < rangeCount; range++) {
+        if (errors[range]) {
+            std::rethrow_exception(errors[range]);
+        }
+        program->adoptArenas(*results[range]);
+        diagnostics.insert(diagnostics.end(), rangeDiagnostics[range].begin(), rangeDiagnostics[range].end());
+        for (auto& stmt : results[range]->statements) {
+            program->addStatement(std::move(stmt));
+        }
+    }
+    return program;
+}
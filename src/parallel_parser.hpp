@@ -0,0 +1,36 @@
+// parallel_parser.hpp
+
+#ifndef PARALLEL_PARSER_HPP
+#define PARALLEL_PARSER_HPP
+
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "ast.hpp"
+#include "diagnostic.hpp"
+#include "unit_splitter.hpp"
+
+// Parsing paralelo por unidade de programa (POU).
+// Um pré-passo divide o fonte nas fronteiras de FUNCTION, FUNCTION_BLOCK,
+// PROGRAM e VAR_GLOBAL de nível superior; os trechos são escaneados e
+// analisados em threads separadas e o resultado é juntado num único Program,
+// na ordem do fonte e com os números de linha originais.
+class ParallelParser {
+public:
+    // threadCount == 0 usa std::thread::hardware_concurrency()
+    ParallelParser(std::string_view source, unsigned threadCount = 0);
+
+    std::unique_ptr<Program> parse();
+
+    // Erros de sintaxe de todos os trechos, na ordem do fonte
+    const std::vector<Diagnostic>& getDiagnostics() const { return diagnostics; }
+
+private:
+    std::string_view source;
+    unsigned threadCount;
+    std::vector<Diagnostic> diagnostics;
+
+    std::vector<UnitBoundary> splitUnits() const;
+};
+
+#endif // PARALLEL_PARSER_HPP
@@ -1,11 +1,69 @@
 // parser.cpp
 
 #include "parser.hpp"
+#include <array>
 #include <stdexcept>
 #include <iostream>
+#include <limits>
+
+namespace {
+
+// Operador binário infixo: força de ligação (0 = não é operador) e associatividade
+struct BinaryOperator {
+    int bindingPower = 0;
+    OperatorType op = OperatorType::ADD;
+    bool rightAssociative = false;
+};
+
+constexpr size_t TOKEN_TYPE_COUNT = static_cast<size_t>(TokenType::TIME_LITERAL) + 1;
+
+// Tabela de precedência indexada por TokenType; novos operadores são uma linha aqui
+constexpr std::array<BinaryOperator, TOKEN_TYPE_COUNT> makeBinaryOperators() {
+    std::array<BinaryOperator, TOKEN_TYPE_COUNT> table{};
+    auto set = [&](TokenType type, int bindingPower, OperatorType op, bool rightAssociative = false) {
+        table[static_cast<size_t>(type)] = BinaryOperator{bindingPower, op, rightAssociative};
+    };
+    set(TokenType::OR,            1, OperatorType::OR);
+    set(TokenType::AND,           2, OperatorType::AND);
+    set(TokenType::EQUAL_EQUAL,   3, OperatorType::EQUAL_EQUAL);
+    set(TokenType::NOT_EQUAL,     3, OperatorType::NOT_EQUAL);
+    set(TokenType::LESS,          4, OperatorType::LESS);
+    set(TokenType::LESS_EQUAL,    4, OperatorType::LESS_EQUAL);
+    set(TokenType::GREATER,       4, OperatorType::GREATER);
+    set(TokenType::GREATER_EQUAL, 4, OperatorType::GREATER_EQUAL);
+    set(TokenType::PLUS,          5, OperatorType::ADD);
+    set(TokenType::MINUS,         5, OperatorType::SUBTRACT);
+    set(TokenType::STAR,          6, OperatorType::MULTIPLY);
+    set(TokenType::SLASH,         6, OperatorType::DIVIDE);
+    return table;
+}
+
+constexpr auto binaryOperators = makeBinaryOperators();
+
+static_assert(binaryOperators[static_cast<size_t>(TokenType::EOF_TOKEN)].bindingPower == 0,
+              "EOF não pode continuar uma expressão");
+
+} // namespace
 
 Parser::Parser(const std::vector<Token>& tokens)
-    : tokens(tokens) {}
+    : tokens(&tokens) {
+    load();
+}
+
+Parser::Parser(Scanner& scanner)
+    : scanner(&scanner) {
+    load();
+}
+
+Parser::Parser(Scanner& scanner, std::shared_ptr<AstArena> arena)
+    : scanner(&scanner), arena(std::move(arena)) {
+    load();
+}
+
+Parser::Parser(const TokenBuffer& buffer)
+    : buffer(&buffer) {
+    load();
+}
 
 OperatorType Parser::getOperatorType(TokenType type) {
     switch (type) {
@@ -41,26 +99,28 @@ OperatorType Parser::getOperatorType(TokenType type) {
 }
 
 std::unique_ptr<Program> Parser::parse() {
-    auto program = std::make_unique<Program>();
+    auto program = std::make_unique<Program>(arena);
     while (!isAtEnd()) {
-        auto declaration = parseDeclaration();
+        int line = peek().line;
+        auto declaration = recover(&Parser::parseDeclaration);
         if (declaration) {
+            declaration->line = line;
             program->addStatement(std::move(declaration));
         }
     }
     return program;
 }
 
-std::unique_ptr<Statement> Parser::parseGlobalVariableDeclaration() {
+NodePtr<Statement> Parser::parseGlobalVariableDeclaration() {
     // Implementação similar ao parseVariableDeclaration
     auto declarations = parseVariableDeclaration();
     // Em um contexto real, você pode querer marcar essas variáveis como globais
     // Para simplificar, retornaremos um bloco contendo as declarações
-    return std::make_unique<BlockStatement>(std::move(declarations));
+    return makeNode<BlockStatement>(*arena, std::move(declarations));
 }
 
-std::unique_ptr<Statement> Parser::parseDeclaration() {
-    if (match({TokenType::FUNCTION, TokenType::PROGRAM, TokenType::FUNCTION_BLOCK})) {
+NodePtr<Statement> Parser::parseDeclaration() {
+    if (match(token_class::POU_START)) {
         return parseFunction();
     } else if (match(TokenType::VAR_GLOBAL)) {
         return parseGlobalVariableDeclaration();
@@ -69,25 +129,27 @@ std::unique_ptr<Statement> Parser::parseDeclaration() {
     }
 }
 
-std::unique_ptr<Function> Parser::parseFunction() {
+NodePtr<Function> Parser::parseFunction() {
     TokenType funcType = previous().type; // Verifica se é FUNCTION, PROGRAM ou FUNCTION_BLOCK
-    std::string name = consume(TokenType::IDENTIFIER, "Esperado nome da função ou programa").lexeme;
-
-    auto function = std::make_unique<Function>(name);
+    std::string_view name = arena->copyString(consume(TokenType::IDENTIFIER, "Esperado nome da função ou programa").lexeme);
 
     // Se for FUNCTION, pode ter um tipo de retorno
+    std::string_view returnType;
     if (funcType == TokenType::FUNCTION && match(TokenType::COLON)) {
-        Token returnTypeToken = consume({TokenType::REAL, TokenType::INTEGER, TokenType::BOOLEAN, TokenType::IDENTIFIER}, "Esperado tipo de retorno após ':'");
-        function->returnType = returnTypeToken.lexeme;
+        Token returnTypeToken = consume(token_class::TYPE_NAME, "Esperado tipo de retorno após ':'");
+        returnType = arena->copyString(returnTypeToken.lexeme);
     } else if (funcType == TokenType::PROGRAM || funcType == TokenType::FUNCTION_BLOCK) {
-        function->returnType = "VOID";
+        returnType = "VOID";
     }
 
-    // Processa declarações de variáveis de entrada
-    while (match({TokenType::VAR_INPUT, TokenType::VAR_OUTPUT})) {
-        auto varDeclarations = parseVariableDeclaration();
+    NodeList<Statement> body(arena.get());
+
+    // Processa declarações de variáveis de entrada e saída (a assinatura da POU)
+    while (match(token_class::PARAMETER_SECTION)) {
+        VarSection parameterSection = previous().type == TokenType::VAR_INPUT ? VarSection::INPUT : VarSection::OUTPUT;
+        auto varDeclarations = parseVariableDeclaration(parameterSection);
         for (auto& varDecl : varDeclarations) {
-            function->body.push_back(std::move(varDecl));
+            body.push_back(std::move(varDecl));
         }
     }
 
@@ -95,31 +157,34 @@ std::unique_ptr<Function> Parser::parseFunction() {
     while (match(TokenType::VAR)) {
         auto varDeclarations = parseVariableDeclaration();
         for (auto& varDecl : varDeclarations) {
-            function->body.push_back(std::move(varDecl));
+            body.push_back(std::move(varDecl));
         }
     }
 
     // Processa outras declarações e statements
-    while (!isAtEnd() && !check(TokenType::END_FUNCTION) && !check(TokenType::END_PROGRAM) && !check(TokenType::END_FUNCTION_BLOCK)) {
-        auto stmt = parseStatement();
+    while (!isAtEnd() && !check(token_class::POU_END) && !check(token_class::POU_START)) {
+        auto stmt = recover(&Parser::parseStatement);
         if (stmt) {
-            function->body.push_back(std::move(stmt));
+            body.push_back(std::move(stmt));
         }
     }
 
     // Consome o token de fim de função ou programa
+    PouKind pouKind = PouKind::FUNCTION;
     if (funcType == TokenType::FUNCTION) {
         consume(TokenType::END_FUNCTION, "Esperado END_FUNCTION");
     } else if (funcType == TokenType::FUNCTION_BLOCK) {
         consume(TokenType::END_FUNCTION_BLOCK, "Esperado END_FUNCTION_BLOCK");
+        pouKind = PouKind::FUNCTION_BLOCK;
     } else {
         consume(TokenType::END_PROGRAM, "Esperado END_PROGRAM");
+        pouKind = PouKind::PROGRAM;
     }
 
-    return function;
+    return makeNode<Function>(*arena, name, returnType, std::move(body), pouKind);
 }
 
-std::unique_ptr<Statement> Parser::parseStatement() {
+NodePtr<Statement> Parser::parseStatement() {
     if (match(TokenType::RETURN)) {
         return parseReturnStatement();
     } else if (match(TokenType::IF)) {
@@ -134,136 +199,150 @@ std::unique_ptr<Statement> Parser::parseStatement() {
     } else if (check(TokenType::IDENTIFIER)) {
         return parseAssignmentOrFunctionCall();
     } else {
-        throw std::runtime_error("Token inesperado: " + peek().lexeme);
+        error(peek(), "Token inesperado '" + std::string(peek().lexeme) + "'");
     }
 }
 
-std::vector<std::unique_ptr<Statement>> Parser::parseVariableDeclaration() {
-    std::vector<std::unique_ptr<Statement>> declarations;
-
-    while (!isAtEnd() && !check(TokenType::END_VAR)) {
-        std::string name = consume(TokenType::IDENTIFIER, "Esperado nome da variável").lexeme;
-        consume(TokenType::COLON, "Esperado ':' após o nome da variável");
-
-        // Verifica se é um array
-        if (match(TokenType::ARRAY)) {
-            consume(TokenType::LEFT_BRACKET, "Esperado '[' após 'ARRAY'");
+NodeList<Statement> Parser::parseVariableDeclaration(VarSection declaredSection) {
+    NodeList<Statement> declarations(arena.get());
+    section = declaredSection;
 
-            // Suporte a múltiplas dimensões
-            std::vector<std::pair<int, int>> dimensions;
-            do {
-                int lowerBound = std::stoi(consume(TokenType::NUMBER, "Esperado número para o limite inferior do array").lexeme);
-                consume(TokenType::DOT_DOT, "Esperado '..' entre limites do array");
-                int upperBound = std::stoi(consume(TokenType::NUMBER, "Esperado número para o limite superior do array").lexeme);
-                dimensions.push_back({lowerBound, upperBound});
-            } while (match(TokenType::COMMA));
+    while (!isAtEnd() && !check(TokenType::END_VAR) && !check(token_class::POU_END) && !check(token_class::POU_START)) {
+        auto declaration = recover(&Parser::parseVariable);
+        if (declaration) {
+            declarations.push_back(std::move(declaration));
+        }
+    }
 
-            consume(TokenType::RIGHT_BRACKET, "Esperado ']' após os limites do array");
-            consume(TokenType::OF, "Esperado 'OF' após os limites do array");
-            std::string baseType = consume({TokenType::REAL, TokenType::INTEGER, TokenType::BOOLEAN, TokenType::IDENTIFIER}, "Esperado tipo base do array").lexeme;
+    section = VarSection::LOCAL;
+    consume(TokenType::END_VAR, "Esperado END_VAR");
 
-            // Verifica se há inicialização
-            std::unique_ptr<Expression> initializer = nullptr;
-            if (match(TokenType::ASSIGNMENT)) {
-                initializer = parseExpression();
-            }
+    return declarations;
+}
 
-            // Cria a declaração de array
-            declarations.push_back(std::make_unique<ArrayDeclaration>(name, baseType, dimensions, std::move(initializer)));
-        } else {
-            // Variável normal
-            std::string type = consume({TokenType::REAL, TokenType::INTEGER, TokenType::BOOLEAN, TokenType::IDENTIFIER}, "Esperado tipo após ':'").lexeme;
+NodePtr<Statement> Parser::parseVariable() {
+    NodePtr<Statement> declaration;
+    std::string_view name = arena->copyString(consume(TokenType::IDENTIFIER, "Esperado nome da variável").lexeme);
+    consume(TokenType::COLON, "Esperado ':' após o nome da variável");
+
+    // Verifica se é um array
+    if (match(TokenType::ARRAY)) {
+        consume(TokenType::LEFT_BRACKET, "Esperado '[' após 'ARRAY'");
+
+        // Suporte a múltiplas dimensões
+        std::pmr::vector<std::pair<int, int>> dimensions(arena.get());
+        do {
+            int lowerBound = parseInteger(consume(TokenType::NUMBER, "Esperado número para o limite inferior do array"));
+            consume(TokenType::DOT_DOT, "Esperado '..' entre limites do array");
+            int upperBound = parseInteger(consume(TokenType::NUMBER, "Esperado número para o limite superior do array"));
+            dimensions.push_back({lowerBound, upperBound});
+        } while (match(TokenType::COMMA));
+
+        consume(TokenType::RIGHT_BRACKET, "Esperado ']' após os limites do array");
+        consume(TokenType::OF, "Esperado 'OF' após os limites do array");
+        std::string_view baseType = arena->copyString(consume(token_class::TYPE_NAME, "Esperado tipo base do array").lexeme);
+
+        // Verifica se há inicialização
+        NodePtr<Expression> initializer = nullptr;
+        if (match(TokenType::ASSIGNMENT)) {
+            initializer = parseExpression();
+        }
 
-            // Verifica se há inicialização
-            std::unique_ptr<Expression> initializer = nullptr;
-            if (match(TokenType::ASSIGNMENT)) {
-                initializer = parseExpression();
-            }
+        // Cria a declaração de array
+        auto arrayDecl = makeNode<ArrayDeclaration>(*arena, name, baseType, std::move(dimensions), std::move(initializer));
+        arrayDecl->section = section;
+        declaration = std::move(arrayDecl);
+    } else {
+        // Variável normal
+        std::string_view type = arena->copyString(consume(token_class::TYPE_NAME, "Esperado tipo após ':'").lexeme);
 
-            declarations.push_back(std::make_unique<VariableDeclaration>(name, type, std::move(initializer)));
+        // Verifica se há inicialização
+        NodePtr<Expression> initializer = nullptr;
+        if (match(TokenType::ASSIGNMENT)) {
+            initializer = parseExpression();
         }
 
-        consume(TokenType::SEMICOLON, "Esperado ';' após a declaração da variável");
+        auto varDecl = makeNode<VariableDeclaration>(*arena, name, type, std::move(initializer));
+        varDecl->section = section;
+        declaration = std::move(varDecl);
     }
 
-    consume(TokenType::END_VAR, "Esperado END_VAR");
-
-    return declarations;
+    consume(TokenType::SEMICOLON, "Esperado ';' após a declaração da variável");
+    return declaration;
 }
 
-std::unique_ptr<Statement> Parser::parseAssignmentOrFunctionCall() {
-    std::string name = consume(TokenType::IDENTIFIER, "Esperado nome da variável ou função").lexeme;
+NodePtr<Statement> Parser::parseAssignmentOrFunctionCall() {
+    std::string_view name = arena->copyString(consume(TokenType::IDENTIFIER, "Esperado nome da variável ou função").lexeme);
 
     // Verifica se é chamada de função
     if (match(TokenType::LEFT_PAREN)) {
-        // Chamada de função
-        std::vector<std::unique_ptr<Expression>> arguments;
-        if (!check(TokenType::RIGHT_PAREN)) {
-            do {
-                arguments.push_back(parseExpression());
-            } while (match(TokenType::COMMA));
-        }
-        consume(TokenType::RIGHT_PAREN, "Esperado ')' após os argumentos da função");
+        // Chamada de função ou de instância de bloco funcional
+        auto call = parseCall(name);
         consume(TokenType::SEMICOLON, "Esperado ';' após a chamada da função");
-        return std::make_unique<ExpressionStatement>(std::make_unique<FunctionCall>(name, std::move(arguments)));
+        return makeNode<ExpressionStatement>(*arena, std::move(call));
     } else {
         // Pode ser atribuição ou acesso a array
-        std::unique_ptr<Expression> lhs = std::make_unique<Identifier>(name);
+        NodePtr<Expression> lhs = makeNode<Identifier>(*arena, name);
 
         // Verifica se é acesso a elemento de array
         while (match(TokenType::LEFT_BRACKET)) {
-            std::vector<std::unique_ptr<Expression>> indices;
+            NodeList<Expression> indices(arena.get());
             do {
                 indices.push_back(parseExpression());
             } while (match(TokenType::COMMA));
             consume(TokenType::RIGHT_BRACKET, "Esperado ']' após os índices do array");
-            lhs = std::make_unique<ArrayAccess>(std::move(lhs), std::move(indices));
+            lhs = makeNode<ArrayAccess>(*arena, std::move(lhs), std::move(indices));
         }
 
         consume(TokenType::ASSIGNMENT, "Esperado ':=' na atribuição");
         auto value = parseExpression();
         consume(TokenType::SEMICOLON, "Esperado ';' após a atribuição");
-        return std::make_unique<Assignment>(std::move(lhs), std::move(value));
+        return makeNode<Assignment>(*arena, std::move(lhs), std::move(value));
     }
 }
 
-std::unique_ptr<ReturnStatement> Parser::parseReturnStatement() {
+NodePtr<ReturnStatement> Parser::parseReturnStatement() {
     auto value = parseExpression();
     consume(TokenType::SEMICOLON, "Esperado ';' após o retorno");
-    return std::make_unique<ReturnStatement>(std::move(value));
+    return makeNode<ReturnStatement>(*arena, std::move(value));
 }
 
-std::unique_ptr<Statement> Parser::parseIfStatement() {
+NodePtr<Statement> Parser::parseIfStatement() {
+    openBlocks++;
     consume(TokenType::LEFT_PAREN, "Esperado '(' após 'IF'");
     auto condition = parseExpression();
     consume(TokenType::RIGHT_PAREN, "Esperado ')' após a condição");
     consume(TokenType::THEN, "Esperado 'THEN' após a condição");
     auto thenBranch = parseBlock();
-    std::unique_ptr<Statement> elseBranch = nullptr;
+    NodePtr<Statement> elseBranch = nullptr;
     if (match(TokenType::ELSE)) {
         elseBranch = parseBlock();
     } else if (match(TokenType::ELSIF)) {
         elseBranch = parseIfStatement();
     }
     consume(TokenType::END_IF, "Esperado 'END_IF'");
-    return std::make_unique<IfStatement>(std::move(condition), std::move(thenBranch), std::move(elseBranch));
+    openBlocks--;
+    return makeNode<IfStatement>(*arena, std::move(condition), std::move(thenBranch), std::move(elseBranch));
 }
 
-std::unique_ptr<Statement> Parser::parseWhileStatement() {
+NodePtr<Statement> Parser::parseWhileStatement() {
+    openBlocks++;
     consume(TokenType::LEFT_PAREN, "Esperado '(' após 'WHILE'");
     auto condition = parseExpression();
     consume(TokenType::RIGHT_PAREN, "Esperado ')' após a condição");
     consume(TokenType::DO, "Esperado 'DO' após a condição");
     auto body = parseBlock();
     consume(TokenType::END_WHILE, "Esperado 'END_WHILE'");
-    return std::make_unique<WhileStatement>(std::move(condition), std::move(body));
+    openBlocks--;
+    return makeNode<WhileStatement>(*arena, std::move(condition), std::move(body));
 }
 
-std::unique_ptr<Statement> Parser::parseForStatement() {
-    std::string varName = consume(TokenType::IDENTIFIER, "Esperado nome da variável de loop").lexeme;
+NodePtr<Statement> Parser::parseForStatement() {
+    openBlocks++;
+    std::string_view varName = arena->copyString(consume(TokenType::IDENTIFIER, "Esperado nome da variável de loop").lexeme);
     consume(TokenType::ASSIGNMENT, "Esperado ':=' na inicialização do loop");
     auto initValue = parseExpression();
-    auto initializer = std::make_unique<Assignment>(std::make_unique<Identifier>(varName), std::move(initValue));
+    auto initializer = makeNode<Assignment>(*arena, makeNode<Identifier>(*arena, varName), std::move(initValue));
 
     consume(TokenType::TO, "Esperado 'TO' após a inicialização do loop");
     auto endCondition = parseExpression();
@@ -273,129 +352,76 @@ std::unique_ptr<Statement> Parser::parseForStatement() {
     auto body = parseBlock();
 
     consume(TokenType::END_FOR, "Esperado 'END_FOR'");
+    openBlocks--;
 
-    return std::make_unique<ForStatement>(std::move(initializer), std::move(endCondition), std::move(body));
+    return makeNode<ForStatement>(*arena, std::move(initializer), std::move(endCondition), std::move(body));
 }
 
-std::unique_ptr<BlockStatement> Parser::parseBlock() {
-    std::vector<std::unique_ptr<Statement>> statements;
+NodePtr<BlockStatement> Parser::parseBlock() {
+    NodeList<Statement> statements(arena.get());
 
-    while (!isAtEnd() && !check(TokenType::END_IF) && !check(TokenType::ELSE) && !check(TokenType::ELSIF) &&
-           !check(TokenType::END_WHILE) && !check(TokenType::END_FOR)) {
-        auto stmt = parseStatement();
+    while (!isAtEnd() && !check(token_class::BLOCK_END) && !check(token_class::POU_END) && !check(token_class::POU_START)) {
+        auto stmt = recover(&Parser::parseStatement);
         if (stmt) {
             statements.push_back(std::move(stmt));
         }
     }
 
-    return std::make_unique<BlockStatement>(std::move(statements));
-}
-
-std::unique_ptr<Expression> Parser::parseExpression() {
-    return parseLogicalOr();
-}
-
-std::unique_ptr<Expression> Parser::parseLogicalOr() {
-    auto expr = parseLogicalAnd();
-    while (match(TokenType::OR)) {
-        OperatorType op = getOperatorType(previous().type);
-        auto right = parseLogicalAnd();
-        expr = std::make_unique<BinaryOperation>(op, std::move(expr), std::move(right));
-    }
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseLogicalAnd() {
-    auto expr = parseEquality();
-    while (match(TokenType::AND)) {
-        OperatorType op = getOperatorType(previous().type);
-        auto right = parseEquality();
-        expr = std::make_unique<BinaryOperation>(op, std::move(expr), std::move(right));
-    }
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseEquality() {
-    auto expr = parseComparison();
-    while (match({TokenType::EQUAL_EQUAL, TokenType::NOT_EQUAL})) {
-        OperatorType op = getOperatorType(previous().type);
-        auto right = parseComparison();
-        expr = std::make_unique<BinaryOperation>(op, std::move(expr), std::move(right));
-    }
-    return expr;
+    return makeNode<BlockStatement>(*arena, std::move(statements));
 }
 
-std::unique_ptr<Expression> Parser::parseComparison() {
-    auto expr = parseTerm();
-    while (match({TokenType::LESS, TokenType::LESS_EQUAL, TokenType::GREATER, TokenType::GREATER_EQUAL})) {
-        OperatorType op = getOperatorType(previous().type);
-        auto right = parseTerm();
-        expr = std::make_unique<BinaryOperation>(op, std::move(expr), std::move(right));
-    }
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseTerm() {
-    auto expr = parseFactor();
-    while (match({TokenType::PLUS, TokenType::MINUS})) {
-        OperatorType op = getOperatorType(previous().type);
-        auto right = parseFactor();
-        expr = std::make_unique<BinaryOperation>(op, std::move(expr), std::move(right));
-    }
-    return expr;
-}
-
-std::unique_ptr<Expression> Parser::parseFactor() {
-    auto expr = parseUnary();
-    while (match({TokenType::STAR, TokenType::SLASH})) {
-        OperatorType op = getOperatorType(previous().type);
-        auto right = parseUnary();
-        expr = std::make_unique<BinaryOperation>(op, std::move(expr), std::move(right));
+NodePtr<Expression> Parser::parseExpression(int minBindingPower) {
+    auto left = parseUnary();
+    for (;;) {
+        // Um único acesso à tabela decide se o próximo token continua a expressão
+        const BinaryOperator& binary = binaryOperators[static_cast<size_t>(peek().type)];
+        if (binary.bindingPower <= minBindingPower) {
+            return left;
+        }
+        advance();
+        // Associativo à esquerda: o lado direito não pode conter operador do mesmo nível
+        int rightBindingPower = binary.rightAssociative ? binary.bindingPower - 1 : binary.bindingPower;
+        auto right = parseExpression(rightBindingPower);
+        left = makeNode<BinaryOperation>(*arena, binary.op, std::move(left), std::move(right));
     }
-    return expr;
 }
 
-std::unique_ptr<Expression> Parser::parseUnary() {
-    if (match({TokenType::NOT, TokenType::MINUS})) {
+NodePtr<Expression> Parser::parseUnary() {
+    if (match(token_class::UNARY_OPERATOR)) {
         OperatorType op = getOperatorType(previous().type);
         auto right = parseUnary();
-        return std::make_unique<UnaryOperation>(op, std::move(right));
+        return makeNode<UnaryOperation>(*arena, op, std::move(right));
     }
     return parsePrimary();
 }
 
-std::unique_ptr<Expression> Parser::parsePrimary() {
+NodePtr<Expression> Parser::parsePrimary() {
     if (match(TokenType::NUMBER)) {
-        double value = std::stod(previous().lexeme);
-        return std::make_unique<Number>(value);
+        // O Scanner já decodificou o valor do literal
+        const Token& token = previous();
+        double value = token.literal == LiteralKind::REAL ? token.realValue : static_cast<double>(token.intValue);
+        return makeNode<Number>(*arena, value, token.literal);
     } else if (match(TokenType::TRUE)) {
-        return std::make_unique<BooleanLiteral>(true);
+        return makeNode<BooleanLiteral>(*arena, true);
     } else if (match(TokenType::FALSE)) {
-        return std::make_unique<BooleanLiteral>(false);
+        return makeNode<BooleanLiteral>(*arena, false);
     } else if (match(TokenType::IDENTIFIER)) {
-        std::string name = previous().lexeme;
-        std::unique_ptr<Expression> expr = std::make_unique<Identifier>(name);
+        std::string_view name = arena->copyString(previous().lexeme);
+        NodePtr<Expression> expr = makeNode<Identifier>(*arena, name);
 
         // Verifica se é acesso a elemento de array
         while (match(TokenType::LEFT_BRACKET)) {
-            std::vector<std::unique_ptr<Expression>> indices;
+            NodeList<Expression> indices(arena.get());
             do {
                 indices.push_back(parseExpression());
             } while (match(TokenType::COMMA));
             consume(TokenType::RIGHT_BRACKET, "Esperado ']' após os índices do array");
-            expr = std::make_unique<ArrayAccess>(std::move(expr), std::move(indices));
+            expr = makeNode<ArrayAccess>(*arena, std::move(expr), std::move(indices));
         }
 
         if (match(TokenType::LEFT_PAREN)) {
             // Chamada de função
-            std::vector<std::unique_ptr<Expression>> arguments;
-            if (!check(TokenType::RIGHT_PAREN)) {
-                do {
-                    arguments.push_back(parseExpression());
-                } while (match(TokenType::COMMA));
-            }
-            consume(TokenType::RIGHT_PAREN, "Esperado ')' após os argumentos da função");
-            return std::make_unique<FunctionCall>(name, std::move(arguments));
+            return parseCall(name);
         } else {
             // Identificador ou acesso a array
             return expr;
@@ -405,32 +431,104 @@ std::unique_ptr<Expression> Parser::parsePrimary() {
         consume(TokenType::RIGHT_PAREN, "Esperado ')'");
         return expr;
     } else {
-        throw std::runtime_error("Esperado expressão em '" + peek().lexeme + "'");
+        error(peek(), "Esperado expressão em '" + std::string(peek().lexeme) + "'");
+    }
+}
+
+NodePtr<FunctionCall> Parser::parseCall(std::string_view name) {
+    NodeList<Expression> arguments(arena.get());
+    std::pmr::vector<ArgumentBinding> bindings(arena.get());
+    if (!check(TokenType::RIGHT_PAREN)) {
+        do {
+            ArgumentBinding binding;
+            // Argumento nomeado: o nome do parâmetro vem seguido de ':=' ou '=>'
+            TokenType next = peekNext().type;
+            if (check(TokenType::IDENTIFIER) && (next == TokenType::ASSIGNMENT || next == TokenType::OUTPUT_ASSIGNMENT)) {
+                binding.parameter = arena->copyString(advance().lexeme);
+                binding.output = advance().type == TokenType::OUTPUT_ASSIGNMENT;
+            }
+            arguments.push_back(parseExpression());
+            bindings.push_back(binding);
+        } while (match(TokenType::COMMA));
     }
+    consume(TokenType::RIGHT_PAREN, "Esperado ')' após os argumentos da função");
+    return makeNode<FunctionCall>(*arena, name, std::move(arguments), std::move(bindings));
 }
 
 // Métodos auxiliares
 
+int Parser::parseInteger(const Token& token) {
+    if (token.literal != LiteralKind::INTEGER ||
+        token.intValue < std::numeric_limits<int>::min() || token.intValue > std::numeric_limits<int>::max()) {
+        error(token, "Número inteiro inválido '" + std::string(token.lexeme) + "'");
+    }
+    return static_cast<int>(token.intValue);
+}
+
 bool Parser::isAtEnd() const {
     return peek().type == TokenType::EOF_TOKEN;
 }
 
 const Token& Parser::peek() const {
-    return tokens[current];
+    return window[current % WINDOW_SIZE];
+}
+
+const Token& Parser::peekNext() {
+    if (isAtEnd()) {
+        return peek();
+    }
+    if (loaded <= current + 1) {
+        load();
+    }
+    return window[(current + 1) % WINDOW_SIZE];
 }
 
 const Token& Parser::previous() const {
-    return tokens[current - 1];
+    return window[(current - 1) % WINDOW_SIZE];
 }
 
 const Token& Parser::advance() {
-    if (!isAtEnd()) current++;
+    if (!isAtEnd()) {
+        current++;
+        if (loaded <= current) load();
+    }
     return previous();
 }
 
+Token Parser::pull() {
+    if (scanner) {
+        // Erros léxicos viram diagnósticos; o Scanner já avançou além do trecho inválido
+        for (;;) {
+            try {
+                return scanner->nextToken();
+            } catch (const std::runtime_error& e) {
+                diagnostics.push_back({scanner->lineNumber(), e.what()});
+                lexicalError = true;
+            }
+        }
+    }
+    // O último token é EOF_TOKEN e é repetido indefinidamente
+    if (buffer) {
+        return buffer->token(nextIndex < buffer->size() ? nextIndex++ : buffer->size() - 1);
+    }
+    if (nextIndex < tokens->size()) {
+        return (*tokens)[nextIndex++];
+    }
+    return tokens->back();
+}
+
+void Parser::load() {
+    window[loaded % WINDOW_SIZE] = pull();
+    loaded++;
+}
+
 bool Parser::check(TokenType type) const {
-    if (isAtEnd()) return false;
-    return peek().type == type;
+    // Comparar com EOF_TOKEN só dá verdadeiro no fim, que check() nunca aceita
+    return type != TokenType::EOF_TOKEN && peek().type == type;
+}
+
+bool Parser::check(TokenClass types) const {
+    return types.contains(peek().type);
 }
 
 bool Parser::match(TokenType type) {
@@ -441,26 +539,49 @@ bool Parser::match(TokenType type) {
     return false;
 }
 
-bool Parser::match(std::initializer_list<TokenType> types) {
-    for (TokenType type : types) {
-        if (check(type)) {
-            advance();
-            return true;
-        }
+bool Parser::match(TokenClass types) {
+    if (check(types)) {
+        advance();
+        return true;
     }
     return false;
 }
 
-Token Parser::consume(TokenType type, const std::string& message) {
+Token Parser::consume(TokenType type, const char* message) {
     if (check(type)) return advance();
-    throw std::runtime_error(message + " em '" + peek().lexeme + "'");
+    error(peek(), std::string(message) + " em '" + std::string(peek().lexeme) + "'");
+}
+
+Token Parser::consume(TokenClass types, const char* message) {
+    if (check(types)) return advance();
+    error(peek(), std::string(message) + " em '" + std::string(peek().lexeme) + "'");
+}
+
+void Parser::error(const Token& token, const std::string& message) {
+    // Depois de um erro léxico o erro de sintaxe do mesmo comando é só consequência
+    if (!lexicalError) {
+        diagnostics.push_back({token.line, message});
+    }
+    throw ParseError{};
 }
 
-Token Parser::consume(std::initializer_list<TokenType> types, const std::string& message) {
-    for (TokenType type : types) {
-        if (check(type)) {
-            return advance();
+void Parser::synchronize(int unclosedBlocks) {
+    // O comando com erro abriu blocos (IF/WHILE/FOR) que não chegou a fechar:
+    // descarta tudo até o END_* correspondente, contando blocos aninhados
+    while (unclosedBlocks > 0 && !isAtEnd() && !check(token_class::POU_END) && !check(token_class::POU_START)) {
+        if (check(token_class::BLOCK_START)) {
+            unclosedBlocks++;
+        } else if (check(token_class::BLOCK_CLOSE)) {
+            unclosedBlocks--;
+        }
+        advance();
+    }
+    if (unclosedBlocks == 0 && previous().type != TokenType::SEMICOLON && !check(token_class::SYNC_POINT)) {
+        // Fim do comando: depois do próximo ';' ou antes de um token que inicia outra construção
+        while (!isAtEnd() && !check(token_class::SYNC_POINT)) {
+            if (advance().type == TokenType::SEMICOLON) {
+                break;
+            }
         }
     }
-    throw std::runtime_error(message + " em '" + peek().lexeme + "'");
 }
@@ -3,9 +3,14 @@
 #ifndef PARSER_HPP
 #define PARSER_HPP
 
+#include <array>
 #include <vector>
 #include <memory>
 #include "token.hpp"
+#include "token_class.hpp"
+#include "diagnostic.hpp"
+#include "scanner.hpp"
+#include "token_buffer.hpp"
 #include "ast.hpp"
 #include "operator_type.hpp"
 
@@ -13,51 +18,117 @@ class Parser {
 public:
     Parser(const std::vector<Token>& tokens);
 
+    // Modo em fluxo: os tokens são pedidos ao Scanner conforme o parsing avança,
+    // sem materializar o vetor completo de tokens.
+    Parser(Scanner& scanner);
+
+    // Modo em fluxo criando os nós num arena fornecido pelo chamador
+    Parser(Scanner& scanner, std::shared_ptr<AstArena> arena);
+
+    // Consome um buffer compacto de tokens (estrutura de arrays)
+    Parser(const TokenBuffer& buffer);
+
+    // Não lança exceção em erros de sintaxe: eles são registrados em
+    // getDiagnostics() e o parsing continua após ressincronizar
     std::unique_ptr<Program> parse();
 
+    const std::vector<Diagnostic>& getDiagnostics() const { return diagnostics; }
+    bool hasErrors() const { return !diagnostics.empty(); }
+
+    // Tokens mantidos em memória pelo Parser no modo em fluxo
+    static constexpr size_t WINDOW_SIZE = 4;
+
 private:
-    const std::vector<Token>& tokens;
-    size_t current = 0;
+    // Origem dos tokens: vetor já escaneado, buffer compacto ou Scanner em fluxo
+    const std::vector<Token>* tokens = nullptr;
+    const TokenBuffer* buffer = nullptr;
+    Scanner* scanner = nullptr;
+    size_t nextIndex = 0;
+
+    // Janela circular com o token anterior, o atual e os de lookahead
+    std::array<Token, WINDOW_SIZE> window;
+    size_t current = 0; // Posição absoluta do token atual
+    size_t loaded = 0;  // Quantidade de tokens já lidos da origem
+
+    // Arena dos nós criados; passa a pertencer ao Program devolvido por parse()
+    std::shared_ptr<AstArena> arena = std::make_shared<AstArena>();
+
+    Token pull();
+    void load();
+
+    // Recuperação de erros (modo pânico)
+    struct ParseError {};            // Desfaz a pilha até o ponto de recuperação mais próximo
+    std::vector<Diagnostic> diagnostics;
+    int openBlocks = 0;              // IF/WHILE/FOR abertos e ainda não fechados
+    bool lexicalError = false;       // O comando atual já tem um erro léxico relatado
+
+    // Seção VAR sendo lida; parseVariable() a grava nas declarações
+    VarSection section = VarSection::LOCAL;
+
+    [[noreturn]] void error(const Token& token, const std::string& message);
+    void synchronize(int unclosedBlocks);
+
+    // Executa um método de parsing; num erro de sintaxe ressincroniza e devolve nullptr
+    template <typename T>
+    NodePtr<T> recover(NodePtr<T> (Parser::*parseMethod)()) {
+        size_t start = current;
+        int blocks = openBlocks;
+        try {
+            auto node = (this->*parseMethod)();
+            lexicalError = false;
+            return node;
+        } catch (const ParseError&) {
+            lexicalError = false;
+            synchronize(openBlocks - blocks);
+            openBlocks = blocks;
+            if (current == start) advance(); // Garante progresso
+            return nullptr;
+        }
+    }
 
     // Métodos auxiliares
     bool isAtEnd() const;
     const Token& peek() const;
+    const Token& peekNext(); // Token depois do atual (lê mais um da origem, se preciso)
     const Token& previous() const;
     const Token& advance();
     bool check(TokenType type) const;
+    bool check(TokenClass types) const;
     bool match(TokenType type);
-    bool match(std::initializer_list<TokenType> types);
-    Token consume(TokenType type, const std::string& message);
-    Token consume(std::initializer_list<TokenType> types, const std::string& message);
+    bool match(TokenClass types);
+    Token consume(TokenType type, const char* message);
+    Token consume(TokenClass types, const char* message);
 
     // Métodos de parsing
-    std::unique_ptr<Statement> parseDeclaration();
-    std::unique_ptr<Function> parseFunction();
-    std::unique_ptr<Statement> parseStatement();
-    std::vector<std::unique_ptr<Statement>> parseVariableDeclaration();
-
-    std::unique_ptr<Statement> parseGlobalVariableDeclaration();
-    std::unique_ptr<Statement> parseAssignmentOrFunctionCall();
-    std::unique_ptr<BlockStatement> parseBlock();
-    std::unique_ptr<Statement> parseAssignment();
-    std::unique_ptr<ReturnStatement> parseReturnStatement();
-    std::unique_ptr<Statement> parseIfStatement();
-    std::unique_ptr<Statement> parseWhileStatement();
-    std::unique_ptr<Statement> parseForStatement();
+    NodePtr<Statement> parseDeclaration();
+    NodePtr<Function> parseFunction();
+    NodePtr<Statement> parseStatement();
+    NodeList<Statement> parseVariableDeclaration(VarSection declaredSection = VarSection::LOCAL);
+    NodePtr<Statement> parseVariable();
+    // Argumentos de uma chamada, depois do '(': posicionais ou 'x := valor' e 'y => variável'
+    NodePtr<FunctionCall> parseCall(std::string_view name);
+
+    NodePtr<Statement> parseGlobalVariableDeclaration();
+    NodePtr<Statement> parseAssignmentOrFunctionCall();
+    NodePtr<BlockStatement> parseBlock();
+    NodePtr<Statement> parseAssignment();
+    NodePtr<ReturnStatement> parseReturnStatement();
+    NodePtr<Statement> parseIfStatement();
+    NodePtr<Statement> parseWhileStatement();
+    NodePtr<Statement> parseForStatement();
 
     // Métodos de parsing de expressões
-    std::unique_ptr<Expression> parseExpression();
-    std::unique_ptr<Expression> parseLogicalOr();
-    std::unique_ptr<Expression> parseLogicalAnd();
-    std::unique_ptr<Expression> parseEquality();
-    std::unique_ptr<Expression> parseComparison();
-    std::unique_ptr<Expression> parseTerm();
-    std::unique_ptr<Expression> parseFactor();
-    std::unique_ptr<Expression> parseUnary();
-    std::unique_ptr<Expression> parsePrimary();
+    // Precedence climbing (Pratt): consome operadores binários com força de
+    // ligação maior que minBindingPower, segundo a tabela em parser.cpp
+    NodePtr<Expression> parseExpression(int minBindingPower = 0);
+    NodePtr<Expression> parseUnary();
+    NodePtr<Expression> parsePrimary();
 
     // Auxiliar para operadores
     OperatorType getOperatorType(TokenType type);
+
+    // Valor de um NUMBER inteiro que caiba em 'int' (limites de arrays)
+    int parseInteger(const Token& token);
 };
 
 #endif // PARSER_HPP
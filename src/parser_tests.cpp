@@ -3,22 +3,47 @@
 #include "parser.hpp"
 #include "scanner.hpp"
 #include "semantic_analyzer.hpp"
+#include "symbol_table.hpp"
+#include "type_table.hpp"
 #include "ast_optimizer.hpp"
+#include "benchmarks.hpp"
+#include "parallel_parser.hpp"
+#include "incremental_parser.hpp"
+#include "ast_cache.hpp"
+#include "compiler.hpp"
+#include "source_hash.hpp"
+#include "flat_ast.hpp"
 #include "value.hpp" // Incluído para usar a definição da classe Value
 #include <iostream>
 #include <unordered_map>
 #include <string>
 #include <cmath>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+#include <functional>
 
 using namespace std;
 
 // Removemos a definição duplicada da classe 'Value'
 
 // Classe Interpreter para executar a AST
+// Executa um programa já analisado: as variáveis ficam nos slots numerados pela
+// análise semântica (um vetor de globais e um quadro por chamada), sem busca por
+// nome, e cada operação segue o tipo estático anotado nos nós. As chamadas vão
+// direto à POU ligada pela análise; uma instância de bloco funcional guarda o
+// índice do quadro dela, que persiste entre as chamadas.
 class Interpreter : public Visitor {
 public:
     void interpret(Program& program);
 
+    // Executa a POU 'entry' e devolve o valor de retorno dela
+    Value run(Program& program, std::string_view entry);
+
     // Implementação dos métodos visit
     void visitProgram(Program& program) override;
     void visitVariableDeclaration(VariableDeclaration& varDecl) override;
@@ -41,37 +66,62 @@ public:
     Value visitArrayAccess(ArrayAccess& arrayAccess) override;
 
 private:
+    // Quadro de uma chamada: variáveis locais e o valor de retorno
+    struct Frame {
+        std::vector<Value> slots;
+        Value result;
+    };
+
     // Ambiente de execução
-    vector<unordered_map<string, Value>> environment;
-    std::unordered_map<std::string, Function*> functions;
+    std::vector<Value> globals;
+    std::vector<Frame> frames;
+    std::vector<Frame> instances; // Quadros das instâncias de blocos funcionais
+    std::unordered_map<std::string_view, Function*> functions; // Só para achar a POU inicial
+    TypeTable types; // Só para o valor inicial de variáveis sem inicializador
 
     Value lastValue;
+    bool returning = false; // RETURN executado: os blocos param até sair da função
+
+    // Referências valem só até a próxima chamada de função (o vetor de quadros pode crescer)
+    Value& variable(Identifier& identifier);
+    Value& variable(Storage storage, uint32_t slot);
+    Value& declared(uint32_t slot);
 
-    void enterScope();
-    void exitScope();
-    void defineVariable(const std::string& name, const Value& value);
-    Value getVariable(const std::string& name);
+    // Executa o corpo da POU sobre o quadro do topo da pilha
+    void execute(Function& function);
 };
 
 // Implementação da classe Interpreter
 
 void Interpreter::interpret(Program& program) {
-    // Inicializa o ambiente global
-    environment.push_back({});
-    // Coleta todas as funções definidas
-    for (auto& stmt : program.statements) {
-        if (auto func = dynamic_cast<Function*>(stmt.get())) { functions[func->name] = func; }
-    }
     // Executa o programa principal
+    run(program, "MainProgram");
+}
+
+Value Interpreter::run(Program& program, std::string_view entry) {
+    globals.assign(program.globalSlots, Value());
+    frames.clear();
+    instances.clear();
+    functions.clear();
+    returning = false;
+
+    // Coleta as funções definidas e inicializa as variáveis globais
     for (auto& stmt : program.statements) {
         if (auto func = dynamic_cast<Function*>(stmt.get())) {
-            if (func->name == "MainProgram") {
-                func->accept(*this);
-                break;
-            }
+            functions[func->name] = func;
+        } else {
+            stmt->accept(*this);
         }
     }
-    environment.pop_back();
+
+    auto it = functions.find(entry);
+    if (it == functions.end()) {
+        throw std::runtime_error("Função não definida: " + std::string(entry));
+    }
+    it->second->accept(*this);
+    Value returnValue = lastValue;
+    lastValue = Value::Void();
+    return returnValue;
 }
 
 void Interpreter::visitProgram(Program& program) {
@@ -79,49 +129,54 @@ void Interpreter::visitProgram(Program& program) {
 }
 
 void Interpreter::visitVariableDeclaration(VariableDeclaration& varDecl) {
+    // Só inicializa slots ainda vazios: entradas passadas na chamada e o estado
+    // de uma instância de bloco funcional são mantidos
+    if (declared(varDecl.slot).getType() != Value::Type::VOID) {
+        return;
+    }
     Value value;
-    if (varDecl.initializer) { value = varDecl.initializer->accept(*this); }
-    defineVariable(varDecl.name, value);
+    if (varDecl.initializer) {
+        value = varDecl.initializer->accept(*this);
+    } else {
+        switch (types.kind(types.named(varDecl.type))) {
+            case TypeKind::INTEGER: value = Value(0); break;
+            case TypeKind::REAL: value = Value(0.0); break;
+            case TypeKind::BOOLEAN: value = Value(false); break;
+            default: break;
+        }
+    }
+    declared(varDecl.slot) = value;
 }
 
 void Interpreter::visitArrayDeclaration(ArrayDeclaration& arrayDecl) {
     // Para simplificar, não implementaremos arrays neste exemplo
-    defineVariable(arrayDecl.name, Value::Void());
+    declared(arrayDecl.slot) = Value::Void();
 }
 
 void Interpreter::visitAssignment(Assignment& assignment) {
     Value value = assignment.right->accept(*this);
     if (auto identifier = dynamic_cast<Identifier*>(assignment.left.get())) {
         // Atribuição simples
-        for (auto scopeIt = environment.rbegin(); scopeIt != environment.rend(); ++scopeIt) {
-            auto it = scopeIt->find(identifier->name);
-            if (it != scopeIt->end()) {
-                it->second = value;
-                return;
-            }
-        }
-        throw std::runtime_error("Variável não definida: " + identifier->name);
+        variable(*identifier) = value;
     } else {
         throw std::runtime_error("Tipo de atribuição não suportado.");
     }
 }
 
-void Interpreter::visitReturnStatement(ReturnStatement& returnStmt) { lastValue = returnStmt.value->accept(*this); }
+void Interpreter::visitReturnStatement(ReturnStatement& returnStmt) {
+    Value value = returnStmt.value->accept(*this);
+    frames.back().result = value;
+    returning = true;
+}
 
 void Interpreter::visitIfStatement(IfStatement& ifStmt) {
-    Value condition = ifStmt.condition->accept(*this);
-
-    if (condition.getType() != Value::Type::BOOLEAN) { throw std::runtime_error("A condição do IF deve ser BOOLEAN."); }
-    if (condition.getBoolValue()) { ifStmt.thenBranch->accept(*this); }
+    // A análise semântica garante que a condição é BOOLEAN
+    if (ifStmt.condition->accept(*this).getBoolValue()) { ifStmt.thenBranch->accept(*this); }
     else if (ifStmt.elseBranch) { ifStmt.elseBranch->accept(*this); }
 }
 
 void Interpreter::visitWhileStatement(WhileStatement& whileStmt) {
-    while (true) {
-        Value condition = whileStmt.condition->accept(*this);
-
-        if (condition.getType() != Value::Type::BOOLEAN) { throw std::runtime_error("A condição do WHILE deve ser BOOLEAN."); }
-        if (!condition.getBoolValue()) { break; }
+    while (!returning && whileStmt.condition->accept(*this).getBoolValue()) {
         whileStmt.body->accept(*this);
     }
 }
@@ -129,50 +184,48 @@ void Interpreter::visitWhileStatement(WhileStatement& whileStmt) {
 void Interpreter::visitForStatement(ForStatement& forStmt) {
     forStmt.initializer->accept(*this);
     Value endValue = forStmt.endCondition->accept(*this);
-    if (endValue.getType() != Value::Type::INTEGER) { throw std::runtime_error("A condição final do FOR deve ser INTEGER."); }
-    std::string varName;
-    if (auto varAssign = dynamic_cast<Assignment*>(forStmt.initializer.get())) {
-        if (auto identifier = dynamic_cast<Identifier*>(varAssign->left.get())) {
-            varName = identifier->name;
-        } else {
-            throw std::runtime_error("A variável de controle do FOR deve ser um identificador simples.");
-        }
-    } else {
-        throw std::runtime_error("Inicialização do FOR inválida.");
+    if (forStmt.endCondition->type != TypeTable::INTEGER) { throw std::runtime_error("A condição final do FOR deve ser INTEGER."); }
+    auto identifier = dynamic_cast<Identifier*>(forStmt.initializer->left.get());
+    if (!identifier) {
+        throw std::runtime_error("A variável de controle do FOR deve ser um identificador simples.");
+    }
+    if (identifier->type != TypeTable::INTEGER) {
+        throw std::runtime_error("A variável de controle do FOR deve ser INTEGER.");
     }
 
-    while (true) {
-        Value currentValue = getVariable(varName);
-        if (currentValue.getType() != Value::Type::INTEGER) {
-            throw std::runtime_error("A variável de controle do FOR deve ser INTEGER.");
-        }
-        if (currentValue.getIntValue() > endValue.getIntValue()) {
-            break;
-        }
+    while (!returning && variable(*identifier).getIntValue() <= endValue.getIntValue()) {
         forStmt.body->accept(*this);
         // Incrementa a variável de controle
-        defineVariable(varName, Value(currentValue.getIntValue() + 1));
+        Value& counter = variable(*identifier);
+        counter = Value(counter.getIntValue() + 1);
     }
 }
 
 void Interpreter::visitFunction(Function& function) {
-    enterScope();
+    frames.push_back({std::vector<Value>(function.frameSlots), Value()});
+    execute(function);
+    lastValue = frames.back().result;
+    frames.pop_back();
+}
+
+void Interpreter::execute(Function& function) {
     for (auto& stmt : function.body) {
         stmt->accept(*this);
-        if (function.returnType != "VOID" && lastValue.getType() != Value::Type::VOID) {
+        if (returning) {
             // Retorno encontrado
             break;
         }
     }
-    exitScope();
+    returning = false;
 }
 
 void Interpreter::visitBlockStatement(BlockStatement& blockStmt) {
-    enterScope();
     for (auto& stmt : blockStmt.statements) {
         stmt->accept(*this);
+        if (returning) {
+            break;
+        }
     }
-    exitScope();
 }
 
 void Interpreter::visitExpressionStatement(ExpressionStatement& exprStmt) {
@@ -180,80 +233,75 @@ void Interpreter::visitExpressionStatement(ExpressionStatement& exprStmt) {
 }
 
 Value Interpreter::visitIdentifier(Identifier& identifier) {
-    return getVariable(identifier.name);
+    return variable(identifier);
 }
 
 Value Interpreter::visitNumber(Number& number) {
-    if (std::floor(number.value) == number.value) {
-        return Value(static_cast<int>(number.value));
-    } else {
+    if (number.type == TypeTable::REAL) {
         return Value(number.value);
     }
+    return Value(static_cast<int>(number.value));
 }
 
 Value Interpreter::visitBooleanLiteral(BooleanLiteral& boolLit) {
     return Value(boolLit.value);
 }
 
+// INTEGER de 32 bits: o estouro dá a volta, como nos CLPs (e não é comportamento indefinido)
+Value wrapped(int64_t value) {
+    return Value(static_cast<int>(static_cast<uint32_t>(value)));
+}
+
 Value Interpreter::visitBinaryOperation(BinaryOperation& binOp) {
     Value left = binOp.left->accept(*this);
     Value right = binOp.right->accept(*this);
 
+    // Os tipos dos operandos vêm da análise semântica: aritmética INTEGER só
+    // quando os dois são INTEGER; com um REAL, ambos são lidos como REAL
+    bool integer = binOp.left->type == TypeTable::INTEGER && binOp.right->type == TypeTable::INTEGER;
+    bool boolean = binOp.left->type == TypeTable::BOOLEAN;
+
     switch (binOp.op) {
         case OperatorType::ADD:
-            if (left.getType() == Value::Type::INTEGER && right.getType() == Value::Type::INTEGER) {
-                return Value(left.getIntValue() + right.getIntValue());
-            } else if (left.getType() == Value::Type::REAL || right.getType() == Value::Type::REAL) {
-                double l = (left.getType() == Value::Type::REAL) ? left.getRealValue() : left.getIntValue();
-                double r = (right.getType() == Value::Type::REAL) ? right.getRealValue() : right.getIntValue();
-                return Value(l + r);
-            }
-            break;
+            if (integer) { return wrapped(int64_t{left.getIntValue()} + right.getIntValue()); }
+            return Value(left.getRealValue() + right.getRealValue());
         case OperatorType::SUBTRACT:
-            if (left.getType() == Value::Type::INTEGER && right.getType() == Value::Type::INTEGER) {
-                return Value(left.getIntValue() - right.getIntValue());
-            } else if (left.getType() == Value::Type::REAL || right.getType() == Value::Type::REAL) {
-                double l = (left.getType() == Value::Type::REAL) ? left.getRealValue() : left.getIntValue();
-                double r = (right.getType() == Value::Type::REAL) ? right.getRealValue() : right.getIntValue();
-                return Value(l - r);
-            }
-            break;
+            if (integer) { return wrapped(int64_t{left.getIntValue()} - right.getIntValue()); }
+            return Value(left.getRealValue() - right.getRealValue());
         case OperatorType::MULTIPLY:
-            if (left.getType() == Value::Type::INTEGER && right.getType() == Value::Type::INTEGER) {
-                return Value(left.getIntValue() * right.getIntValue());
-            } else if (left.getType() == Value::Type::REAL || right.getType() == Value::Type::REAL) {
-                double l = (left.getType() == Value::Type::REAL) ? left.getRealValue() : left.getIntValue();
-                double r = (right.getType() == Value::Type::REAL) ? right.getRealValue() : right.getIntValue();
-                return Value(l * r);
-            }
-            break;
+            if (integer) { return wrapped(int64_t{left.getIntValue()} * right.getIntValue()); }
+            return Value(left.getRealValue() * right.getRealValue());
         case OperatorType::DIVIDE:
-            if (left.getType() == Value::Type::INTEGER && right.getType() == Value::Type::INTEGER) {
+            if (integer) {
                 if (right.getIntValue() == 0) {
                     throw std::runtime_error("Divisão por zero.");
                 }
-                return Value(left.getIntValue() / right.getIntValue());
-            } else if (left.getType() == Value::Type::REAL || right.getType() == Value::Type::REAL) {
-                double l = (left.getType() == Value::Type::REAL) ? left.getRealValue() : left.getIntValue();
-                double r = (right.getType() == Value::Type::REAL) ? right.getRealValue() : right.getIntValue();
-                if (r == 0.0) {
-                    throw std::runtime_error("Divisão por zero.");
-                }
-                return Value(l / r);
+                return wrapped(int64_t{left.getIntValue()} / right.getIntValue());
             }
-            break;
+            if (right.getRealValue() == 0.0) {
+                throw std::runtime_error("Divisão por zero.");
+            }
+            return Value(left.getRealValue() / right.getRealValue());
         case OperatorType::LESS:
-            return Value(left.getIntValue() < right.getIntValue());
+            if (integer) { return Value(left.getIntValue() < right.getIntValue()); }
+            return Value(left.getRealValue() < right.getRealValue());
         case OperatorType::LESS_EQUAL:
-            return Value(left.getIntValue() <= right.getIntValue());
+            if (integer) { return Value(left.getIntValue() <= right.getIntValue()); }
+            return Value(left.getRealValue() <= right.getRealValue());
         case OperatorType::GREATER:
-            return Value(left.getIntValue() > right.getIntValue());
+            if (integer) { return Value(left.getIntValue() > right.getIntValue()); }
+            return Value(left.getRealValue() > right.getRealValue());
         case OperatorType::GREATER_EQUAL:
-            return Value(left.getIntValue() >= right.getIntValue());
+            if (integer) { return Value(left.getIntValue() >= right.getIntValue()); }
+            return Value(left.getRealValue() >= right.getRealValue());
         case OperatorType::EQUAL_EQUAL:
-            return Value(left.getIntValue() == right.getIntValue());
+            if (boolean) { return Value(left.getBoolValue() == right.getBoolValue()); }
+            if (integer) { return Value(left.getIntValue() == right.getIntValue()); }
+            return Value(left.getRealValue() == right.getRealValue());
         case OperatorType::NOT_EQUAL:
-            return Value(left.getIntValue() != right.getIntValue());
+            if (boolean) { return Value(left.getBoolValue() != right.getBoolValue()); }
+            if (integer) { return Value(left.getIntValue() != right.getIntValue()); }
+            return Value(left.getRealValue() != right.getRealValue());
         case OperatorType::AND:
             return Value(left.getBoolValue() && right.getBoolValue());
         case OperatorType::OR:
@@ -270,17 +318,12 @@ Value Interpreter::visitUnaryOperation(UnaryOperation& unaryOp) {
 
     switch (unaryOp.op) {
         case OperatorType::SUBTRACT:
-            if (operand.getType() == Value::Type::INTEGER) {
-                return Value(-operand.getIntValue());
-            } else if (operand.getType() == Value::Type::REAL) {
-                return Value(-operand.getRealValue());
+            if (unaryOp.type == TypeTable::INTEGER) {
+                return wrapped(-int64_t{operand.getIntValue()});
             }
-            break;
+            return Value(-operand.getRealValue());
         case OperatorType::NOT:
-            if (operand.getType() == Value::Type::BOOLEAN) {
-                return Value(!operand.getBoolValue());
-            }
-            break;
+            return Value(!operand.getBoolValue());
         default:
             break;
     }
@@ -289,16 +332,44 @@ Value Interpreter::visitUnaryOperation(UnaryOperation& unaryOp) {
 }
 
 Value Interpreter::visitFunctionCall(FunctionCall& funcCall) {
-    auto it = functions.find(funcCall.functionName);
-    if (it == functions.end()) {
-        throw std::runtime_error("Função não definida: " + funcCall.functionName);
+    Function& function = *funcCall.callee;
+
+    // Quadro da chamada: novo para funções, o da instância para blocos funcionais
+    Frame frame;
+    int instance = -1;
+    if (funcCall.storage == Storage::UNRESOLVED) {
+        frame.slots.resize(function.frameSlots);
+    } else {
+        Value& handle = variable(funcCall.storage, funcCall.slot);
+        if (handle.getType() == Value::Type::VOID) {
+            handle = Value(static_cast<int>(instances.size()));
+            instances.push_back({std::vector<Value>(function.frameSlots), Value()});
+        }
+        instance = handle.getIntValue();
+        frame = std::move(instances[instance]);
     }
-    Function* function = it->second;
 
-    // Para simplificar, não trataremos parâmetros neste exemplo
-    function->accept(*this);
-    Value returnValue = lastValue;
-    lastValue = Value::Void(); // Reseta o valor de retorno
+    // As entradas são avaliadas no quadro de quem chama, antes de empilhar o novo
+    for (size_t i = 0; i < funcCall.arguments.size(); i++) {
+        if (!funcCall.bindings[i].output) {
+            frame.slots[funcCall.bindings[i].slot] = funcCall.arguments[i]->accept(*this);
+        }
+    }
+
+    frames.push_back(std::move(frame));
+    execute(function);
+    frame = std::move(frames.back());
+    frames.pop_back();
+
+    for (size_t i = 0; i < funcCall.arguments.size(); i++) {
+        if (funcCall.bindings[i].output) {
+            variable(static_cast<Identifier&>(*funcCall.arguments[i])) = frame.slots[funcCall.bindings[i].slot];
+        }
+    }
+    Value returnValue = frame.result;
+    if (instance >= 0) {
+        instances[instance] = std::move(frame);
+    }
     return returnValue;
 }
 
@@ -309,26 +380,27 @@ Value Interpreter::visitArrayAccess(ArrayAccess& arrayAccess) {
 
 // Métodos auxiliares
 
-void Interpreter::enterScope() {
-    environment.push_back({});
-}
-
-void Interpreter::exitScope() {
-    environment.pop_back();
+Value& Interpreter::variable(Identifier& identifier) {
+    if (identifier.storage == Storage::UNRESOLVED) {
+        throw std::runtime_error("Variável não definida: " + std::string(identifier.name));
+    }
+    return variable(identifier.storage, identifier.slot);
 }
 
-void Interpreter::defineVariable(const std::string& name, const Value& value) {
-    environment.back()[name] = value;
+Value& Interpreter::variable(Storage storage, uint32_t slot) {
+    switch (storage) {
+        case Storage::GLOBAL:
+            return globals[slot];
+        case Storage::LOCAL:
+            return frames.back().slots[slot];
+        default:
+            return frames.back().result;
+    }
 }
 
-Value Interpreter::getVariable(const std::string& name) {
-    for (auto scopeIt = environment.rbegin(); scopeIt != environment.rend(); ++scopeIt) {
-        auto it = scopeIt->find(name);
-        if (it != scopeIt->end()) {
-            return it->second;
-        }
-    }
-    throw std::runtime_error("Variável não definida: " + name);
+Value& Interpreter::declared(uint32_t slot) {
+    // Fora de funções só há as declarações de VAR_GLOBAL
+    return frames.empty() ? globals[slot] : frames.back().slots[slot];
 }
 
 void testParser() {
@@ -379,6 +451,12 @@ void testParser() {
     Parser parser(tokens);
     try {
         auto ast = parser.parse();
+        if (parser.hasErrors()) {
+            for (const auto& diagnostic : parser.getDiagnostics()) {
+                std::cerr << "Erro de sintaxe na " << diagnostic.toString() << std::endl;
+            }
+            return;
+        }
 
         // Realiza a análise semântica
         SemanticAnalyzer analyzer;
@@ -400,7 +478,1285 @@ void testParser() {
     }
 }
 
-int main() {
+void testScannerLineNumbers() {
+    // Comentários e espaços longos o bastante para passar pelo caminho vetorizado
+    std::string code = "(* cabeçalho\n" + std::string(100, '*') + "\n linha *)\n" +
+                       std::string(70, ' ') + "\n\t\t\r\n" + std::string(40, ' ') + "x := 1; (* ** ) *)\n" +
+                       "(*" + std::string(33, '\n') + "*)y";
+
+    Scanner scanner(code);
+    auto tokens = scanner.scanTokens();
+
+    bool ok = tokens.size() == 6 && tokens[0].lexeme == "x" && tokens[0].line == 6 &&
+              tokens[4].lexeme == "y" && tokens[4].line == 40;
+    if (ok) {
+        std::cout << "Contagem de linhas do scanner correta." << std::endl;
+    } else {
+        std::cerr << "Erro na contagem de linhas do scanner." << std::endl;
+    }
+}
+
+void testLiteralDecoding() {
+    std::string code = "42 3.25 T#1h2m3s500ms TIME#1.5s t#25h_15m T#-250ms";
+
+    Scanner scanner(code);
+    auto tokens = scanner.scanTokens();
+
+    bool ok = tokens.size() == 7 &&
+              tokens[0].literal == LiteralKind::INTEGER && tokens[0].intValue == 42 &&
+              tokens[1].literal == LiteralKind::REAL && tokens[1].realValue == 3.25 &&
+              tokens[2].literal == LiteralKind::DURATION && tokens[2].durationNs == 3'723'500'000'000 &&
+              tokens[3].durationNs == 1'500'000'000 &&
+              tokens[4].durationNs == 90'900'000'000'000 &&
+              tokens[5].durationNs == -250'000'000;
+    if (ok) {
+        std::cout << "Literais decodificados corretamente." << std::endl;
+    } else {
+        std::cerr << "Erro na decodificação de literais." << std::endl;
+    }
+}
+
+void testParallelParser() {
+    std::string code = generateBenchmarkSource(40);
+
+    Scanner scanner(code);
+    Parser sequentialParser(scanner);
+    auto sequential = sequentialParser.parse();
+
+    ParallelParser parallelParser(code, 4);
+    auto parallel = parallelParser.parse();
+
+    bool sameOrder = sequential->statements.size() == parallel->statements.size();
+    for (size_t i = 0; sameOrder && i < parallel->statements.size(); i++) {
+        auto expected = dynamic_cast<Function*>(sequential->statements[i].get());
+        auto actual = dynamic_cast<Function*>(parallel->statements[i].get());
+        sameOrder = expected && actual && expected->name == actual->name;
+    }
+
+    // Um erro léxico numa unidade posterior deve citar a linha do arquivo inteiro
+    int errorLine = 1 + static_cast<int>(std::count(code.begin(), code.end(), '\n'));
+    std::string broken = code + "FUNCTION Quebrada : INTEGER\nQuebrada := 1 $ 2;\nEND_FUNCTION\n";
+    ParallelParser brokenParser(broken, 4);
+    brokenParser.parse();
+    const auto& diagnostics = brokenParser.getDiagnostics();
+    bool correctLine = !diagnostics.empty() && diagnostics.front().line == errorLine + 1;
+
+    if (sameOrder && correctLine) {
+        std::cout << "Parsing paralelo equivalente ao sequencial." << std::endl;
+    } else {
+        std::cerr << "Erro no parsing paralelo." << std::endl;
+    }
+}
+
+void testFlatAst() {
+    std::string code = generateBenchmarkSource(20) +
+                       "FUNCTION Grade : REAL\nVAR\n    m : ARRAY[1..3, 0..2] OF REAL;\nEND_VAR\n"
+                       "FOR k := 1 TO 3 DO\n    m[k, 0] := -m[k - 1, 2] / 2.5;\nEND_FOR\nGrade := Func3(m[1, 1]);\n"
+                       "Func4(7, b := k + 1, c => k);\nEND_FUNCTION\n";
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+    FlatAst flat = FlatAst::build(*program);
+
+    // Achatar a árvore reconstruída pelo adaptador deve dar o mesmo AST plano
+    FlatAstAdapter adapter(flat);
+    FlatAst again = FlatAst::build(adapter.program());
+    bool same = flat.size() == again.size();
+    for (NodeId id = 0; same && id < flat.size(); id++) {
+        const FlatNode& a = flat.node(id);
+        const FlatNode& b = again.node(id);
+        same = a.kind == b.kind && a.op == b.op && a.flags == b.flags && a.a == b.a && a.b == b.b && a.c == b.c && a.count == b.count;
+        if (same && a.kind == FlatKind::NUMBER) same = flat.number(id) == again.number(id);
+        if (same && (a.kind == FlatKind::IDENTIFIER || a.kind == FlatKind::FUNCTION_CALL || a.kind == FlatKind::ARGUMENT)) {
+            same = flat.name(a.a) == again.name(b.a);
+        }
+    }
+
+    // Os filhos vêm depois do pai, de modo que a varredura linear é uma pré-ordem
+    for (NodeId id = 0; same && id < flat.size(); id++) {
+        for (NodeId child : flat.childrenOf(id)) same = same && child > id;
+    }
+
+    // Argumentos nomeados e seções de parâmetros sobrevivem à ida e volta
+    size_t named = 0;
+    size_t inputs = 0;
+    for (const FlatNode& node : again.allNodes()) {
+        named += node.kind == FlatKind::ARGUMENT;
+        inputs += node.kind == FlatKind::VARIABLE_DECLARATION && node.flags == static_cast<uint8_t>(VarSection::INPUT);
+    }
+    same = same && named == 2 && inputs == 40;
+
+    if (same) {
+        std::cout << "AST plano equivalente à árvore." << std::endl;
+    } else {
+        std::cerr << "Erro no AST plano." << std::endl;
+    }
+}
+
+// Conta os nós da árvore por Node::kind, conferindo cada tag com o tipo dinâmico do nó
+bool countKinds(Node* node, std::vector<size_t>& counts) {
+    if (!node) return true;
+    counts[static_cast<size_t>(node->kind)]++;
+    bool ok = true;
+    auto visit = [&](Node* child) { ok = countKinds(child, counts) && ok; };
+    switch (node->kind) {
+        case NodeKind::PROGRAM:
+            ok = dynamic_cast<Program*>(node);
+            for (auto& stmt : static_cast<Program*>(node)->statements) visit(stmt.get());
+            break;
+        case NodeKind::VARIABLE_DECLARATION:
+            ok = dynamic_cast<VariableDeclaration*>(node);
+            visit(static_cast<VariableDeclaration*>(node)->initializer.get());
+            break;
+        case NodeKind::ARRAY_DECLARATION:
+            ok = dynamic_cast<ArrayDeclaration*>(node);
+            visit(static_cast<ArrayDeclaration*>(node)->initializer.get());
+            break;
+        case NodeKind::ASSIGNMENT:
+            ok = dynamic_cast<Assignment*>(node);
+            visit(static_cast<Assignment*>(node)->left.get());
+            visit(static_cast<Assignment*>(node)->right.get());
+            break;
+        case NodeKind::RETURN_STATEMENT:
+            ok = dynamic_cast<ReturnStatement*>(node);
+            visit(static_cast<ReturnStatement*>(node)->value.get());
+            break;
+        case NodeKind::IF_STATEMENT: {
+            auto ifStmt = dynamic_cast<IfStatement*>(node);
+            ok = ifStmt;
+            visit(ifStmt->condition.get());
+            visit(ifStmt->thenBranch.get());
+            visit(ifStmt->elseBranch.get());
+            break;
+        }
+        case NodeKind::WHILE_STATEMENT:
+            ok = dynamic_cast<WhileStatement*>(node);
+            visit(static_cast<WhileStatement*>(node)->condition.get());
+            visit(static_cast<WhileStatement*>(node)->body.get());
+            break;
+        case NodeKind::FOR_STATEMENT: {
+            auto forStmt = dynamic_cast<ForStatement*>(node);
+            ok = forStmt;
+            visit(forStmt->initializer.get());
+            visit(forStmt->endCondition.get());
+            visit(forStmt->body.get());
+            break;
+        }
+        case NodeKind::FUNCTION:
+            ok = dynamic_cast<Function*>(node);
+            for (auto& stmt : static_cast<Function*>(node)->body) visit(stmt.get());
+            break;
+        case NodeKind::BLOCK_STATEMENT:
+            ok = dynamic_cast<BlockStatement*>(node);
+            for (auto& stmt : static_cast<BlockStatement*>(node)->statements) visit(stmt.get());
+            break;
+        case NodeKind::EXPRESSION_STATEMENT:
+            ok = dynamic_cast<ExpressionStatement*>(node);
+            visit(static_cast<ExpressionStatement*>(node)->expression.get());
+            break;
+        case NodeKind::IDENTIFIER: ok = dynamic_cast<Identifier*>(node); break;
+        case NodeKind::NUMBER: ok = dynamic_cast<Number*>(node); break;
+        case NodeKind::BOOLEAN_LITERAL: ok = dynamic_cast<BooleanLiteral*>(node); break;
+        case NodeKind::BINARY_OPERATION:
+            ok = dynamic_cast<BinaryOperation*>(node);
+            visit(static_cast<BinaryOperation*>(node)->left.get());
+            visit(static_cast<BinaryOperation*>(node)->right.get());
+            break;
+        case NodeKind::UNARY_OPERATION:
+            ok = dynamic_cast<UnaryOperation*>(node);
+            visit(static_cast<UnaryOperation*>(node)->operand.get());
+            break;
+        case NodeKind::FUNCTION_CALL:
+            ok = dynamic_cast<FunctionCall*>(node);
+            for (auto& arg : static_cast<FunctionCall*>(node)->arguments) visit(arg.get());
+            break;
+        case NodeKind::ARRAY_ACCESS:
+            ok = dynamic_cast<ArrayAccess*>(node);
+            visit(static_cast<ArrayAccess*>(node)->array.get());
+            for (auto& index : static_cast<ArrayAccess*>(node)->indices) visit(index.get());
+            break;
+    }
+    return ok;
+}
+
+void testNodeKinds() {
+    std::string code = generateBenchmarkSource(5) +
+                       "FUNCTION Grade : REAL\nVAR\n    m : ARRAY[1..3, 0..2] OF REAL;\n    ok : BOOLEAN := TRUE;\nEND_VAR\n"
+                       "FOR k := 1 TO 3 DO\n    m[k, 0] := -m[k - 1, 2] / 2.5;\nEND_FOR\nGrade := Func3(m[1, 1]);\n"
+                       "Func4(7, b := k + 1);\nRETURN Grade;\nEND_FUNCTION\n";
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+
+    // A tag de cada nó corresponde à classe dele, inclusive nos nós do adaptador
+    std::vector<size_t> counts(static_cast<size_t>(NodeKind::ARRAY_ACCESS) + 1);
+    bool ok = countKinds(program.get(), counts);
+    FlatAst flat = FlatAst::build(*program);
+    FlatAstAdapter adapter(flat);
+    std::vector<size_t> adapted(counts.size());
+    ok = countKinds(&adapter.program(), adapted) && ok && adapted == counts;
+
+    // NodeKind segue a ordem de FlatKind; o AST plano só acrescenta ARGUMENT
+    std::vector<size_t> flatCounts(counts.size());
+    for (const FlatNode& node : flat.allNodes()) {
+        if (node.kind != FlatKind::ARGUMENT) flatCounts[static_cast<size_t>(node.kind)]++;
+    }
+    ok = ok && counts == flatCounts && std::find(counts.begin(), counts.end(), 0) == counts.end();
+    ok = ok && nodeAs<Function>(program->statements.back().get()) && !nodeAs<Function>(program.get());
+
+    if (ok) {
+        std::cout << "Tags de tipo dos nós corretas." << std::endl;
+    } else {
+        std::cerr << "Erro nas tags de tipo dos nós." << std::endl;
+    }
+}
+
+// Forma prefixada de uma expressão, para comparar a estrutura da árvore
+std::string describeExpression(Expression* expr) {
+    if (auto identifier = dynamic_cast<Identifier*>(expr)) {
+        return std::string(identifier->name);
+    } else if (auto binOp = dynamic_cast<BinaryOperation*>(expr)) {
+        return "(" + operatorTypeToString(binOp->op) + " " + describeExpression(binOp->left.get()) + " " +
+               describeExpression(binOp->right.get()) + ")";
+    } else if (auto unaryOp = dynamic_cast<UnaryOperation*>(expr)) {
+        return "(" + operatorTypeToString(unaryOp->op) + " " + describeExpression(unaryOp->operand.get()) + ")";
+    } else if (auto number = dynamic_cast<Number*>(expr)) {
+        return number->value == std::floor(number->value) ? std::to_string(static_cast<long long>(number->value))
+                                                          : std::to_string(number->value);
+    } else if (auto boolLit = dynamic_cast<BooleanLiteral*>(expr)) {
+        return boolLit->value ? "TRUE" : "FALSE";
+    } else if (auto funcCall = dynamic_cast<FunctionCall*>(expr)) {
+        return std::string(funcCall->functionName) + "()";
+    }
+    return "?";
+}
+
+void testOperatorPrecedence() {
+    std::string code = "x := a - b - c * d / e OR NOT f AND g = -h < i;";
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+    auto assignment = dynamic_cast<Assignment*>(program->statements.front().get());
+    std::string actual = assignment ? describeExpression(assignment->right.get()) : "";
+    std::string expected = "(OR (- (- a b) (/ (* c d) e)) (AND (NOT f) (== g (< (- h) i))))";
+
+    if (actual == expected) {
+        std::cout << "Precedência de operadores correta." << std::endl;
+    } else {
+        std::cerr << "Erro de precedência: " << actual << std::endl;
+    }
+}
+
+void testParserRecovery() {
+    std::string code = R"(
+FUNCTION Primeira : INTEGER
+VAR
+    a : INTEGER;
+    b : ;
+    c : REAL;
+END_VAR
+a := 1 +;
+IF a > 0 THEN
+    a := 2;
+END_IF;
+c := 1.5;
+Primeira := a;
+END_FUNCTION
+
+FUNCTION Segunda : INTEGER
+WHILE (TRUE) DO
+    x := 1 $ 2;
+END_WHILE;
+Segunda := 3;
+END_FUNCTION
+)";
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+
+    // Cada erro é relatado uma vez, com a linha certa, e as duas funções sobrevivem
+    std::vector<int> lines;
+    for (const auto& diagnostic : parser.getDiagnostics()) {
+        lines.push_back(diagnostic.line);
+    }
+    auto first = program->statements.size() == 2 ? dynamic_cast<Function*>(program->statements[0].get()) : nullptr;
+    auto second = program->statements.size() == 2 ? dynamic_cast<Function*>(program->statements[1].get()) : nullptr;
+    bool recovered = first && second && first->body.size() == 4 && second->body.size() == 2;
+
+    if (lines == std::vector<int>{5, 8, 9, 18} && recovered) {
+        std::cout << "Recuperação de erros de sintaxe correta." << std::endl;
+    } else {
+        std::cerr << "Erro na recuperação de erros de sintaxe:";
+        for (const auto& diagnostic : parser.getDiagnostics()) {
+            std::cerr << "\n  " << diagnostic.toString();
+        }
+        std::cerr << std::endl;
+    }
+}
+
+// Compara dois FlatAst nó a nó, incluindo nomes, números e dimensões
+bool sameFlatAst(const FlatAst& a, const FlatAst& b) {
+    if (a.size() != b.size()) return false;
+    for (NodeId id = 0; id < a.size(); id++) {
+        const FlatNode& x = a.node(id);
+        const FlatNode& y = b.node(id);
+        if (x.kind != y.kind || x.op != y.op || x.flags != y.flags || x.a != y.a || x.b != y.b || x.c != y.c || x.count != y.count) {
+            return false;
+        }
+        switch (x.kind) {
+            case FlatKind::IDENTIFIER:
+            case FlatKind::FUNCTION_CALL:
+            case FlatKind::ARGUMENT:
+                if (a.name(x.a) != b.name(y.a)) return false;
+                break;
+            case FlatKind::NUMBER:
+                if (a.number(id) != b.number(id)) return false;
+                break;
+            case FlatKind::ARRAY_DECLARATION: {
+                auto da = a.dimensionsOf(id);
+                auto db = b.dimensionsOf(id);
+                if (!std::equal(da.begin(), da.end(), db.begin(), db.end())) return false;
+                [[fallthrough]];
+            }
+            case FlatKind::FUNCTION:
+            case FlatKind::VARIABLE_DECLARATION:
+                if (a.name(x.a) != b.name(y.a) || a.name(x.b) != b.name(y.b)) return false;
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+void testIncrementalParser() {
+    std::string code = generateBenchmarkSource(10) + "FUNCTION Quebrada : INTEGER\nQuebrada := 1 $ 2;\nEND_FUNCTION\n";
+
+    // Mesma árvore (comparada pelo FlatAst), mesmas linhas das declarações e mesmos
+    // diagnósticos do parsing por unidades
+    auto matchesParallel = [](const std::string& source, const Program& program, const std::vector<Diagnostic>& diagnostics) {
+        ParallelParser reference(source, 4);
+        auto expected = reference.parse();
+        bool same = sameFlatAst(FlatAst::build(*expected), FlatAst::build(program)) &&
+                    reference.getDiagnostics().size() == diagnostics.size();
+        for (size_t i = 0; same && i < program.statements.size(); i++) {
+            same = expected->statements[i]->line == program.statements[i]->line;
+        }
+        for (size_t i = 0; same && i < diagnostics.size(); i++) {
+            same = reference.getDiagnostics()[i].line == diagnostics[i].line &&
+                   reference.getDiagnostics()[i].message == diagnostics[i].message;
+        }
+        return same;
+    };
+    auto findFunction = [](const Program& program, std::string_view name) -> const Function* {
+        for (const auto& stmt : program.statements) {
+            auto function = dynamic_cast<const Function*>(stmt.get());
+            if (function && function->name == name) return function;
+        }
+        return nullptr;
+    };
+
+    IncrementalParser parser;
+    auto before = parser.parse(code);
+    bool correct = matchesParallel(code, *before, parser.getDiagnostics());
+
+    // Editar o corpo de uma função só analisa ela de novo; as outras são os mesmos nós.
+    // A exceção é a unidade com erro, que desce uma linha e cuja mensagem cita a linha
+    std::string edited = code;
+    edited.insert(edited.find("Func4 := acc;"), "acc := acc * 2;\n");
+    auto after = parser.parse(edited);
+    correct = correct && matchesParallel(edited, *after, parser.getDiagnostics()) && parser.reparsedUnits() == 2 &&
+              findFunction(*after, "Func3") == findFunction(*before, "Func3") &&
+              findFunction(*after, "Func9") == findFunction(*before, "Func9") &&
+              findFunction(*after, "Func4") != findFunction(*before, "Func4");
+
+    // Edições que mudam as fronteiras: palavra-chave destruída e comentário não fechado
+    std::string source = edited;
+    size_t keyword = source.find("FUNCTION Func7");
+    size_t comment = source.find("i := i + 1;", source.find("Func2"));
+    struct Edit {
+        size_t position;
+        size_t erased;
+        const char* inserted;
+    };
+    const Edit edits[] = {{keyword + 6, 0, "X"}, {keyword + 6, 1, ""}, {comment, 0, "(* "}, {comment, 3, ""}};
+    for (const auto& edit : edits) {
+        source.replace(edit.position, edit.erased, edit.inserted);
+        auto program = parser.parse(source);
+        correct = correct && matchesParallel(source, *program, parser.getDiagnostics());
+    }
+    correct = correct && source == edited;
+
+    if (correct) {
+        std::cout << "Parsing incremental reaproveita as POUs não alteradas." << std::endl;
+    } else {
+        std::cerr << "Erro no parsing incremental." << std::endl;
+    }
+}
+
+void testAstCache() {
+    std::string code = generateBenchmarkSource(5) +
+                       "FUNCTION Grade : REAL\nVAR\n    m : ARRAY[1..3, 0..2] OF REAL;\nEND_VAR\nGrade := 2.5;\nEND_FUNCTION\n";
+    std::string directory = (std::filesystem::temp_directory_path() / "compilador_teste_cache").string();
+    std::filesystem::remove_all(directory);
+
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+    FlatAst built = FlatAst::build(*program);
+
+    // A entrada mapeada é idêntica ao AST gravado
+    AstCache cache(directory);
+    bool stored = cache.store(code, built);
+    auto loaded = cache.load(code);
+    bool correct = stored && loaded && sameFlatAst(built, *loaded);
+
+    // Outro fonte não encontra a entrada e um arquivo truncado é ignorado
+    correct = correct && !cache.load(code + " ");
+    std::filesystem::resize_file(cache.entryPath(hashSource(code)), 100);
+    correct = correct && !cache.load(code);
+
+    // Conteúdo corrompido com o cabeçalho intacto também é ignorado: um índice de
+    // filho fora da seção, um filho antes do pai e um tipo de nó inexistente
+    auto corrupted = [&](size_t node, size_t field, uint32_t value) {
+        cache.store(code, built);
+        std::string path = cache.entryPath(hashSource(code));
+        std::ifstream in(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        auto nodes = built.allNodes();
+        size_t start = bytes.find(std::string_view(reinterpret_cast<const char*>(nodes.data()), nodes.size_bytes()));
+        std::memcpy(bytes.data() + start + node * sizeof(FlatNode) + field, &value, sizeof(value));
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+        return !cache.load(code);
+    };
+    auto nodes = built.allNodes();
+    auto assignment = static_cast<size_t>(std::find_if(nodes.begin(), nodes.end(), [](const FlatNode& n) {
+        return n.kind == FlatKind::ASSIGNMENT;
+    }) - nodes.begin());
+    correct = correct && corrupted(0, offsetof(FlatNode, count), 0x7FFFFFFF) &&
+              corrupted(assignment, offsetof(FlatNode, a), 1) && corrupted(1, offsetof(FlatNode, kind), 200);
+
+    // Uma nova instância do Compiler (nova inicialização) carrega a árvore do cache
+    Compiler first(directory);
+    first.compile(code);
+    Compiler second(directory);
+    second.compile(code);
+    correct = correct && !first.loadedFromCache() && second.loadedFromCache() && !second.hasErrors() &&
+              sameFlatAst(built, FlatAst::build(*second.getProgram()));
+    std::filesystem::remove_all(directory);
+
+    if (correct) {
+        std::cout << "Cache de AST mapeado em memória correto." << std::endl;
+    } else {
+        std::cerr << "Erro no cache de AST." << std::endl;
+    }
+}
+
+void testTypeTable() {
+    TypeTable types;
+    std::pair<int, int> grid[] = {{1, 3}, {0, 2}};
+    std::pair<int, int> line[] = {{1, 3}};
+
+    // Cada tipo distinto tem um único TypeId
+    TypeId matrix = types.arrayOf(TypeTable::REAL, grid);
+    bool interned = types.named("integer") == TypeTable::INTEGER && types.named("Real") == TypeTable::REAL &&
+                    types.arrayOf(TypeTable::REAL, grid) == matrix && types.arrayOf(TypeTable::REAL, line) != matrix &&
+                    types.arrayOf(TypeTable::INTEGER, grid) != matrix &&
+                    types.toString(matrix) == "ARRAY[1..3, 0..2] OF REAL";
+
+    // Um nome usado antes da declaração do bloco funcional passa a ser o tipo dele
+    TypeId counter = types.named("Counter");
+    bool functionBlock = types.kind(counter) == TypeKind::USER && types.functionBlock("COUNTER") == counter &&
+                         types.kind(counter) == TypeKind::FUNCTION_BLOCK;
+
+    bool arithmetic = types.arithmeticResult(TypeTable::INTEGER, TypeTable::INTEGER) == TypeTable::INTEGER &&
+                      types.arithmeticResult(TypeTable::INTEGER, TypeTable::REAL) == TypeTable::REAL &&
+                      types.arithmeticResult(TypeTable::BOOLEAN, TypeTable::INTEGER) == NO_TYPE &&
+                      types.arithmeticResult(matrix, TypeTable::REAL) == NO_TYPE;
+
+    // Análise semântica com arrays e instâncias de bloco funcional
+    auto analyze = [](const std::string& code) -> std::string {
+        Scanner scanner(code);
+        Parser parser(scanner);
+        auto program = parser.parse();
+        try {
+            SemanticAnalyzer analyzer;
+            analyzer.analyze(program.get());
+        } catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        return "";
+    };
+    std::string valid = analyze(
+        "FUNCTION_BLOCK Counter\nVAR\n    count : INTEGER;\nEND_VAR\ncount := count + 1;\nEND_FUNCTION_BLOCK\n"
+        "PROGRAM Main\nVAR\n    first : Counter;\n    second : COUNTER;\n    m : ARRAY[1..3, 0..2] OF REAL;\nEND_VAR\n"
+        "first := second;\nm[1, 2] := m[2, 0] * 2;\nEND_PROGRAM\n");
+    std::string invalid = analyze("FUNCTION F : INTEGER\nVAR\n    m : ARRAY[1..3] OF REAL;\nEND_VAR\nF := m;\nEND_FUNCTION\n");
+
+    if (interned && functionBlock && arithmetic && valid.empty() &&
+        invalid == "Tipos incompatíveis na atribuição: 'INTEGER' e 'ARRAY[1..3] OF REAL'.") {
+        std::cout << "Tabela de tipos correta." << std::endl;
+    } else {
+        std::cerr << "Erro na tabela de tipos: " << valid << " / " << invalid << std::endl;
+    }
+}
+
+void testSymbolTable() {
+    SymbolTable table;
+    table.define("x", TypeTable::INTEGER, SymbolType::VARIABLE);
+    Symbol& function = table.define("F", TypeTable::REAL, SymbolType::FUNCTION);
+    Parameter parameters[] = {{table.intern("a"), TypeTable::INTEGER, VarSection::INPUT, 0},
+                              {table.intern("pronto"), TypeTable::BOOLEAN, VarSection::OUTPUT, 1}};
+    table.setParameters(function, parameters);
+
+    // Um escopo interno esconde 'x' e some inteiro na saída
+    table.enterScope();
+    bool outer = !table.declaredInCurrentScope("x");
+    table.define("x", TypeTable::REAL, SymbolType::VARIABLE);
+    table.define("y", TypeTable::BOOLEAN, SymbolType::VARIABLE);
+    bool inner = table.declaredInCurrentScope("x") && table.resolve("x")->type == TypeTable::REAL &&
+                 table.resolve("F")->type == TypeTable::REAL;
+    table.exitScope();
+    bool restored = table.resolve("x")->type == TypeTable::INTEGER && table.resolve("y") == nullptr &&
+                    table.declaredInCurrentScope("x") && table.resolve("nada") == nullptr;
+
+    auto signature = table.parameters(*table.resolve("F"));
+    const Parameter* ready = table.findParameter(*table.resolve("F"), "pronto");
+    bool signatureOk = signature.size() == 2 && signature[1].type == TypeTable::BOOLEAN &&
+                       ready == &signature[1] && ready->section == VarSection::OUTPUT &&
+                       table.findParameter(*table.resolve("F"), "x") == nullptr &&
+                       table.parameters(*table.resolve("x")).empty() && table.name(*table.resolve("F")) == "F";
+
+    if (outer && inner && restored && signatureOk) {
+        std::cout << "Tabela de símbolos com escopos correta." << std::endl;
+    } else {
+        std::cerr << "Erro na tabela de símbolos." << std::endl;
+    }
+}
+
+void testParallelAnalysis() {
+    // Erros espalhados entre POUs válidas; 'Forward' usa uma função declarada depois dela
+    std::string code = "FUNCTION Bad1 : INTEGER\nBad1 := TRUE;\nEND_FUNCTION\n" + generateBenchmarkSource(400) +
+                       "FUNCTION Func5 : INTEGER\nFunc5 := 1;\nEND_FUNCTION\n"
+                       "FUNCTION Forward : INTEGER\nForward := Later();\nEND_FUNCTION\n"
+                       "FUNCTION Later : INTEGER\nLater := 2;\nEND_FUNCTION\n"
+                       "FUNCTION Bad3 : REAL\nVAR\n    x : INTEGER;\nEND_VAR\nBad3 := x;\nEND_FUNCTION\n";
+
+    auto analyze = [&](unsigned threads) {
+        Scanner scanner(code);
+        Parser parser(scanner);
+        auto program = parser.parse();
+        SemanticAnalyzer analyzer;
+        analyzer.setThreadCount(threads);
+        try {
+            analyzer.analyze(program.get());
+        } catch (const std::runtime_error&) {
+        }
+        std::vector<std::string> messages;
+        for (const auto& diagnostic : analyzer.getDiagnostics()) {
+            messages.push_back(diagnostic.toString());
+        }
+        return messages;
+    };
+
+    // Cada erro cita a linha onde começa a sua POU
+    auto lineOf = [&](size_t offset) {
+        return "linha " + std::to_string(1 + std::count(code.begin(), code.begin() + offset, '\n')) + ": ";
+    };
+    std::vector<std::string> expected = {
+        lineOf(0) + "Tipos incompatíveis na atribuição: 'INTEGER' e 'BOOLEAN'.",
+        lineOf(code.rfind("FUNCTION Func5")) + "Função 'Func5' já foi declarada.",
+        lineOf(code.rfind("FUNCTION Bad3")) + "Tipos incompatíveis na atribuição: 'REAL' e 'INTEGER'.",
+    };
+    bool correct = analyze(1) == expected;
+    for (int run = 0; run < 5 && correct; run++) {
+        correct = analyze(8) == expected;
+    }
+
+    if (correct) {
+        std::cout << "Análise semântica paralela determinística." << std::endl;
+    } else {
+        std::cerr << "Erro na análise semântica paralela." << std::endl;
+    }
+}
+
+// Anotações da análise semântica (tipos, slots, POU chamada) de uma declaração, em texto
+void describeAnnotations(Node* node, const Program& program, const TypeTable& types, std::string& out) {
+    if (!node) {
+        return;
+    }
+    if (auto expr = dynamic_cast<Expression*>(node)) {
+        out += types.toString(expr->type);
+        if (auto identifier = dynamic_cast<Identifier*>(expr)) {
+            out += "@" + std::to_string(static_cast<int>(identifier->storage)) + ":" + std::to_string(identifier->slot);
+        } else if (auto binOp = dynamic_cast<BinaryOperation*>(expr)) {
+            describeAnnotations(binOp->left.get(), program, types, out);
+            describeAnnotations(binOp->right.get(), program, types, out);
+        } else if (auto unaryOp = dynamic_cast<UnaryOperation*>(expr)) {
+            describeAnnotations(unaryOp->operand.get(), program, types, out);
+        } else if (auto call = dynamic_cast<FunctionCall*>(expr)) {
+            // A POU chamada, pela posição no programa (um nó de outra versão não é achado)
+            auto callee = std::find_if(program.statements.begin(), program.statements.end(),
+                                       [&](const auto& stmt) { return stmt.get() == call->callee; });
+            out += "->" + std::to_string(callee - program.statements.begin());
+            for (size_t i = 0; i < call->arguments.size(); i++) {
+                out += ":" + std::to_string(call->bindings[i].slot);
+                describeAnnotations(call->arguments[i].get(), program, types, out);
+            }
+        }
+        out += " ";
+    } else if (auto function = dynamic_cast<Function*>(node)) {
+        out += std::string(function->name) + "[" + std::to_string(function->frameSlots) + "] ";
+        for (auto& stmt : function->body) describeAnnotations(stmt.get(), program, types, out);
+    } else if (auto block = dynamic_cast<BlockStatement*>(node)) {
+        for (auto& stmt : block->statements) describeAnnotations(stmt.get(), program, types, out);
+    } else if (auto varDecl = dynamic_cast<VariableDeclaration*>(node)) {
+        out += "var:" + std::to_string(varDecl->slot) + " ";
+        describeAnnotations(varDecl->initializer.get(), program, types, out);
+    } else if (auto assignment = dynamic_cast<Assignment*>(node)) {
+        describeAnnotations(assignment->left.get(), program, types, out);
+        describeAnnotations(assignment->right.get(), program, types, out);
+    } else if (auto exprStmt = dynamic_cast<ExpressionStatement*>(node)) {
+        describeAnnotations(exprStmt->expression.get(), program, types, out);
+    }
+}
+
+void testIncrementalAnalysis() {
+    // Modelo do fonte: globais, funções que leem uma global e chamam outra
+    // função, e um bloco funcional instanciado num PROGRAM e em VAR_GLOBAL
+    struct Pou {
+        std::string name, type, parameter, local, globalName, callee;
+    };
+    std::vector<std::pair<std::string, std::string>> globals = {{"g0", "INTEGER"}, {"g1", "REAL"}, {"g2", "INTEGER"}};
+    std::vector<Pou> functions;
+    const char* typeNames[] = {"INTEGER", "REAL"};
+    std::mt19937 random(2024);
+    auto pick = [&](size_t n) { return static_cast<size_t>(random() % n); };
+    // Quase sempre INTEGER, para que boa parte das versões não tenha erros
+    auto anyType = [&] { return typeNames[pick(6) == 0 ? 1 : 0]; };
+    int nextName = 0;
+    auto newFunction = [&] {
+        std::string name = "F" + std::to_string(nextName++);
+        return Pou{name, anyType(), anyType(), anyType(), "g" + std::to_string(pick(4)),
+                   "F" + std::to_string(pick(nextName + 2))};
+    };
+    for (int i = 0; i < 12; i++) {
+        functions.push_back(newFunction());
+    }
+    std::string blockName = "Contador";
+    std::string instanceType = "Contador";
+    std::string blockGlobal = "g0";
+
+    auto source = [&] {
+        std::string code = "VAR_GLOBAL\n";
+        for (const auto& [name, type] : globals) {
+            code += "    " + name + " : " + type + ";\n";
+        }
+        code += "    inst : " + instanceType + ";\nEND_VAR\n";
+        for (const auto& f : functions) {
+            code += "FUNCTION " + f.name + " : " + f.type + "\nVAR_INPUT\n    p : " + f.parameter + ";\nEND_VAR\n" +
+                    "VAR\n    x : " + f.local + ";\nEND_VAR\n" +
+                    "x := x + " + f.globalName + ";\n" + f.name + " := x + " + f.callee + "(p := x);\nEND_FUNCTION\n";
+        }
+        code += "FUNCTION_BLOCK " + blockName + "\nVAR\n    n : INTEGER;\nEND_VAR\nn := n + " + blockGlobal + ";\nEND_FUNCTION_BLOCK\n";
+        code += "PROGRAM Main\nVAR\n    a : " + instanceType + ";\n    b : Contador;\nEND_VAR\na := b;\nEND_PROGRAM\n";
+        code += "PROGRAM Ciclo\ninst();\nEND_PROGRAM\n";
+        return code;
+    };
+
+    struct Result {
+        std::vector<std::string> messages;
+        std::vector<std::string> annotations; // Por declaração de nível superior
+        uint32_t globalSlots;
+    };
+    auto collect = [](Program& program, const SemanticAnalyzer& analyzer) {
+        Result result{{}, {}, program.globalSlots};
+        for (const auto& diagnostic : analyzer.getDiagnostics()) {
+            result.messages.push_back(diagnostic.message);
+        }
+        for (auto& stmt : program.statements) {
+            std::string text;
+            describeAnnotations(stmt.get(), program, analyzer.getTypes(), text);
+            result.annotations.push_back(std::move(text));
+        }
+        return result;
+    };
+
+    IncrementalParser parser;
+    SemanticAnalyzer incremental;
+    incremental.setIncremental(true);
+    incremental.setThreadCount(2);
+    bool correct = true;
+    size_t reused = 0;
+    size_t compared = 0;
+    for (int version = 0; version < 300 && correct; version++) {
+        std::string code = source();
+        auto program = parser.parse(code);
+        try {
+            incremental.analyze(program.get());
+        } catch (const std::runtime_error&) {
+        }
+        reused += incremental.reusedUnits();
+        Result actual = collect(*program, incremental);
+
+        Scanner scanner(code);
+        Parser fresh(scanner);
+        auto reference = fresh.parse();
+        SemanticAnalyzer analyzer;
+        try {
+            analyzer.analyze(reference.get());
+        } catch (const std::runtime_error&) {
+        }
+        Result expected = collect(*reference, analyzer);
+
+        // POUs com erro podem ter anotações antigas depois do ponto do erro:
+        // só são comparadas as que a análise do zero anotou por inteiro
+        correct = actual.messages == expected.messages && actual.globalSlots == expected.globalSlots &&
+                  actual.annotations.size() == expected.annotations.size();
+        for (size_t i = 0; correct && i < expected.annotations.size(); i++) {
+            if (expected.annotations[i].find('?') == std::string::npos) {
+                correct = actual.annotations[i] == expected.annotations[i];
+                compared++;
+            }
+        }
+        if (!correct) {
+            std::cerr << "Versão " << version << " diverge da análise do zero:\n" << code;
+        }
+
+        // Edição aleatória no modelo
+        Pou& f = functions[pick(functions.size())];
+        switch (pick(10)) {
+            case 0: globals[pick(globals.size())].second = anyType(); break;
+            case 1:
+                if (globals.size() > 1 && pick(2)) {
+                    globals.erase(globals.begin() + pick(globals.size()));
+                } else {
+                    globals.insert(globals.begin() + pick(globals.size() + 1), {"g" + std::to_string(pick(5)), anyType()});
+                }
+                break;
+            case 2: f.type = anyType(); break;
+            case 3: (pick(2) ? f.local : f.parameter) = anyType(); break;
+            case 4: f.callee = "F" + std::to_string(pick(nextName + 2)); break;
+            case 5: f.globalName = "g" + std::to_string(pick(5)); break;
+            case 6: f.name = "F" + std::to_string(pick(nextName + 2)); break;
+            case 7:
+                if (functions.size() > 2 && pick(2)) {
+                    functions.erase(functions.begin() + pick(functions.size()));
+                } else {
+                    functions.insert(functions.begin() + pick(functions.size() + 1), newFunction());
+                }
+                break;
+            case 8:
+                if (pick(3) == 0) {
+                    blockGlobal = blockGlobal == "g0" ? "g2" : "g0"; // Outro nó, mesma assinatura
+                } else {
+                    (pick(2) ? blockName : instanceType) = pick(2) ? "Contador" : "Timer";
+                }
+                break;
+            default: std::swap(f, functions[pick(functions.size())]); break;
+        }
+    }
+
+    // Sem reaproveitamento o teste não diria nada sobre o modo incremental
+    if (correct && reused > 0 && compared > 0) {
+        std::cout << "Análise semântica incremental igual à análise do zero (" << reused << " POUs reaproveitadas)." << std::endl;
+    } else {
+        std::cerr << "Erro na análise semântica incremental." << std::endl;
+    }
+}
+
+void testFunctionCalls() {
+    std::string declarations =
+        "VAR_GLOBAL\n    total : INTEGER;\nEND_VAR\n"
+        "FUNCTION Escala : REAL\nVAR_INPUT\n    valor : INTEGER;\n    fator : REAL := 2.5;\nEND_VAR\n"
+        "VAR_OUTPUT\n    dobro : INTEGER;\nEND_VAR\ndobro := valor * 2;\nEscala := valor * fator;\nEND_FUNCTION\n"
+        "FUNCTION_BLOCK Contador\nVAR_INPUT\n    incremento : INTEGER := 1;\nEND_VAR\n"
+        "VAR_OUTPUT\n    contagem : INTEGER;\nEND_VAR\ncontagem := contagem + incremento;\nEND_FUNCTION_BLOCK\n";
+    auto program = [&](const std::string& body) {
+        return declarations + "FUNCTION Principal : REAL\nVAR\n    c : Contador;\n    d : INTEGER;\n    r : REAL;\nEND_VAR\n" +
+               body + "END_FUNCTION\n";
+    };
+    auto analyze = [](const std::string& code, std::unique_ptr<Program>& tree) -> std::string {
+        Scanner scanner(code);
+        Parser parser(scanner);
+        tree = parser.parse();
+        try {
+            SemanticAnalyzer analyzer;
+            analyzer.analyze(tree.get());
+        } catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        return "";
+    };
+
+    // Posicionais, nomeados fora de ordem, entradas omitidas (valor inicial) e saídas;
+    // a instância 'c' guarda a entrada e a contagem entre as chamadas
+    std::unique_ptr<Program> tree;
+    std::string code = program("c();\nc(incremento := 5);\nc(contagem => d);\nr := Escala(3);\n"
+                               "r := r + Escala(fator := 0.5, valor := 4, dobro => total);\n"
+                               "Principal := r + d + total;\n");
+    bool correct = analyze(code, tree).empty();
+    if (correct) {
+        // Cada chamada aponta para o nó da POU, sem busca por nome na execução
+        auto escala = dynamic_cast<Function*>(tree->statements[1].get());
+        auto principal = dynamic_cast<Function*>(tree->statements[3].get());
+        auto assignment = dynamic_cast<Assignment*>(principal->body[6].get());
+        auto call = dynamic_cast<FunctionCall*>(assignment ? assignment->right.get() : nullptr);
+        correct = call && call->callee == escala && call->storage == Storage::UNRESOLVED && call->bindings[0].slot == 0;
+
+        Interpreter interpreter;
+        Value result = interpreter.run(*tree, "Principal");
+        correct = correct && result.getType() == Value::Type::REAL && result.getRealValue() == 7.5 + 2.0 + 11 + 8;
+    }
+
+    // Cada erro de chamada com a sua mensagem
+    struct Case {
+        const char* call;
+        const char* message;
+    };
+    const Case errors[] = {
+        {"Escala(1, 2.5, 3)", "Argumentos demais na chamada de 'Escala'."},
+        {"Escala(peso := 1)", "Parâmetro 'peso' não existe em 'Escala'."},
+        {"Escala(valor := 1, 2.5)", "Argumento posicional depois de argumento nomeado na chamada de 'Escala'."},
+        {"Escala(1, valor := 2)", "Parâmetro 'valor' recebe mais de um argumento na chamada de 'Escala'."},
+        {"Escala(1.5)", "Tipo do argumento 'REAL' não corresponde ao parâmetro 'valor' ('INTEGER') na chamada de 'Escala'."},
+        {"Escala(dobro := 1)", "Parâmetro 'dobro' de 'Escala' é de saída: use '=>'."},
+        {"Escala(valor => d)", "Parâmetro 'valor' de 'Escala' não é de saída: use ':='."},
+        {"Escala(1, dobro => 2)", "O argumento do parâmetro de saída 'dobro' deve ser uma variável."},
+        {"r + c(5, 6)", "Argumentos demais na chamada de 'c'."},
+    };
+    for (const auto& error : errors) {
+        std::string message = analyze(program("r := " + std::string(error.call) + ";\n"), tree);
+        if (message != error.message) {
+            std::cerr << "Chamada '" << error.call << "': " << message << std::endl;
+            correct = false;
+        }
+    }
+
+    if (correct) {
+        std::cout << "Chamadas com argumentos posicionais, nomeados e de saída corretas." << std::endl;
+    } else {
+        std::cerr << "Erro nas chamadas de funções." << std::endl;
+    }
+}
+
+void testConstantFolding() {
+    // Expressões constantes aleatórias, bem tipadas por construção: o resultado
+    // da execução tem de ser o mesmo antes e depois da dobra
+    std::mt19937 random(7);
+    auto pick = [&](int n) { return static_cast<int>(random() % n); };
+    const char* arithmetic[] = {" + ", " - ", " * ", " / "};
+    const char* comparison[] = {" < ", " <= ", " > ", " >= ", " = ", " != "};
+    const char* fractions[] = {".5", ".25", ".0"};
+    std::function<std::string(char, int)> generate = [&](char type, int depth) -> std::string {
+        bool leaf = depth == 0 || pick(4) == 0;
+        switch (type) {
+            case 'I':
+                if (leaf) return pick(8) == 0 ? "2147483647" : std::to_string(pick(6));
+                if (pick(6) == 0) return "-(" + generate('I', depth - 1) + ")";
+                return "(" + generate('I', depth - 1) + arithmetic[pick(4)] + generate('I', depth - 1) + ")";
+            case 'R':
+                if (leaf) return std::to_string(pick(4)) + fractions[pick(3)]; // '.0': REAL de valor inteiro
+                if (pick(6) == 0) return "-(" + generate('R', depth - 1) + ")";
+                return "(" + generate('R', depth - 1) + arithmetic[pick(4)] + generate(pick(2) ? 'R' : 'I', depth - 1) + ")";
+            default:
+                if (leaf) return pick(2) ? "TRUE" : "FALSE";
+                switch (pick(5)) {
+                    case 0: return "NOT (" + generate('B', depth - 1) + ")";
+                    case 1: return "(" + generate('B', depth - 1) + (pick(2) ? " AND " : " OR ") + generate('B', depth - 1) + ")";
+                    case 2: return "(" + generate('B', depth - 1) + (pick(2) ? " = " : " != ") + generate('B', depth - 1) + ")";
+                    default: {
+                        char operands = pick(2) ? 'I' : 'R';
+                        return "(" + generate(operands, depth - 1) + comparison[pick(6)] + generate(operands, depth - 1) + ")";
+                    }
+                }
+        }
+    };
+    auto execute = [](Program& program) {
+        try {
+            Interpreter interpreter;
+            Value value = interpreter.run(program, "Calculo");
+            return value.toString() + (value.getType() == Value::Type::REAL ? " REAL" : "");
+        } catch (const std::runtime_error& e) {
+            return std::string("erro: ") + e.what();
+        }
+    };
+
+    bool correct = true;
+    int folded = 0;
+    for (int i = 0; i < 1000 && correct; i++) {
+        const char* typeNames[] = {"INTEGER", "REAL", "BOOLEAN"};
+        int type = pick(3);
+        std::string expression = generate("IRB"[type], 4);
+        std::string code = std::string("FUNCTION Calculo : ") + typeNames[type] + "\nCalculo := " + expression + ";\nEND_FUNCTION\n";
+        Scanner scanner(code);
+        Parser parser(scanner);
+        auto program = parser.parse();
+        SemanticAnalyzer analyzer;
+        analyzer.analyze(program.get());
+        std::string expected = execute(*program);
+        ASTOptimizer optimizer;
+        optimizer.optimize(program.get());
+        std::string actual = execute(*program);
+        auto& assignment = static_cast<Assignment&>(*static_cast<Function&>(*program->statements[0]).body[0]);
+        folded += assignment.right->kind == NodeKind::NUMBER || assignment.right->kind == NodeKind::BOOLEAN_LITERAL;
+        if (actual != expected) {
+            std::cerr << expression << ": " << expected << " antes da dobra, " << actual << " depois" << std::endl;
+            correct = false;
+        }
+    }
+
+    // Tipos dos resultados, o que não pode ser dobrado e a eliminação de ramos
+    std::string code =
+        "FUNCTION Ramos : INTEGER\nVAR\n    i : INTEGER := 7 / 2;\n    r : REAL := 7.5 / 2;\n"
+        "    b : BOOLEAN := NOT (1 < 2) OR 2.5 = 2.5;\n    z : INTEGER := 1 / 0;\n    o : INTEGER := 2147483647 + 1;\nEND_VAR\n"
+        "IF (3 > 4) THEN\n    i := 1;\nELSE\n    i := 2;\nEND_IF\n"
+        "IF (TRUE AND FALSE) THEN\n    i := 3;\nEND_IF\n"
+        "WHILE (1 = 2) DO\n    i := 4;\nEND_WHILE\n"
+        "Ramos := i;\nEND_FUNCTION\n";
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+    SemanticAnalyzer analyzer;
+    analyzer.analyze(program.get());
+    ASTOptimizer optimizer;
+    optimizer.optimize(program.get());
+    auto& body = static_cast<Function&>(*program->statements[0]).body;
+    auto initializer = [&](size_t i) { return static_cast<VariableDeclaration&>(*body[i]).initializer.get(); };
+    auto number = [&](size_t i) { return nodeAs<Number>(initializer(i)); };
+    auto literal = nodeAs<BooleanLiteral>(initializer(2));
+    auto elseBranch = nodeAs<BlockStatement>(body[5].get());
+    correct = correct && number(0) && number(0)->value == 3 && number(0)->type == TypeTable::INTEGER &&
+              number(1) && number(1)->value == 3.75 && number(1)->type == TypeTable::REAL &&
+              literal && literal->value && literal->type == TypeTable::BOOLEAN &&
+              !number(3) && !number(4) &&
+              elseBranch && elseBranch->statements.size() == 1 &&
+              body.size() == 7 && nodeAs<Assignment>(body[6].get()); // O IF sem ELSE e o WHILE somem
+
+    if (correct && folded > 500) {
+        std::cout << "Dobra de constantes igual à execução (" << folded << " expressões dobradas)." << std::endl;
+    } else {
+        std::cerr << "Erro na dobra de constantes." << std::endl;
+    }
+}
+
+void testDeadCodeElimination() {
+    std::string code =
+        "VAR_GLOBAL\n    modo : INTEGER := 2;\nEND_VAR\n"
+        "FUNCTION Efeito : BOOLEAN\nmodo := modo + 1;\nEfeito := TRUE;\nEND_FUNCTION\n"
+        "FUNCTION Config : INTEGER\nVAR\n    x : INTEGER := 1;\n    b : BOOLEAN;\nEND_VAR\n"
+        "IF (FALSE) THEN\n    x := 10;\nEND_IF\n"                           // IF, condição, bloco e x := 10: 6 nós
+        "IF (TRUE) THEN\n    x := x + 1;\nELSE\n    x := 20;\nEND_IF\n"      // IF, condição e o ELSE: 6 nós
+        "IF (x > 0) THEN\nEND_IF\n"                                         // Vazio e sem chamadas: 5 nós
+        "IF (Efeito()) THEN\nEND_IF\n"                                      // Vazio, mas a chamada fica
+        "IF (x > 5) THEN\n    x := 0;\nELSE\nEND_IF\n"                       // Só o ELSE vazio: 1 nó
+        "WHILE (1 > 2) DO\n    x := 30;\nEND_WHILE\n"                        // 6 nós
+        "IF (x = 2) THEN\n    RETURN x * modo;\nELSE\n    Config := x;\n    RETURN 0;\n    x := 40;\nEND_IF\n" // x := 40: 3 nós
+        "x := 50;\nRETURN x;\n"                                             // Depois de um IF que sempre retorna: 5 nós
+        "END_FUNCTION\n";
+
+    auto run = [&](bool optimize, size_t& removed, size_t& remaining) {
+        Scanner scanner(code);
+        Parser parser(scanner);
+        auto program = parser.parse();
+        SemanticAnalyzer analyzer;
+        analyzer.analyze(program.get());
+        ASTOptimizer optimizer;
+        if (optimize) {
+            optimizer.optimize(program.get());
+        }
+        removed = optimizer.removedNodes();
+        remaining = static_cast<Function&>(*program->statements[2]).body.size();
+        Interpreter interpreter;
+        return interpreter.run(*program, "Config").toString();
+    };
+    size_t removed = 0;
+    size_t remaining = 0;
+    size_t before = 0;
+    std::string expected = run(false, removed, before);
+    std::string actual = run(true, removed, remaining);
+
+    // Declarações, IF (TRUE) virou bloco, a chamada, o IF com ELSE vazio e o último IF
+    if (actual == expected && expected == "6" && removed == 32 && before == 11 && remaining == 6) {
+        std::cout << "Eliminação de código morto correta (" << removed << " nós removidos)." << std::endl;
+    } else {
+        std::cerr << "Erro na eliminação de código morto: " << actual << " (esperado " << expected << "), "
+                  << removed << " nós removidos, " << before << " -> " << remaining << " comandos" << std::endl;
+    }
+}
+
+void testAlgebraicSimplification() {
+    // Um caso por regra da tabela (e casos em que nenhuma pode valer): a forma
+    // da expressão depois da otimização e o resultado da execução, que não muda
+    struct Case {
+        std::string rule; // Vazio: nenhuma regra se aplica
+        std::string target;
+        std::string expression;
+        std::string expected;
+    };
+    std::vector<Case> cases = {
+        {"x + 0", "i", "i + 0", "i"},
+        {"0 + x", "i", "0 + i", "i"},
+        {"x - 0", "r", "r - 0", "r"},
+        {"x * 1", "r", "r * 1", "r"},
+        {"1 * x", "i", "1 * i", "i"},
+        {"x / 1", "r", "r / 1", "r"},
+        {"x * 0", "i", "(i + 3) * 0", "0"},
+        {"0 * x", "i", "0 * i", "0"},
+        {"x * -1", "r", "r * -1", "(- r)"},
+        {"-1 * x", "i", "-1 * i", "(- i)"},
+        {"x / -1", "i", "i / -1", "(- i)"},
+        {"x * 2", "r", "r * 2", "(+ r r)"},
+        {"2 * x", "i", "2 * i", "(+ i i)"},
+        {"b AND TRUE", "b", "b AND TRUE", "b"},
+        {"TRUE AND b", "b", "TRUE AND i > 3", "(> i 3)"},
+        {"b AND FALSE", "b", "b AND FALSE", "FALSE"},
+        {"FALSE AND b", "b", "FALSE AND i > 3", "FALSE"},
+        {"b OR FALSE", "b", "b OR FALSE", "b"},
+        {"FALSE OR b", "b", "FALSE OR b", "b"},
+        {"b OR TRUE", "b", "b OR TRUE", "TRUE"},
+        {"TRUE OR b", "b", "TRUE OR i > 3", "TRUE"},
+        {"b = TRUE", "b", "b = TRUE", "b"},
+        {"TRUE = b", "b", "TRUE = b", "b"},
+        {"b != FALSE", "b", "b != FALSE", "b"},
+        {"FALSE != b", "b", "FALSE != b", "b"},
+        {"NOT NOT b", "b", "NOT NOT b", "b"},
+        {"-(-x)", "i", "-(-i)", "i"},
+        {"x * -1", "i", "i * -1 * -1", "i"},                          // -(-i) depois da segunda regra
+        {"", "r", "r + 0", "(+ r 0)"},                                // -0.0 + 0 é +0.0
+        {"", "r", "r - (-0.0)", "(- r 0)"},                           // -0.0 - (-0.0) é +0.0
+        {"", "r", "r * 0", "(* r 0)"},                                // Infinito ou NaN vezes 0
+        {"", "i", "Conta() * 0", "(* Conta() 0)"},                    // A chamada tem efeito
+        {"", "i", "i / (i - 6) * 0", "(* (/ i (- i 6)) 0)"},          // A divisão pode falhar
+        {"", "b", "Liga() AND FALSE", "(AND Liga() FALSE)"},
+        {"", "i", "(i + 1) * 2", "(* (+ i 1) 2)"},                    // Só variáveis são duplicadas
+    };
+
+    bool correct = true;
+    std::set<std::string> covered;
+    for (const auto& c : cases) {
+        std::string code =
+            "VAR_GLOBAL\n    contador : INTEGER;\nEND_VAR\n"
+            "FUNCTION Conta : INTEGER\ncontador := contador + 1;\nConta := contador;\nEND_FUNCTION\n"
+            "FUNCTION Liga : BOOLEAN\ncontador := contador + 10;\nLiga := TRUE;\nEND_FUNCTION\n"
+            "FUNCTION Teste : INTEGER\nVAR\n    i : INTEGER := 7;\n    r : REAL := 2.5;\n    b : BOOLEAN := TRUE;\nEND_VAR\n" +
+            c.target + " := " + c.expression + ";\n"
+            "IF (b) THEN\n    Teste := i + contador;\nELSE\n    Teste := contador - 100;\nEND_IF\n"
+            "IF (r > 0.5) THEN\n    Teste := Teste * 1000;\nEND_IF\n"
+            "END_FUNCTION\n";
+        Scanner scanner(code);
+        Parser parser(scanner);
+        auto program = parser.parse();
+        SemanticAnalyzer analyzer;
+        analyzer.analyze(program.get());
+        std::string before = Interpreter().run(*program, "Teste").toString();
+        ASTOptimizer optimizer;
+        optimizer.optimize(program.get());
+        std::string after = Interpreter().run(*program, "Teste").toString();
+
+        auto& assignment = static_cast<Assignment&>(*static_cast<Function&>(*program->statements[3]).body[3]);
+        std::string actual = describeExpression(assignment.right.get());
+        bool applied = optimizer.simplifications() > 0;
+        if (actual != c.expected || before != after || applied != !c.rule.empty()) {
+            std::cerr << "Regra '" << c.rule << "' em " << c.expression << ": " << actual << " (esperado " << c.expected
+                      << "), execução " << before << " -> " << after << std::endl;
+            correct = false;
+        }
+        covered.insert(c.rule);
+    }
+    for (const auto& rule : ASTOptimizer::simplificationRules()) {
+        if (!covered.contains(rule.name)) {
+            std::cerr << "Regra sem teste: " << rule.name << std::endl;
+            correct = false;
+        }
+    }
+
+    if (correct) {
+        std::cout << "Simplificação algébrica correta (" << ASTOptimizer::simplificationRules().size() << " regras)." << std::endl;
+    } else {
+        std::cerr << "Erro na simplificação algébrica." << std::endl;
+    }
+}
+
+void testCommonSubexpressions() {
+    std::string code =
+        "VAR_GLOBAL\n    contador : INTEGER := 4;\nEND_VAR\n"
+        "FUNCTION Conta : INTEGER\ncontador := contador + 1;\nConta := contador;\nEND_FUNCTION\n"
+        "FUNCTION Intertravamento : INTEGER\nVAR\n    x : INTEGER := 7;\n    limite : INTEGER := 5;\n"
+        "    habilita : BOOLEAN := TRUE;\n    n : INTEGER := 0;\n    y : INTEGER;\nEND_VAR\n"
+        "IF (x * 3 > limite AND habilita) THEN\n    n := n + 1;\nEND_IF\n"
+        "IF (x * 3 > limite AND habilita) THEN\n    n := n + 10;\nEND_IF\n" // A condição inteira: 1
+        "y := x * 3 + contador;\n"                                         // x * 3, de dentro da condição: 1
+        "x := x + 1;\n"
+        "y := y + x * 3;\n"                                                // x mudou
+        "y := y + (contador + 2) * Conta();\n"                             // A chamada muda contador
+        "y := y + (contador + 2);\n"
+        "Intertravamento := y * 5 + n - y * 5 / 3;\n"                      // y * 5: 1
+        "END_FUNCTION\n";
+
+    // O nome em CseHits é uma visão sobre o arena do programa: é copiado antes de ele sumir
+    struct Outcome {
+        std::string result;
+        std::string pou;
+        size_t hits = 0;
+        size_t temporaries = 0;
+        size_t pous = 0;
+        size_t statements = 0;
+    };
+    auto run = [&](bool optimize) {
+        Scanner scanner(code);
+        Parser parser(scanner);
+        auto program = parser.parse();
+        SemanticAnalyzer analyzer;
+        analyzer.analyze(program.get());
+        ASTOptimizer optimizer;
+        Outcome outcome;
+        if (optimize) {
+            optimizer.optimize(program.get());
+        }
+        const auto& hits = optimizer.commonSubexpressions();
+        outcome.pous = hits.size();
+        if (!hits.empty()) {
+            outcome.pou = hits[0].pou;
+            outcome.hits = hits[0].hits;
+            outcome.temporaries = hits[0].temporaries;
+        }
+        outcome.statements = static_cast<Function&>(*program->statements[2]).body.size();
+        outcome.result = Interpreter().run(*program, "Intertravamento").toString();
+        if (optimize) {
+            // Uma segunda passada não acha mais nada
+            optimizer.optimize(program.get());
+            outcome.pous += optimizer.commonSubexpressions().size();
+            outcome.result += " " + Interpreter().run(*program, "Intertravamento").toString();
+        }
+        return outcome;
+    };
+    Outcome expected = run(false);
+    Outcome actual = run(true);
+
+    // Cada temporária acrescenta a atribuição dela à lista de comandos
+    if (actual.result == expected.result + " " + expected.result && actual.pous == 1 &&
+        actual.pou == "Intertravamento" && actual.hits == 3 && actual.temporaries == 3 &&
+        actual.statements == expected.statements + 3) {
+        std::cout << "Eliminação de subexpressões comuns correta (" << actual.hits << " reaproveitadas)." << std::endl;
+    } else {
+        std::cerr << "Erro na eliminação de subexpressões comuns: " << actual.result << " (esperado "
+                  << expected.result << "), " << actual.hits << " reaproveitadas, " << expected.statements
+                  << " -> " << actual.statements << " comandos" << std::endl;
+    }
+}
+
+// Um literal REAL de valor inteiro ('7.0') é REAL: a divisão é REAL, na análise, na dobra e na execução
+void testIntegralRealLiterals() {
+    std::string code =
+        "FUNCTION Metade : REAL\nVAR\n    r : REAL;\nEND_VAR\n"
+        "r := 7.0 / 2;\nMetade := 7.0 / 2 + r;\nEND_FUNCTION\n";
+
+    auto run = [&](bool optimize) {
+        Scanner scanner(code);
+        Parser parser(scanner);
+        auto program = parser.parse();
+        SemanticAnalyzer analyzer;
+        analyzer.analyze(program.get());
+        auto& body = static_cast<Function&>(*program->statements[0]).body;
+        auto& division = static_cast<BinaryOperation&>(*static_cast<Assignment&>(*body[1]).right);
+        bool typed = division.left->type == TypeTable::REAL && division.type == TypeTable::REAL;
+        if (optimize) {
+            ASTOptimizer optimizer;
+            optimizer.optimize(program.get());
+            auto folded = nodeAs<Number>(static_cast<Assignment&>(*body[1]).right.get());
+            typed = typed && folded && folded->value == 3.5 && folded->type == TypeTable::REAL;
+        }
+        Value result = Interpreter().run(*program, "Metade");
+        return typed && result.getType() == Value::Type::REAL && result.getRealValue() == 7.0;
+    };
+
+    try {
+        if (run(false) && run(true)) {
+            std::cout << "Literais REAL de valor inteiro corretos." << std::endl;
+            return;
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+    }
+    std::cerr << "Erro nos literais REAL de valor inteiro." << std::endl;
+}
+
+void testTypedExecution() {
+    std::string code =
+        "VAR_GLOBAL\n    scale : INTEGER := 3;\nEND_VAR\n"
+        "FUNCTION Media : REAL\nVAR\n    total : INTEGER := 7;\n    count : INTEGER := 2;\n"
+        "    folded : REAL := 7 / 2 * 1.5;\n    i : INTEGER;\nEND_VAR\n"
+        "FOR i := 1 TO scale DO\n    total := total + 1;\nEND_FOR\n"
+        "IF (total / count * 1.5 = folded + 3) THEN\n    Media := folded + 0.25;\nELSE\n    Media := 0.5;\nEND_IF\n"
+        "END_FUNCTION\n";
+
+    Scanner scanner(code);
+    Parser parser(scanner);
+    auto program = parser.parse();
+    Value result;
+    bool annotated = false;
+    bool folded = false;
+    try {
+        SemanticAnalyzer analyzer;
+        analyzer.analyze(program.get());
+
+        // Slots de globais e locais, e o tipo de cada expressão
+        auto& media = static_cast<Function&>(*program->statements[1]);
+        auto& loop = static_cast<ForStatement&>(*media.body[4]);
+        auto& limit = static_cast<Identifier&>(*loop.endCondition);
+        auto& counter = static_cast<Identifier&>(*loop.initializer->left);
+        annotated = program->globalSlots == 1 && media.frameSlots == 4 &&
+                    limit.storage == Storage::GLOBAL && limit.slot == 0 && limit.type == TypeTable::INTEGER &&
+                    counter.storage == Storage::LOCAL && counter.slot == 3;
+
+        // 7 / 2 é INTEGER: a dobra trunca, como a execução
+        ASTOptimizer optimizer;
+        optimizer.optimize(program.get());
+        auto initializer = nodeAs<Number>(static_cast<VariableDeclaration&>(*media.body[2]).initializer.get());
+        folded = initializer && initializer->value == 4.5 && initializer->type == TypeTable::REAL;
+
+        Interpreter interpreter;
+        result = interpreter.run(*program, "Media");
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Erro na execução tipada: " << e.what() << std::endl;
+        return;
+    }
+
+    if (annotated && folded && result.getType() == Value::Type::REAL && result.getRealValue() == 4.75) {
+        std::cout << "Execução com tipos e slots anotados correta." << std::endl;
+    } else {
+        std::cerr << "Erro na execução tipada: resultado " << result.toString() << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // "--bench [filtro]" executa os benchmarks em vez dos testes
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        runBenchmarks(argc > 2 ? argv[2] : "");
+        return 0;
+    }
+    testScannerLineNumbers();
+    testLiteralDecoding();
+    testParallelParser();
+    testIncrementalParser();
+    testAstCache();
+    testFlatAst();
+    testNodeKinds();
+    testOperatorPrecedence();
+    testParserRecovery();
+    testTypeTable();
+    testSymbolTable();
+    testParallelAnalysis();
+    testIncrementalAnalysis();
+    testTypedExecution();
+    testIntegralRealLiterals();
+    testConstantFolding();
+    testDeadCodeElimination();
+    testAlgebraicSimplification();
+    testCommonSubexpressions();
+    testFunctionCalls();
     testParser();
     return 0;
 }
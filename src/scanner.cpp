@@ -1,112 +1,119 @@
 // scanner.cpp
 
 #include "scanner.hpp"
+#include "keywords.hpp"
+#include "scanner_simd.hpp"
 #include <cctype>
-#include <unordered_map>
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include <limits>
 #include <stdexcept>
+#include <string>
 
-Scanner::Scanner(const std::string& source) : source(source) {}
+Scanner::Scanner(std::string_view source, int firstLine) : source(source), line(firstLine) {}
 
 std::vector<Token> Scanner::scanTokens() {
-    while (!isAtEnd()) {
-        start = current;
-        scanToken();
-    }
-    tokens.emplace_back(TokenType::EOF_TOKEN, "", line);
+    std::vector<Token> tokens;
+    do {
+        tokens.push_back(nextToken());
+    } while (tokens.back().type != TokenType::EOF_TOKEN);
     return tokens;
 }
 
-void Scanner::scanToken() {
+TokenBuffer Scanner::scanBuffer() {
+    TokenBuffer buffer(source);
+    Token token;
+    do {
+        token = nextToken();
+        buffer.push(token);
+    } while (token.type != TokenType::EOF_TOKEN);
+    return buffer;
+}
+
+Token Scanner::nextToken() {
     skipWhitespaceAndComments();
-    if (isAtEnd()) return;
 
+    // O lexema começa depois dos espaços e comentários ignorados
+    start = current;
+    if (isAtEnd()) {
+        return makeToken(TokenType::EOF_TOKEN); // Lexema vazio no fim do fonte
+    }
+    return scanToken();
+}
+
+Token Scanner::scanToken() {
     char c = advance();
 
     if (std::isalpha(c) || c == '_') {
-        if (c == 'T' && peek() == '#') {
-            advance(); // Consome '#'
-            timeLiteral();
+        if ((c == 'T' || c == 't') && matchTimePrefix()) {
+            return timeLiteral();
         } else {
-            identifier();
+            return identifier();
         }
     } else if (std::isdigit(c)) {
-        number();
+        return number();
     } else {
         switch (c) {
             case '+':
-                addToken(TokenType::PLUS);
-                break;
+                return makeToken(TokenType::PLUS);
             case '-':
-                addToken(TokenType::MINUS);
-                break;
+                return makeToken(TokenType::MINUS);
             case '*':
-                addToken(TokenType::STAR);
-                break;
+                return makeToken(TokenType::STAR);
             case '/':
-                addToken(TokenType::SLASH);
-                break;
+                return makeToken(TokenType::SLASH);
             case '(':
-                addToken(TokenType::LEFT_PAREN);
-                break;
+                return makeToken(TokenType::LEFT_PAREN);
             case ')':
-                addToken(TokenType::RIGHT_PAREN);
-                break;
+                return makeToken(TokenType::RIGHT_PAREN);
             case '{':
-                addToken(TokenType::LEFT_BRACE);
-                break;
+                return makeToken(TokenType::LEFT_BRACE);
             case '}':
-                addToken(TokenType::RIGHT_BRACE);
-                break;
+                return makeToken(TokenType::RIGHT_BRACE);
             case '[':
-                addToken(TokenType::LEFT_BRACKET);
-                break;
+                return makeToken(TokenType::LEFT_BRACKET);
             case ']':
-                addToken(TokenType::RIGHT_BRACKET);
-                break;
+                return makeToken(TokenType::RIGHT_BRACKET);
             case ',':
-                addToken(TokenType::COMMA);
-                break;
+                return makeToken(TokenType::COMMA);
             case ';':
-                addToken(TokenType::SEMICOLON);
-                break;
+                return makeToken(TokenType::SEMICOLON);
             case ':':
                 if (match('=')) {
-                    addToken(TokenType::ASSIGNMENT);
+                    return makeToken(TokenType::ASSIGNMENT);
                 } else {
-                    addToken(TokenType::COLON);
+                    return makeToken(TokenType::COLON);
                 }
-                break;
             case '<':
                 if (match('=')) {
-                    addToken(TokenType::LESS_EQUAL);
+                    return makeToken(TokenType::LESS_EQUAL);
                 } else {
-                    addToken(TokenType::LESS);
+                    return makeToken(TokenType::LESS);
                 }
-                break;
             case '>':
                 if (match('=')) {
-                    addToken(TokenType::GREATER_EQUAL);
+                    return makeToken(TokenType::GREATER_EQUAL);
                 } else {
-                    addToken(TokenType::GREATER);
+                    return makeToken(TokenType::GREATER);
                 }
-                break;
             case '=':
-                addToken(TokenType::EQUAL_EQUAL); // Reconhece '=' como EQUAL_EQUAL
-                break;
+                if (match('>')) {
+                    return makeToken(TokenType::OUTPUT_ASSIGNMENT);
+                }
+                return makeToken(TokenType::EQUAL_EQUAL); // Reconhece '=' como EQUAL_EQUAL
             case '!':
                 if (match('=')) {
-                    addToken(TokenType::NOT_EQUAL);
+                    return makeToken(TokenType::NOT_EQUAL);
                 } else {
                     throw std::runtime_error("Caractere inesperado '!' na linha " + std::to_string(line));
                 }
-                break;
             case '.':
                 if (match('.')) {
-                    addToken(TokenType::DOT_DOT);
+                    return makeToken(TokenType::DOT_DOT);
                 } else {
-                    addToken(TokenType::DOT);
+                    return makeToken(TokenType::DOT);
                 }
-                break;
             default:
                 throw std::runtime_error("Caractere não reconhecido: '" + std::string(1, c) + "' na linha " + std::to_string(line));
         }
@@ -114,26 +121,18 @@ void Scanner::scanToken() {
 }
 
 void Scanner::skipWhitespaceAndComments() {
-    while (!isAtEnd()) {
-        char c = peek();
-        if (c == ' ' || c == '\r' || c == '\t') {
-            advance();
-        } else if (c == '\n') {
-            line++;
-            advance();
-        } else if (c == '(' && peekNext() == '*') {
-            // Comentário de múltiplas linhas
-            advance(); // Consome '('
-            advance(); // Consome '*'
-            while (!isAtEnd() && !(peek() == '*' && peekNext() == ')')) {
-                if (peek() == '\n') line++;
-                advance();
-            }
-            if (isAtEnd()) {
+    const char* data = source.data();
+    size_t end = source.length();
+    while (true) {
+        current = simd_scan::skipBlanks(data, current, end, line);
+        if (current + 1 < end && data[current] == '(' && data[current + 1] == '*') {
+            // Comentário de múltiplas linhas: procura o "*)" de fechamento
+            size_t close = simd_scan::findCommentEnd(data, current + 2, end, line);
+            if (close >= end) {
+                current = end; // O resto do fonte faz parte do comentário
                 throw std::runtime_error("Comentário não fechado antes do fim do arquivo.");
             }
-            advance(); // Consome '*'
-            advance(); // Consome ')'
+            current = close + 2;
         } else {
             break;
         }
@@ -165,102 +164,143 @@ char Scanner::peekNext() const {
     return source[current + 1];
 }
 
-void Scanner::addToken(TokenType type) {
-    addToken(type, "");
+Token Scanner::makeToken(TokenType type) const {
+    return Token(type, source.substr(start, current - start), line);
 }
 
-void Scanner::addToken(TokenType type, const std::string& text) {
-    std::string lexeme = source.substr(start, current - start);
-    tokens.emplace_back(type, lexeme, line);
-}
-
-void Scanner::identifier() {
+Token Scanner::identifier() {
     while (std::isalnum(peek()) || peek() == '_') advance();
 
-    std::string text = source.substr(start, current - start);
-
-    // Converte para maiúsculas para tornar a linguagem case-insensitive
-    std::string upperText;
-    for (char c : text) {
-        upperText += std::toupper(c);
-    }
-
-    static std::unordered_map<std::string, TokenType> keywords = {
-        {"VAR", TokenType::VAR},
-        {"VAR_INPUT", TokenType::VAR_INPUT},
-        {"VAR_OUTPUT", TokenType::VAR_OUTPUT},
-        {"END_VAR", TokenType::END_VAR},
-        {"FUNCTION", TokenType::FUNCTION},
-        {"END_FUNCTION", TokenType::END_FUNCTION},
-        {"FUNCTION_BLOCK", TokenType::FUNCTION_BLOCK},
-        {"END_FUNCTION_BLOCK", TokenType::END_FUNCTION_BLOCK},
-        {"PROGRAM", TokenType::PROGRAM},
-        {"END_PROGRAM", TokenType::END_PROGRAM},
-        {"IF", TokenType::IF},
-        {"THEN", TokenType::THEN},
-        {"ELSE", TokenType::ELSE},
-        {"ELSIF", TokenType::ELSIF},
-        {"END_IF", TokenType::END_IF},
-        {"WHILE", TokenType::WHILE},
-        {"DO", TokenType::DO},
-        {"END_WHILE", TokenType::END_WHILE},
-        {"FOR", TokenType::FOR},
-        {"TO", TokenType::TO},
-        {"END_FOR", TokenType::END_FOR},
-        {"RETURN", TokenType::RETURN},
-        {"ARRAY", TokenType::ARRAY},
-        {"OF", TokenType::OF},
-        {"AND", TokenType::AND},
-        {"OR", TokenType::OR},
-        {"NOT", TokenType::NOT},
-        {"TRUE", TokenType::TRUE},
-        {"FALSE", TokenType::FALSE},
-        // Tipos
-        {"INTEGER", TokenType::INTEGER},
-        {"REAL", TokenType::REAL},
-        {"BOOLEAN", TokenType::BOOLEAN},
-    };
-
-    TokenType type = TokenType::IDENTIFIER;
-    auto it = keywords.find(upperText);
-    if (it != keywords.end()) {
-        type = it->second;
-    }
-    addToken(type, text);
+    // Palavras-chave são reconhecidas por hash perfeito, sem converter o texto
+    return makeToken(lookupKeyword(source.substr(start, current - start)));
 }
 
-void Scanner::number() {
+Token Scanner::number() {
+    bool isReal = false;
     while (std::isdigit(peek())) advance();
 
     // Verifica por parte fracionária
     if (peek() == '.' && std::isdigit(peekNext())) {
+        isReal = true;
         advance(); // Consome o '.'
         while (std::isdigit(peek())) advance();
     }
 
-    std::string text = source.substr(start, current - start);
-    addToken(TokenType::NUMBER, text);
+    // O valor é decodificado aqui; as fases seguintes não voltam a ler o texto
+    Token token = makeToken(TokenType::NUMBER);
+    const char* first = token.lexeme.data();
+    const char* last = first + token.lexeme.size();
+    std::from_chars_result result;
+    if (isReal) {
+        token.literal = LiteralKind::REAL;
+        result = std::from_chars(first, last, token.realValue);
+    } else {
+        token.literal = LiteralKind::INTEGER;
+        result = std::from_chars(first, last, token.intValue);
+    }
+    if (result.ec != std::errc()) {
+        throw std::runtime_error("Literal numérico fora do intervalo '" + std::string(token.lexeme) +
+                                 "' na linha " + std::to_string(line));
+    }
+    return token;
 }
 
-void Scanner::timeLiteral() {
-    // Exemplo: T#5S
-
-    // Captura o número após 'T#'
-    std::string value;
-    while (std::isdigit(peek())) {
-        value += advance();
+bool Scanner::matchTimePrefix() {
+    // Prefixos T# e TIME#, sem distinção de maiúsculas
+    for (std::string_view prefix : {std::string_view("T#"), std::string_view("TIME#")}) {
+        if (source.size() - start < prefix.size()) continue;
+        std::string_view text = source.substr(start, prefix.size());
+        bool equal = true;
+        for (size_t i = 0; i < prefix.size() && equal; i++) {
+            equal = keyword_detail::toUpperAscii(text[i]) == prefix[i];
+        }
+        if (equal) {
+            current = start + prefix.size();
+            return true;
+        }
     }
+    return false;
+}
 
-    // Captura a unidade de tempo (S, M, H, etc.)
-    std::string unit;
-    while (std::isalpha(peek())) {
-        unit += advance();
-    }
+Token Scanner::timeLiteral() {
+    // Sintaxe IEC 61131-3: T#[-]<n>d<n>h<n>m<n>s<n>ms<n>us<n>ns, com as unidades em
+    // ordem decrescente, '_' opcional entre componentes e fração apenas no último
+    // componente. Exemplos: T#5S, T#1h2m3s500ms, TIME#1.5s, t#25h_15m, T#-250ms
+    struct Unit {
+        std::string_view name;
+        int64_t nanoseconds;
+    };
+    static constexpr Unit units[] = {
+        {"D", 86'400'000'000'000},
+        {"H", 3'600'000'000'000},
+        {"M", 60'000'000'000},
+        {"S", 1'000'000'000},
+        {"MS", 1'000'000},
+        {"US", 1'000},
+        {"NS", 1},
+    };
+    constexpr int64_t maxDuration = std::numeric_limits<int64_t>::max();
+    auto invalid = [this]() {
+        return std::runtime_error("Literal de tempo inválido na linha " + std::to_string(line));
+    };
 
-    if (value.empty() || unit.empty()) {
-        throw std::runtime_error("Literal de tempo inválido na linha " + std::to_string(line));
-    }
+    bool negative = match('-');
+    int64_t total = 0;
+    int lastUnit = -1;
+    bool fractional = false;
+
+    do {
+        if (!std::isdigit(peek()) || fractional) throw invalid();
+
+        // Valor do componente (inteiro ou decimal)
+        size_t valueStart = current;
+        while (std::isdigit(peek())) advance();
+        if (peek() == '.' && std::isdigit(peekNext())) {
+            fractional = true;
+            advance(); // Consome o '.'
+            while (std::isdigit(peek())) advance();
+        }
+        std::string_view value = source.substr(valueStart, current - valueStart);
+
+        // Unidade do componente
+        size_t unitStart = current;
+        while (std::isalpha(peek())) advance();
+        std::string_view unitText = source.substr(unitStart, current - unitStart);
+        int unit = -1;
+        for (int i = 0; i < static_cast<int>(std::size(units)); i++) {
+            if (units[i].name.size() != unitText.size()) continue;
+            bool equal = true;
+            for (size_t j = 0; j < unitText.size() && equal; j++) {
+                equal = keyword_detail::toUpperAscii(unitText[j]) == units[i].name[j];
+            }
+            if (equal) {
+                unit = i;
+                break;
+            }
+        }
+        if (unit <= lastUnit) throw invalid();
+        lastUnit = unit;
+
+        int64_t component = 0;
+        if (fractional) {
+            double amount = 0;
+            std::from_chars(value.data(), value.data() + value.size(), amount);
+            double nanoseconds = amount * static_cast<double>(units[unit].nanoseconds);
+            if (nanoseconds >= static_cast<double>(maxDuration)) throw invalid();
+            component = std::llround(nanoseconds);
+        } else {
+            int64_t amount = 0;
+            auto result = std::from_chars(value.data(), value.data() + value.size(), amount);
+            if (result.ec != std::errc() || amount > maxDuration / units[unit].nanoseconds) throw invalid();
+            component = amount * units[unit].nanoseconds;
+        }
+        if (component > maxDuration - total) throw invalid();
+        total += component;
+    } while (match('_') || std::isdigit(peek()));
 
-    std::string lexeme = "T#" + value + unit;
-    addToken(TokenType::TIME_LITERAL, lexeme);
+    // O lexema ("T#1h2m3s500ms") já é contíguo no fonte
+    Token token = makeToken(TokenType::TIME_LITERAL);
+    token.literal = LiteralKind::DURATION;
+    token.durationNs = negative ? -total : total;
+    return token;
 }
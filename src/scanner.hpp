@@ -3,35 +3,49 @@
 #ifndef SCANNER_HPP
 #define SCANNER_HPP
 
-#include <string>
+#include <string_view>
 #include <vector>
 #include "token.hpp"
+#include "token_buffer.hpp"
 
+// O Scanner não copia o código-fonte: os lexemas dos tokens são visões sobre
+// 'source'. Para arquivos, use um SourceFile (mapeado em memória) como origem.
 class Scanner {
 public:
-    Scanner(const std::string& source);
+    // 'firstLine' permite escanear um trecho de um arquivo maior mantendo as linhas corretas
+    Scanner(std::string_view source, int firstLine = 1);
 
+    // Lê todos os tokens de uma vez (o último é sempre EOF_TOKEN)
     std::vector<Token> scanTokens();
 
+    // Lê todos os tokens para um buffer compacto (estrutura de arrays)
+    TokenBuffer scanBuffer();
+
+    // Produz o próximo token sob demanda; no fim do fonte retorna EOF_TOKEN
+    // indefinidamente. Permite que o Parser consuma o fonte em fluxo.
+    Token nextToken();
+
+    // Linha atual da leitura (usada para localizar erros léxicos)
+    int lineNumber() const { return line; }
+
 private:
-    std::string source;
-    std::vector<Token> tokens;
+    std::string_view source;
     size_t start = 0;
     size_t current = 0;
     int line = 1;
 
     bool isAtEnd() const;
-    void scanToken();
+    Token scanToken();
     char advance();
     bool match(char expected);
     char peek() const;
     char peekNext() const;
-    void addToken(TokenType type);
-    void addToken(TokenType type, const std::string& text);
-    void identifier();
-    void number();
+    Token makeToken(TokenType type) const;
+    Token identifier();
+    Token number();
     void skipWhitespaceAndComments();
-    void timeLiteral();
+    bool matchTimePrefix();
+    Token timeLiteral();
 };
 
 #endif // SCANNER_HPP
@@ -0,0 +1,130 @@
+// scanner_simd.hpp
+
+#ifndef SCANNER_SIMD_HPP
+#define SCANNER_SIMD_HPP
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Varredura vetorizada de espaços e comentários para o Scanner.
+// Usa AVX2 (32 bytes) ou SSE2 (16 bytes) conforme as flags de compilação, e cai
+// para a versão escalar no final do buffer ou em arquiteturas sem SIMD.
+// Todas as funções somam a 'line' as quebras de linha consumidas.
+namespace simd_scan {
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Retorna a posição do primeiro caractere não branco em [pos, end)
+inline size_t skipBlanksScalar(const char* data, size_t pos, size_t end, int& line) {
+    while (pos < end && isBlank(data[pos])) {
+        if (data[pos] == '\n') line++;
+        pos++;
+    }
+    return pos;
+}
+
+// Retorna a posição do '*' que fecha o comentário ("*)"), ou 'end' se não houver
+inline size_t findCommentEndScalar(const char* data, size_t pos, size_t end, int& line) {
+    while (pos < end) {
+        if (data[pos] == '*' && pos + 1 < end && data[pos + 1] == ')') return pos;
+        if (data[pos] == '\n') line++;
+        pos++;
+    }
+    return end;
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+// Bloco de bytes carregado do fonte; eq() devolve uma máscara com um bit por byte igual a 'c'
+#if defined(__AVX2__)
+inline constexpr const char* VARIANT = "AVX2";
+
+struct Chunk {
+    static constexpr size_t WIDTH = 32;
+    __m256i bytes;
+
+    explicit Chunk(const char* ptr) : bytes(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr))) {}
+
+    uint32_t eq(char c) const {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(c))));
+    }
+};
+#else
+inline constexpr const char* VARIANT = "SSE2";
+
+struct Chunk {
+    static constexpr size_t WIDTH = 16;
+    __m128i bytes;
+
+    explicit Chunk(const char* ptr) : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr))) {}
+
+    uint32_t eq(char c) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(c))));
+    }
+};
+#endif
+
+inline constexpr uint32_t FULL_MASK = Chunk::WIDTH == 32 ? 0xFFFFFFFFu : 0xFFFFu;
+
+// Bits abaixo de 'count' (count < 32)
+inline uint32_t maskBelow(uint32_t count) {
+    return (uint32_t(1) << count) - 1;
+}
+
+inline size_t skipBlanks(const char* data, size_t pos, size_t end, int& line) {
+    while (pos + Chunk::WIDTH <= end) {
+        Chunk chunk(data + pos);
+        uint32_t newlines = chunk.eq('\n');
+        uint32_t blanks = chunk.eq(' ') | chunk.eq('\t') | chunk.eq('\r') | newlines;
+        if (blanks != FULL_MASK) {
+            uint32_t stop = std::countr_zero(~blanks);
+            line += std::popcount(newlines & maskBelow(stop));
+            return pos + stop;
+        }
+        line += std::popcount(newlines);
+        pos += Chunk::WIDTH;
+    }
+    return skipBlanksScalar(data, pos, end, line);
+}
+
+inline size_t findCommentEnd(const char* data, size_t pos, size_t end, int& line) {
+    // O ')' é lido com um byte de deslocamento, por isso o bloco precisa de WIDTH + 1 bytes
+    while (pos + Chunk::WIDTH + 1 <= end) {
+        Chunk chunk(data + pos);
+        uint32_t closers = chunk.eq('*') & Chunk(data + pos + 1).eq(')');
+        uint32_t newlines = chunk.eq('\n');
+        if (closers != 0) {
+            uint32_t stop = std::countr_zero(closers);
+            line += std::popcount(newlines & maskBelow(stop));
+            return pos + stop;
+        }
+        line += std::popcount(newlines);
+        pos += Chunk::WIDTH;
+    }
+    return findCommentEndScalar(data, pos, end, line);
+}
+
+#else
+
+inline constexpr const char* VARIANT = "escalar";
+
+inline size_t skipBlanks(const char* data, size_t pos, size_t end, int& line) {
+    return skipBlanksScalar(data, pos, end, line);
+}
+
+inline size_t findCommentEnd(const char* data, size_t pos, size_t end, int& line) {
+    return findCommentEndScalar(data, pos, end, line);
+}
+
+#endif
+
+} // namespace simd_scan
+
+#endif // SCANNER_SIMD_HPP
@@ -1,63 +1,457 @@
 // semantic_analyzer.cpp
 
 #include "semantic_analyzer.hpp"
-#include <stdexcept>
-#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <iostream>
+#include <stdexcept>
+#include <thread>
 #include "operator_type.hpp"
 #include "value.hpp" // Adicionado
 
+namespace {
+
+// POUs mínimas por thread na segunda fase
+constexpr size_t POUS_PER_THREAD = 64;
+
+// Combina 'value' na impressão digital 'hash' (mesma mistura de hashSource)
+uint64_t mix(uint64_t hash, uint64_t value) {
+    hash = (hash ^ value) * 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 29);
+}
+
+// Bit de um nome no filtro UnitRecord::names. Ignora maiúsculas e minúsculas
+// (como os nomes de tipos): para símbolos só gera falsos positivos
+uint64_t nameBit(std::string_view name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c)) * 1099511628211ull;
+    }
+    return uint64_t{1} << (hash >> 58);
+}
+
+} // namespace
+
 SemanticAnalyzer::SemanticAnalyzer() {}
 
+SemanticAnalyzer::SemanticAnalyzer(const SemanticAnalyzer* global)
+    : global(global), debug(global->debug) {}
+
+void SemanticAnalyzer::setThreadCount(unsigned count) {
+    threadCount = count;
+}
+
+void SemanticAnalyzer::setIncremental(bool value) {
+    incremental = value;
+    records.clear();
+    globalFingerprint = 0;
+    retained.reset();
+}
+
 void SemanticAnalyzer::analyze(Program* program) {
     program->accept(*this);
+    if (!diagnostics.empty()) {
+        throw std::runtime_error(diagnostics.front().message);
+    }
+}
+
+TypeId SemanticAnalyzer::typeOf(Expression& expression) {
+    expression.accept(*this);
+    expression.type = resultType;
+    return resultType;
+}
+
+const Symbol* SemanticAnalyzer::resolve(std::string_view name) const {
+    if (const Symbol* symbol = symbolTable.resolve(name)) {
+        return symbol;
+    }
+    if (!global) {
+        return nullptr;
+    }
+    if (lookups) {
+        lookups->push_back({false, name});
+    }
+    return global->symbolTable.resolve(name);
+}
+
+Function* SemanticAnalyzer::pouOf(const Symbol& symbol) const {
+    return (global ? global->pous : pous)[symbol.slot];
+}
+
+Function* SemanticAnalyzer::blockOf(TypeId type) const {
+    if (typeTable().kind(type) != TypeKind::FUNCTION_BLOCK) {
+        return nullptr;
+    }
+    const auto& blocks = global ? global->functionBlocks : functionBlocks;
+    auto it = blocks.find(type);
+    return it == blocks.end() ? nullptr : it->second;
+}
+
+TypeId SemanticAnalyzer::declaredType(std::string_view name) {
+    if (!global) {
+        return types.named(name);
+    }
+    if (lookups) {
+        lookups->push_back({true, name});
+    }
+    return global->types.find(name);
+}
+
+TypeId SemanticAnalyzer::declaredArray(TypeId element, std::span<const std::pair<int, int>> dimensions) {
+    return global ? global->types.findArray(element, dimensions) : types.arrayOf(element, dimensions);
+}
+
+uint32_t SemanticAnalyzer::defineVariable(std::string_view name, TypeId type, SymbolType symbolType) {
+    Symbol& symbol = symbolTable.define(name, type, symbolType);
+    if (insideFunction) {
+        symbol.storage = Storage::LOCAL;
+        symbol.slot = nextLocalSlot++;
+    } else {
+        symbol.storage = Storage::GLOBAL;
+        symbol.slot = nextGlobalSlot++;
+    }
+    return symbol.slot;
 }
 
 void SemanticAnalyzer::visitProgram(Program& program) {
-    for (auto& stmt : program.statements) {
-        stmt->accept(*this);
+    diagnostics.clear();
+    nextGlobalSlot = 0;
+    // O escopo global é refeito a cada análise; a tabela de tipos é mantida
+    // (os TypeIds anotados nas POUs reaproveitadas continuam valendo)
+    symbolTable.clear();
+    types.resetFunctionBlocks();
+    pous.clear();
+    functionBlocks.clear();
+    auto& statements = program.statements;
+    std::vector<StatementError> errors; // Só as declarações de nível superior com erro
+
+    // Fase 1a: POUs e blocos funcionais, antes de tudo que possa usá-los.
+    // Os tipos locais de uma POU já verificada antes já estão na tabela
+    std::vector<uint32_t> functions; // Índices em 'statements'
+    for (size_t i = 0; i < statements.size(); i++) {
+        if (auto function = nodeAs<Function>(statements[i].get())) {
+            try {
+                declareFunction(*function, !(incremental && records.contains(function)));
+                functions.push_back(static_cast<uint32_t>(i));
+            } catch (const std::runtime_error& e) {
+                errors.emplace_back(i, e.what());
+            }
+        }
+    }
+
+    // Fase 1b: VAR_GLOBAL (chega como um bloco de declarações) e comandos soltos, no escopo global
+    for (size_t i = 0; i < statements.size(); i++) {
+        Statement* stmt = statements[i].get();
+        if (nodeAs<Function>(stmt)) {
+            continue;
+        }
+        try {
+            if (auto globals = nodeAs<BlockStatement>(stmt)) {
+                for (auto& decl : globals->statements) {
+                    decl->accept(*this);
+                }
+            } else {
+                stmt->accept(*this);
+            }
+        } catch (const std::runtime_error& e) {
+            errors.emplace_back(i, e.what());
+        }
+    }
+    program.globalSlots = nextGlobalSlot;
+
+    // Fase 2: corpos das POUs, com as tabelas globais congeladas
+    if (incremental) {
+        checkChangedFunctions(program, functions, errors);
+    } else {
+        checkFunctions(program, functions, errors, nullptr);
+        checked = functions.size();
+        reused = 0;
+    }
+
+    // Cada declaração tem no máximo um erro, citado na linha onde ela começa;
+    // a ordem do fonte não depende das threads
+    std::sort(errors.begin(), errors.end(),
+              [](const StatementError& a, const StatementError& b) { return a.first < b.first; });
+    for (auto& error : errors) {
+        diagnostics.push_back({statements[error.first]->line, std::move(error.second)});
+    }
+}
+
+void SemanticAnalyzer::checkChangedFunctions(Program& program, const std::vector<uint32_t>& functions, std::vector<StatementError>& errors) {
+    // Se nenhuma assinatura do escopo global mudou, só falta saber quais nomes
+    // passaram a ser outro nó Function: POUs novas ou editadas e as instâncias
+    // globais de blocos funcionais editados
+    uint64_t fingerprint = scopeFingerprint();
+    bool scopeChanged = fingerprint != globalFingerprint;
+    globalFingerprint = fingerprint;
+    uint64_t replaced = 0;
+    for (const Function* function : pous) {
+        if (!records.contains(function)) {
+            replaced |= nameBit(function->name);
+        }
+    }
+    for (const Symbol& symbol : symbolTable.entries()) {
+        const Function* block = symbol.symbolType == SymbolType::VARIABLE ? blockOf(symbol.type) : nullptr;
+        if (block && !records.contains(block)) {
+            replaced |= nameBit(symbolTable.name(symbol.name));
+        }
+    }
+
+    std::vector<uint32_t> toCheck;
+    std::unordered_map<const Function*, UnitRecord> current;
+    for (uint32_t statement : functions) {
+        auto function = static_cast<const Function*>(program.statements[statement].get());
+        auto record = records.find(function);
+        if (record == records.end() ||
+            ((scopeChanged || (record->second.names & replaced) != 0) && dependenciesChanged(record->second))) {
+            toCheck.push_back(statement);
+            continue;
+        }
+        if (!record->second.error.empty()) {
+            errors.emplace_back(statement, record->second.error);
+        }
+        current.emplace(function, std::move(record->second));
+    }
+
+    std::vector<UnitRecord> results(toCheck.size());
+    checkFunctions(program, toCheck, errors, &results);
+    for (size_t i = 0; i < toCheck.size(); i++) {
+        current.emplace(static_cast<const Function*>(program.statements[toCheck[i]].get()), std::move(results[i]));
+    }
+
+    checked = toCheck.size();
+    reused = functions.size() - toCheck.size();
+    records = std::move(current);
+    // Os registros são indexados pelo endereço dos nós: eles não podem ser
+    // liberados (e o endereço reaproveitado por outro nó) enquanto houver registro
+    retained = std::make_unique<Program>(std::make_shared<AstArena>());
+    retained->adoptArenas(program);
+}
+
+uint64_t SemanticAnalyzer::signatureFingerprint(const Symbol& symbol) const {
+    uint64_t hash = mix(mix(mix(1, static_cast<uint64_t>(symbol.symbolType)), symbol.type),
+                        static_cast<uint64_t>(types.kind(symbol.type)));
+    // O índice de uma POU (slot) não importa
+    if (symbol.symbolType != SymbolType::FUNCTION && symbol.symbolType != SymbolType::FUNCTION_BLOCK) {
+        hash = mix(mix(hash, static_cast<uint64_t>(symbol.storage)), symbol.slot);
+    }
+    for (const Parameter& parameter : symbolTable.parameters(symbol)) {
+        hash = mix(mix(mix(mix(hash, parameter.name), parameter.type), static_cast<uint64_t>(parameter.section)), parameter.slot);
+    }
+    return hash;
+}
+
+uint64_t SemanticAnalyzer::symbolFingerprint(const Symbol& symbol) const {
+    // As chamadas guardam o nó Function chamado: uma POU editada (outro nó) muda
+    // o que o nome significa, mesmo com a mesma assinatura
+    const Function* node = symbol.symbolType == SymbolType::FUNCTION || symbol.symbolType == SymbolType::FUNCTION_BLOCK
+                               ? pous[symbol.slot]
+                               : blockOf(symbol.type);
+    return mix(signatureFingerprint(symbol), reinterpret_cast<uintptr_t>(node));
+}
+
+uint64_t SemanticAnalyzer::symbolFingerprint(std::string_view name) const {
+    const Symbol* symbol = symbolTable.resolve(name);
+    return symbol ? symbolFingerprint(*symbol) : 0;
+}
+
+uint64_t SemanticAnalyzer::typeFingerprint(std::string_view name) const {
+    TypeId type = types.find(name);
+    if (type == NO_TYPE) {
+        return 0;
+    }
+    return mix(mix(mix(1, type), static_cast<uint64_t>(types.kind(type))), reinterpret_cast<uintptr_t>(blockOf(type)));
+}
+
+uint64_t SemanticAnalyzer::scopeFingerprint() const {
+    uint64_t hash = 0;
+    for (const Symbol& symbol : symbolTable.entries()) {
+        hash = mix(mix(hash, symbol.name), signatureFingerprint(symbol));
+    }
+    // Tipos nunca são removidos, mas um nome pode deixar de ser bloco funcional
+    for (TypeId type = 0; type < types.size(); type++) {
+        hash = mix(hash, static_cast<uint64_t>(types.kind(type)));
+    }
+    return hash;
+}
+
+bool SemanticAnalyzer::dependenciesChanged(const UnitRecord& record) const {
+    for (const Dependency& dependency : record.dependencies) {
+        uint64_t now = dependency.isType ? typeFingerprint(dependency.name) : symbolFingerprint(dependency.name);
+        if (now != dependency.fingerprint) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<SemanticAnalyzer::Dependency> SemanticAnalyzer::dependenciesOf(std::vector<Lookup>& unitLookups) const {
+    std::sort(unitLookups.begin(), unitLookups.end());
+    unitLookups.erase(std::unique(unitLookups.begin(), unitLookups.end()), unitLookups.end());
+    std::vector<Dependency> dependencies;
+    dependencies.reserve(unitLookups.size());
+    for (const Lookup& lookup : unitLookups) {
+        uint64_t fingerprint = lookup.isType ? typeFingerprint(lookup.name) : symbolFingerprint(lookup.name);
+        dependencies.push_back({lookup.isType, std::string(lookup.name), fingerprint});
+    }
+    return dependencies;
+}
+
+void SemanticAnalyzer::checkFunctions(Program& program, const std::vector<uint32_t>& functions, std::vector<StatementError>& errors,
+                                      std::vector<UnitRecord>* results) {
+    unsigned threads = threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+    // Programas pequenos não compensam o custo de criar threads
+    size_t workerCount = std::min(static_cast<size_t>(threads), (functions.size() + POUS_PER_THREAD - 1) / POUS_PER_THREAD);
+    workerCount = std::max<size_t>(workerCount, 1);
+    std::vector<std::vector<StatementError>> workerErrors(workerCount);
+    std::vector<std::exception_ptr> failures(workerCount);
+    std::atomic<size_t> next{0};
+
+    auto worker = [&](size_t id) {
+        SemanticAnalyzer analyzer(this);
+        std::vector<Lookup> unitLookups;
+        if (results) {
+            analyzer.lookups = &unitLookups;
+        }
+        for (size_t f = next++; f < functions.size(); f = next++) {
+            uint32_t statement = functions[f];
+            try {
+                analyzer.checkFunction(static_cast<Function&>(*program.statements[statement]));
+            } catch (const std::runtime_error& e) {
+                workerErrors[id].emplace_back(statement, e.what());
+                analyzer.symbolTable = SymbolTable(); // Descarta os escopos deixados abertos
+                if (results) {
+                    (*results)[f].error = e.what();
+                }
+            } catch (...) {
+                failures[id] = std::current_exception();
+                return;
+            }
+            if (results) {
+                // As tabelas globais só são lidas nesta fase: calcular as impressões digitais aqui é seguro
+                (*results)[f].dependencies = dependenciesOf(unitLookups);
+                for (const Dependency& dependency : (*results)[f].dependencies) {
+                    (*results)[f].names |= nameBit(dependency.name);
+                }
+                unitLookups.clear();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t id = 1; id < workerCount; id++) {
+        pool.emplace_back(worker, id);
+    }
+    worker(0); // A thread atual também verifica POUs
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    for (size_t id = 0; id < workerCount; id++) {
+        if (failures[id]) {
+            std::rethrow_exception(failures[id]);
+        }
+        errors.insert(errors.end(), workerErrors[id].begin(), workerErrors[id].end());
     }
 }
 
 void SemanticAnalyzer::visitFunction(Function& function) {
+    declareFunction(function);
+    checkFunction(function);
+}
+
+void SemanticAnalyzer::declareFunction(Function& function, bool registerTypes) {
     // Registra a função na tabela de símbolos
-    if (symbolTable.currentScope().find(function.name) != symbolTable.currentScope().end()) {
-        throw std::runtime_error("Função '" + function.name + "' já foi declarada.");
+    if (symbolTable.declaredInCurrentScope(function.name)) {
+        throw std::runtime_error("Função '" + std::string(function.name) + "' já foi declarada.");
     }
-    symbolTable.define(function.name, function.returnType, SymbolType::FUNCTION);
+    Symbol* symbol;
+    if (function.pouKind == PouKind::FUNCTION_BLOCK) {
+        // O nome de um bloco funcional também é um tipo (para as instâncias)
+        TypeId blockType = types.functionBlock(function.name);
+        symbol = &symbolTable.define(function.name, blockType, SymbolType::FUNCTION_BLOCK);
+        functionBlocks[blockType] = &function;
+    } else {
+        symbol = &symbolTable.define(function.name, types.named(function.returnType), SymbolType::FUNCTION);
+    }
+    symbol->slot = static_cast<uint32_t>(pous.size());
+    pous.push_back(&function);
+
+    // Registra a assinatura e os tipos das declarações locais: na segunda fase a
+    // tabela de tipos só é lida. O parser põe as seções de parâmetros antes de VAR
+    // e as declarações antes dos comandos; cada declaração ocupa um slot, em ordem
+    signature.clear();
+    uint32_t slot = 0;
+    for (auto& stmt : function.body) {
+        std::string_view name;
+        VarSection section;
+        TypeId type;
+        if (auto varDecl = nodeAs<VariableDeclaration>(stmt.get())) {
+            if (varDecl->section == VarSection::LOCAL && !registerTypes) {
+                break;
+            }
+            name = varDecl->name;
+            section = varDecl->section;
+            type = types.named(varDecl->type);
+        } else if (auto arrayDecl = nodeAs<ArrayDeclaration>(stmt.get())) {
+            if (arrayDecl->section == VarSection::LOCAL && !registerTypes) {
+                break;
+            }
+            name = arrayDecl->name;
+            section = arrayDecl->section;
+            type = types.arrayOf(types.named(arrayDecl->baseType), arrayDecl->dimensions);
+        } else {
+            break;
+        }
+        if (section != VarSection::LOCAL) {
+            signature.push_back({symbolTable.intern(name), type, section, slot});
+        }
+        slot++;
+    }
+    if (!signature.empty()) {
+        symbolTable.setParameters(*symbol, signature);
+    }
+}
 
+void SemanticAnalyzer::checkFunction(Function& function) {
     symbolTable.enterScope();
-    currentFunctionReturnType = function.returnType;
+    currentFunctionReturnType = declaredType(function.returnType);
+    currentFunctionName = function.name;
+    insideFunction = true;
+    nextLocalSlot = 0;
+    function.frameSlots = 0; // Continua 0 se a verificação parar num erro
 
     for (auto& stmt : function.body) {
         stmt->accept(*this);
     }
 
+    function.frameSlots = nextLocalSlot;
+    currentFunctionName = {};
+    insideFunction = false;
     symbolTable.exitScope();
 }
 
 void SemanticAnalyzer::visitVariableDeclaration(VariableDeclaration& varDecl) {
-    if (symbolTable.currentScope().find(varDecl.name) != symbolTable.currentScope().end()) {
-        throw std::runtime_error("Variável '" + varDecl.name + "' já foi declarada neste escopo.");
+    if (symbolTable.declaredInCurrentScope(varDecl.name)) {
+        throw std::runtime_error("Variável '" + std::string(varDecl.name) + "' já foi declarada neste escopo.");
     }
-    symbolTable.define(varDecl.name, varDecl.type, SymbolType::VARIABLE);
+    TypeId type = declaredType(varDecl.type);
+    varDecl.slot = defineVariable(varDecl.name, type, SymbolType::VARIABLE);
 
     if (varDecl.initializer) {
-        Value initValue = varDecl.initializer->accept(*this);
-        std::string initType = getTypeFromValue(initValue);
-        if (initType != varDecl.type) {
-            throw std::runtime_error("Tipo do inicializador '" + initType + "' não corresponde ao tipo da variável '" + varDecl.type + "'.");
+        TypeId initType = typeOf(*varDecl.initializer);
+        if (initType != type) {
+            throw std::runtime_error("Tipo do inicializador '" + typeTable().toString(initType) + "' não corresponde ao tipo da variável '" + typeTable().toString(type) + "'.");
         }
     }
 }
 
 void SemanticAnalyzer::visitArrayDeclaration(ArrayDeclaration& arrayDecl) {
-    if (symbolTable.currentScope().find(arrayDecl.name) != symbolTable.currentScope().end()) {
-        throw std::runtime_error("Array '" + arrayDecl.name + "' já foi declarado neste escopo.");
+    if (symbolTable.declaredInCurrentScope(arrayDecl.name)) {
+        throw std::runtime_error("Array '" + std::string(arrayDecl.name) + "' já foi declarado neste escopo.");
     }
-    Symbol arraySymbol(arrayDecl.name, arrayDecl.baseType, SymbolType::ARRAY);
-    arraySymbol.dimensions = arrayDecl.dimensions;
-    symbolTable.currentScope()[arrayDecl.name] = arraySymbol;
+    TypeId arrayType = declaredArray(declaredType(arrayDecl.baseType), arrayDecl.dimensions);
+    arrayDecl.slot = defineVariable(arrayDecl.name, arrayType, SymbolType::ARRAY);
 
     if (arrayDecl.initializer) {
         // Implementar verificação de tipos para inicializadores de arrays, se necessário
@@ -65,31 +459,26 @@ void SemanticAnalyzer::visitArrayDeclaration(ArrayDeclaration& arrayDecl) {
 }
 
 void SemanticAnalyzer::visitAssignment(Assignment& assignment) {
-    Value leftValue = assignment.left->accept(*this);
-    Value rightValue = assignment.right->accept(*this);
-
-    std::string leftType = getTypeFromValue(leftValue);
-    std::string rightType = getTypeFromValue(rightValue);
+    TypeId leftType = typeOf(*assignment.left);
+    TypeId rightType = typeOf(*assignment.right);
 
     if (leftType != rightType) {
-        throw std::runtime_error("Tipos incompatíveis na atribuição: '" + leftType + "' e '" + rightType + "'.");
+        throw std::runtime_error("Tipos incompatíveis na atribuição: '" + typeTable().toString(leftType) + "' e '" + typeTable().toString(rightType) + "'.");
     }
 }
 
 void SemanticAnalyzer::visitReturnStatement(ReturnStatement& returnStmt) {
-    Value returnValue = returnStmt.value->accept(*this);
-    std::string returnType = getTypeFromValue(returnValue);
+    TypeId returnType = typeOf(*returnStmt.value);
 
     if (returnType != currentFunctionReturnType) {
-        throw std::runtime_error("Tipo de retorno '" + returnType + "' não corresponde ao tipo de retorno da função '" + currentFunctionReturnType + "'.");
+        throw std::runtime_error("Tipo de retorno '" + typeTable().toString(returnType) + "' não corresponde ao tipo de retorno da função '" + typeTable().toString(currentFunctionReturnType) + "'.");
     }
 }
 
 void SemanticAnalyzer::visitIfStatement(IfStatement& ifStmt) {
-    Value conditionValue = ifStmt.condition->accept(*this);
-    std::string conditionType = getTypeFromValue(conditionValue);
-    if (conditionType != "BOOLEAN") {
-        throw std::runtime_error("A condição do 'IF' deve ser do tipo BOOLEAN, mas obteve '" + conditionType + "'.");
+    TypeId conditionType = typeOf(*ifStmt.condition);
+    if (conditionType != TypeTable::BOOLEAN) {
+        throw std::runtime_error("A condição do 'IF' deve ser do tipo BOOLEAN, mas obteve '" + typeTable().toString(conditionType) + "'.");
     }
 
     symbolTable.enterScope();
@@ -104,10 +493,9 @@ void SemanticAnalyzer::visitIfStatement(IfStatement& ifStmt) {
 }
 
 void SemanticAnalyzer::visitWhileStatement(WhileStatement& whileStmt) {
-    Value conditionValue = whileStmt.condition->accept(*this);
-    std::string conditionType = getTypeFromValue(conditionValue);
-    if (conditionType != "BOOLEAN") {
-        throw std::runtime_error("A condição do 'WHILE' deve ser do tipo BOOLEAN, mas obteve '" + conditionType + "'.");
+    TypeId conditionType = typeOf(*whileStmt.condition);
+    if (conditionType != TypeTable::BOOLEAN) {
+        throw std::runtime_error("A condição do 'WHILE' deve ser do tipo BOOLEAN, mas obteve '" + typeTable().toString(conditionType) + "'.");
     }
 
     symbolTable.enterScope();
@@ -117,8 +505,7 @@ void SemanticAnalyzer::visitWhileStatement(WhileStatement& whileStmt) {
 
 void SemanticAnalyzer::visitForStatement(ForStatement& forStmt) {
     forStmt.initializer->accept(*this);
-    Value conditionValue = forStmt.endCondition->accept(*this);
-    std::string conditionType = getTypeFromValue(conditionValue);
+    typeOf(*forStmt.endCondition);
     // Verificação adicional do tipo da condição, se necessário
 
     forStmt.body->accept(*this);
@@ -133,61 +520,58 @@ void SemanticAnalyzer::visitBlockStatement(BlockStatement& blockStmt) {
 }
 
 void SemanticAnalyzer::visitExpressionStatement(ExpressionStatement& exprStmt) {
-    exprStmt.expression->accept(*this);
+    typeOf(*exprStmt.expression);
 }
 
 Value SemanticAnalyzer::visitIdentifier(Identifier& identifier) {
-    auto symbol = symbolTable.resolve(identifier.name);
+    auto symbol = resolve(identifier.name);
     if (!symbol) {
-        throw std::runtime_error("Variável ou função '" + identifier.name + "' não foi declarada.");
-    }
-    // Retorna um Value correspondente ao tipo do símbolo
-    if (symbol->type == "INTEGER") {
-        return Value(0);
-    } else if (symbol->type == "REAL") {
-        return Value(0.0);
-    } else if (symbol->type == "BOOLEAN") {
-        return Value(true);
+        throw std::runtime_error("Variável ou função '" + std::string(identifier.name) + "' não foi declarada.");
+    }
+    // Variáveis de tipo ainda desconhecido (nem primitivo, nem array, nem bloco funcional)
+    if (typeTable().kind(symbol->type) == TypeKind::USER) {
+        throw std::runtime_error("Tipo de símbolo desconhecido para '" + std::string(identifier.name) + "'.");
+    }
+    // Variáveis guardam o slot; dentro de uma função, o nome dela é o valor de retorno
+    if (symbol->symbolType == SymbolType::FUNCTION) {
+        identifier.storage = identifier.name == currentFunctionName ? Storage::RESULT : Storage::UNRESOLVED;
+        identifier.slot = 0;
     } else {
-        throw std::runtime_error("Tipo de símbolo desconhecido para '" + identifier.name + "'.");
+        identifier.storage = symbol->storage;
+        identifier.slot = symbol->slot;
     }
+    resultType = symbol->type;
+    return Value::Void();
 }
 
 Value SemanticAnalyzer::visitNumber(Number& number) {
-    if (std::floor(number.value) == number.value) {
-        return Value(static_cast<int>(number.value));
-    } else {
-        return Value(number.value);
-    }
+    resultType = number.literal == LiteralKind::REAL ? TypeTable::REAL : TypeTable::INTEGER;
+    return Value::Void();
 }
 
-Value SemanticAnalyzer::visitBooleanLiteral(BooleanLiteral& boolLit) {
-    return Value(boolLit.value);
+Value SemanticAnalyzer::visitBooleanLiteral(BooleanLiteral&) {
+    resultType = TypeTable::BOOLEAN;
+    return Value::Void();
 }
 
 Value SemanticAnalyzer::visitBinaryOperation(BinaryOperation& binOp) {
-    Value leftValue = binOp.left->accept(*this);
-    Value rightValue = binOp.right->accept(*this);
+    TypeId leftType = typeOf(*binOp.left);
+    TypeId rightType = typeOf(*binOp.right);
 
-    std::string leftType = getTypeFromValue(leftValue);
-    std::string rightType = getTypeFromValue(rightValue);
-
-    std::string resultType;
+    TypeId type;
 
     if (binOp.op == OperatorType::ADD ||
         binOp.op == OperatorType::SUBTRACT ||
         binOp.op == OperatorType::MULTIPLY ||
         binOp.op == OperatorType::DIVIDE) {
-        if ((leftType == "INTEGER" || leftType == "REAL") &&
-            (rightType == "INTEGER" || rightType == "REAL")) {
-            resultType = (leftType == "REAL" || rightType == "REAL") ? "REAL" : "INTEGER";
-        } else {
+        type = typeTable().arithmeticResult(leftType, rightType);
+        if (type == NO_TYPE) {
             throw std::runtime_error("Tipos inválidos para operação aritmética.");
         }
     } else if (binOp.op == OperatorType::AND ||
                binOp.op == OperatorType::OR) {
-        if (leftType == "BOOLEAN" && rightType == "BOOLEAN") {
-            resultType = "BOOLEAN";
+        if (leftType == TypeTable::BOOLEAN && rightType == TypeTable::BOOLEAN) {
+            type = TypeTable::BOOLEAN;
         } else {
             throw std::runtime_error("Tipos inválidos para operação lógica.");
         }
@@ -198,7 +582,7 @@ Value SemanticAnalyzer::visitBinaryOperation(BinaryOperation& binOp) {
                binOp.op == OperatorType::GREATER ||
                binOp.op == OperatorType::GREATER_EQUAL) {
         if (leftType == rightType) {
-            resultType = "BOOLEAN";
+            type = TypeTable::BOOLEAN;
         } else {
             throw std::runtime_error("Tipos incompatíveis em operação de comparação.");
         }
@@ -208,37 +592,28 @@ Value SemanticAnalyzer::visitBinaryOperation(BinaryOperation& binOp) {
 
     if (debug) {
         std::cout << "BinaryOperation: op = " << operatorTypeToString(binOp.op)
-                  << ", leftType = " << leftType << ", rightType = " << rightType
-                  << ", resultType = " << resultType << std::endl;
+                  << ", leftType = " << typeTable().toString(leftType) << ", rightType = " << typeTable().toString(rightType)
+                  << ", resultType = " << typeTable().toString(type) << std::endl;
     }
 
-    // Retorna um Value fictício correspondente ao tipo de resultado
-    if (resultType == "INTEGER") {
-        return Value(0);
-    } else if (resultType == "REAL") {
-        return Value(0.0);
-    } else if (resultType == "BOOLEAN") {
-        return Value(true);
-    } else {
-        throw std::runtime_error("Tipo de resultado desconhecido na operação binária.");
-    }
+    resultType = type;
+    return Value::Void();
 }
 
 Value SemanticAnalyzer::visitUnaryOperation(UnaryOperation& unaryOp) {
-    Value operandValue = unaryOp.operand->accept(*this);
-    std::string operandType = getTypeFromValue(operandValue);
+    TypeId operandType = typeOf(*unaryOp.operand);
 
-    std::string resultType;
+    TypeId type;
 
     if (unaryOp.op == OperatorType::NOT) {
-        if (operandType == "BOOLEAN") {
-            resultType = "BOOLEAN";
+        if (operandType == TypeTable::BOOLEAN) {
+            type = TypeTable::BOOLEAN;
         } else {
             throw std::runtime_error("Operando de 'NOT' deve ser BOOLEAN.");
         }
     } else if (unaryOp.op == OperatorType::SUBTRACT) {
-        if (operandType == "INTEGER" || operandType == "REAL") {
-            resultType = operandType;
+        if (typeTable().isNumeric(operandType)) {
+            type = operandType;
         } else {
             throw std::runtime_error("Operando de '-' unário deve ser INTEGER ou REAL.");
         }
@@ -248,83 +623,121 @@ Value SemanticAnalyzer::visitUnaryOperation(UnaryOperation& unaryOp) {
 
     if (debug) {
         std::cout << "UnaryOperation: op = " << operatorTypeToString(unaryOp.op)
-                  << ", operandType = " << operandType << ", resultType = " << resultType << std::endl;
+                  << ", operandType = " << typeTable().toString(operandType) << ", resultType = " << typeTable().toString(type) << std::endl;
     }
 
-    // Retorna um Value fictício correspondente ao tipo de resultado
-    if (resultType == "INTEGER") {
-        return Value(0);
-    } else if (resultType == "REAL") {
-        return Value(0.0);
-    } else if (resultType == "BOOLEAN") {
-        return Value(true);
-    } else {
-        throw std::runtime_error("Tipo de resultado desconhecido na operação unária.");
-    }
+    resultType = type;
+    return Value::Void();
 }
 
 Value SemanticAnalyzer::visitFunctionCall(FunctionCall& funcCall) {
-    auto symbol = symbolTable.resolve(funcCall.functionName);
+    auto symbol = resolve(funcCall.functionName);
+    Function* block = symbol && symbol->symbolType == SymbolType::VARIABLE ? blockOf(symbol->type) : nullptr;
+    if (block) {
+        // Chamada de instância de bloco funcional: executa o bloco sobre o estado da instância
+        funcCall.storage = symbol->storage;
+        funcCall.slot = symbol->slot;
+        funcCall.callee = block;
+        // A assinatura está no símbolo do bloco, no escopo global (não no de uma variável local homônima)
+        checkArguments(funcCall, *globalSymbols().resolve(block->name));
+        resultType = TypeTable::VOID;
+        return Value::Void();
+    }
     if (!symbol || symbol->symbolType != SymbolType::FUNCTION) {
-        throw std::runtime_error("Função '" + funcCall.functionName + "' não foi declarada.");
+        throw std::runtime_error("Função '" + std::string(funcCall.functionName) + "' não foi declarada.");
     }
+    funcCall.storage = Storage::UNRESOLVED;
+    funcCall.callee = pouOf(*symbol);
+    checkArguments(funcCall, *symbol);
 
-    // Verificação de argumentos, se necessário
-    // Atualmente assumimos que as funções não têm parâmetros
-
-    std::string resultType = symbol->type;
+    TypeId type = symbol->type;
     if (debug) {
         std::cout << "FunctionCall: functionName = " << funcCall.functionName
-                  << ", resultType = " << resultType << std::endl;
+                  << ", resultType = " << typeTable().toString(type) << std::endl;
     }
 
-    // Retorna um Value fictício correspondente ao tipo de retorno da função
-    if (resultType == "INTEGER") {
-        return Value(0);
-    } else if (resultType == "REAL") {
-        return Value(0.0);
-    } else if (resultType == "BOOLEAN") {
-        return Value(true);
-    } else {
-        throw std::runtime_error("Tipo de retorno desconhecido para a função '" + funcCall.functionName + "'.");
+    if (!typeTable().isValue(type)) {
+        throw std::runtime_error("Tipo de retorno desconhecido para a função '" + std::string(funcCall.functionName) + "'.");
+    }
+    resultType = type;
+    return Value::Void();
+}
+
+void SemanticAnalyzer::checkArguments(FunctionCall& funcCall, const Symbol& pou) {
+    const SymbolTable& table = globalSymbols();
+    std::span<const Parameter> parameters = table.parameters(pou);
+    std::string callee = "'" + std::string(funcCall.functionName) + "'";
+    std::vector<bool> bound(parameters.size(), false);
+    size_t nextPositional = 0; // Os argumentos posicionais preenchem as entradas em ordem
+    bool named = false;
+
+    for (size_t i = 0; i < funcCall.arguments.size(); i++) {
+        ArgumentBinding& binding = funcCall.bindings[i];
+        const Parameter* parameter;
+        if (binding.parameter.empty()) {
+            if (named) {
+                throw std::runtime_error("Argumento posicional depois de argumento nomeado na chamada de " + callee + ".");
+            }
+            while (nextPositional < parameters.size() && parameters[nextPositional].section != VarSection::INPUT) {
+                nextPositional++;
+            }
+            if (nextPositional == parameters.size()) {
+                throw std::runtime_error("Argumentos demais na chamada de " + callee + ".");
+            }
+            parameter = &parameters[nextPositional++];
+        } else {
+            named = true;
+            parameter = table.findParameter(pou, binding.parameter);
+            std::string name = "'" + std::string(binding.parameter) + "'";
+            if (!parameter) {
+                throw std::runtime_error("Parâmetro " + name + " não existe em " + callee + ".");
+            }
+            if (binding.output && parameter->section != VarSection::OUTPUT) {
+                throw std::runtime_error("Parâmetro " + name + " de " + callee + " não é de saída: use ':='.");
+            }
+            if (!binding.output && parameter->section != VarSection::INPUT) {
+                throw std::runtime_error("Parâmetro " + name + " de " + callee + " é de saída: use '=>'.");
+            }
+        }
+
+        size_t index = static_cast<size_t>(parameter - parameters.data());
+        std::string name = "'" + std::string(table.name(parameter->name)) + "'";
+        if (bound[index]) {
+            throw std::runtime_error("Parâmetro " + name + " recebe mais de um argumento na chamada de " + callee + ".");
+        }
+        bound[index] = true;
+
+        TypeId argumentType = typeOf(*funcCall.arguments[i]);
+        if (binding.output) {
+            // A saída é copiada para o argumento depois da chamada
+            auto target = nodeAs<Identifier>(funcCall.arguments[i].get());
+            if (!target || (target->storage != Storage::GLOBAL && target->storage != Storage::LOCAL)) {
+                throw std::runtime_error("O argumento do parâmetro de saída " + name + " deve ser uma variável.");
+            }
+        }
+        if (argumentType != parameter->type) {
+            throw std::runtime_error("Tipo do argumento '" + typeTable().toString(argumentType) + "' não corresponde ao parâmetro " + name +
+                                     " ('" + typeTable().toString(parameter->type) + "') na chamada de " + callee + ".");
+        }
+        binding.slot = parameter->slot;
     }
 }
 
 Value SemanticAnalyzer::visitArrayAccess(ArrayAccess& arrayAccess) {
-    Value arrayValue = arrayAccess.array->accept(*this);
-    std::string arrayType = getTypeFromValue(arrayValue);
+    TypeId arrayType = typeOf(*arrayAccess.array);
 
     for (auto& indexExpr : arrayAccess.indices) {
-        Value indexValue = indexExpr->accept(*this);
-        std::string indexType = getTypeFromValue(indexValue);
-        if (indexType != "INTEGER") {
+        if (typeOf(*indexExpr) != TypeTable::INTEGER) {
             throw std::runtime_error("Os índices de arrays devem ser do tipo INTEGER.");
         }
     }
 
-    // Retorna um Value fictício correspondente ao tipo base do array
-    if (arrayType == "INTEGER") {
-        return Value(0);
-    } else if (arrayType == "REAL") {
-        return Value(0.0);
-    } else if (arrayType == "BOOLEAN") {
-        return Value(true);
-    } else {
+    // O resultado é o tipo dos elementos do array
+    if (typeTable().kind(arrayType) != TypeKind::ARRAY) {
         throw std::runtime_error("Tipo de array desconhecido.");
     }
-}
-
-std::string SemanticAnalyzer::getTypeFromValue(const Value& value) {
-    switch (value.getType()) {
-        case Value::Type::INTEGER:
-            return "INTEGER";
-        case Value::Type::REAL:
-            return "REAL";
-        case Value::Type::BOOLEAN:
-            return "BOOLEAN";
-        default:
-            return "VOID";
-    }
+    resultType = typeTable().info(arrayType).element;
+    return Value::Void();
 }
 
 void SemanticAnalyzer::setDebug(bool value) {
@@ -3,16 +3,63 @@
 #ifndef SEMANTIC_ANALYZER_HPP
 #define SEMANTIC_ANALYZER_HPP
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "ast.hpp"
+#include "diagnostic.hpp"
 #include "symbol_table.hpp"
+#include "type_table.hpp"
 #include "value.hpp" // Adicionado
 
+// Análise semântica em duas fases:
+//   1. sequencial: registra as POUs, os blocos funcionais, as variáveis de
+//      VAR_GLOBAL e os tipos usados nas declarações de todas as POUs;
+//   2. paralela: verifica o corpo de cada POU numa thread, contra a tabela
+//      global (agora só lida) e uma tabela local própria de cada thread.
+// As declarações globais não dependem da ordem no fonte: uma POU pode usar
+// uma função ou um bloco funcional declarado depois dela.
+//
+// A assinatura de cada POU (VAR_INPUT e VAR_OUTPUT) é coletada na primeira
+// fase. Na segunda, cada chamada tem os argumentos conferidos (posicionais,
+// 'x := valor' e 'y => variável') e é ligada à POU chamada: FunctionCall
+// guarda o nó Function e o slot de cada parâmetro no quadro dele.
+//
+// No modo incremental o analisador guarda, para cada POU verificada, o
+// resultado e as dependências dela em relação ao escopo global: funções
+// chamadas, tipos das declarações (ex.: blocos funcionais das instâncias) e
+// variáveis globais lidas ou escritas, cada uma com uma impressão digital do
+// que o nome significava. Numa nova versão do programa a primeira fase é
+// refeita inteira (é barata) e só são verificadas de novo as POUs novas ou
+// alteradas e aquelas com alguma dependência cuja impressão digital mudou.
 class SemanticAnalyzer : public Visitor {
 public:
     SemanticAnalyzer();
 
+    // Analisa o programa e anota a árvore. Lança std::runtime_error com o
+    // primeiro erro na ordem do fonte; todos ficam em getDiagnostics()
     void analyze(Program* program);
 
+    // Um erro por declaração de nível superior (a análise de uma POU para no
+    // primeiro), na ordem do fonte, qualquer que seja o número de threads
+    const std::vector<Diagnostic>& getDiagnostics() const { return diagnostics; }
+
+    // Threads da segunda fase; 0 (padrão) usa std::thread::hardware_concurrency()
+    void setThreadCount(unsigned count);
+
+    // Liga o modo incremental. Uma POU inalterada é reconhecida por ser o mesmo
+    // nó Function da versão anterior, como nos Programs do IncrementalParser;
+    // o analisador mantém vivos os arenas da última versão analisada.
+    void setIncremental(bool value);
+
+    // POUs verificadas e reaproveitadas na última chamada de analyze()
+    size_t checkedUnits() const { return checked; }
+    size_t reusedUnits() const { return reused; }
+
     // Métodos do Visitor para Statements
     void visitProgram(Program& program) override;
     void visitVariableDeclaration(VariableDeclaration& varDecl) override;
@@ -38,13 +85,111 @@ public:
     // Método para definir o modo de depuração
     void setDebug(bool value);
 
+    // Tipos registrados durante a análise
+    const TypeTable& getTypes() const { return types; }
+
 private:
-    SymbolTable symbolTable;
-    std::string currentFunctionReturnType;
+    // Analisador de POUs da segunda fase, que consulta as declarações de 'global'
+    explicit SemanticAnalyzer(const SemanticAnalyzer* global);
+
+    const SemanticAnalyzer* global = nullptr; // nullptr no analisador principal
+    SymbolTable symbolTable;                  // Globais no principal; locais nos de POU
+    TypeTable types;                          // Só a do principal é usada
+    unsigned threadCount = 0;
+    std::vector<Diagnostic> diagnostics;
+    TypeId currentFunctionReturnType = TypeTable::VOID;
+    std::string_view currentFunctionName;
     bool debug = false;
 
-    // Método auxiliar para obter o tipo a partir de um Value
-    std::string getTypeFromValue(const Value& value);
+    // Os métodos de expressão gravam aqui o tipo calculado e devolvem Value::Void()
+    TypeId resultType = TypeTable::VOID;
+
+    // Slots das variáveis: globais no Program, locais no quadro de cada POU
+    bool insideFunction = false;
+    uint32_t nextGlobalSlot = 0;
+    uint32_t nextLocalSlot = 0;
+
+    // Fase 1: registra a POU e, se 'registerTypes', os tipos das declarações dela
+    void declareFunction(Function& function, bool registerTypes = true);
+
+    // Fase 2: verifica o corpo da POU (num analisador de POU)
+    void checkFunction(Function& function);
+
+    // POUs do programa; o slot de um símbolo de POU é o índice dele aqui
+    std::vector<Function*> pous;
+    std::unordered_map<TypeId, Function*> functionBlocks; // Por tipo das instâncias
+    std::vector<Parameter> signature;                      // Rascunho de declareFunction
+
+    // Tipos e símbolos vistos por este analisador (os do principal, nos de POU)
+    const TypeTable& typeTable() const { return global ? global->types : types; }
+    const SymbolTable& globalSymbols() const { return global ? global->symbolTable : symbolTable; }
+    const Symbol* resolve(std::string_view name) const;
+    Function* pouOf(const Symbol& symbol) const;
+    Function* blockOf(TypeId type) const; // nullptr se 'type' não for bloco funcional
+
+    // Confere os argumentos de uma chamada contra a assinatura de 'pou' e grava as ligações
+    void checkArguments(FunctionCall& funcCall, const Symbol& pou);
+
+    // Modo incremental
+
+    // Nome consultado no escopo global durante a verificação de uma POU
+    struct Lookup {
+        bool isType; // Nome de tipo de uma declaração, ou de símbolo global
+        std::string_view name;
+        bool operator<(const Lookup& other) const {
+            return isType != other.isType ? isType < other.isType : name < other.name;
+        }
+        bool operator==(const Lookup& other) const = default;
+    };
+
+    struct Dependency {
+        bool isType;
+        std::string name;
+        uint64_t fingerprint; // O que o nome significava quando a POU foi verificada
+    };
+
+    // Resultado da última verificação de uma POU
+    struct UnitRecord {
+        std::string error;
+        std::vector<Dependency> dependencies;
+        uint64_t names = 0; // Filtro (um bit por nome) dos nomes das dependências
+    };
+
+    bool incremental = false;
+    std::unordered_map<const Function*, UnitRecord> records;
+    uint64_t globalFingerprint = 0;       // Do escopo global inteiro na última análise
+    std::unique_ptr<Program> retained;    // Mantém vivos os nós guardados em 'records'
+    size_t checked = 0;
+    size_t reused = 0;
+    mutable std::vector<Lookup>* lookups = nullptr; // Nos analisadores de POU, no modo incremental
+
+    uint64_t signatureFingerprint(const Symbol& symbol) const; // Sem os nós Function
+    uint64_t symbolFingerprint(const Symbol& symbol) const;
+    uint64_t symbolFingerprint(std::string_view name) const;
+    uint64_t typeFingerprint(std::string_view name) const;
+    uint64_t scopeFingerprint() const;
+    bool dependenciesChanged(const UnitRecord& record) const;
+    std::vector<Dependency> dependenciesOf(std::vector<Lookup>& unitLookups) const;
+
+    // Fase 2 para as POUs 'functions' (índices em program.statements). Com
+    // 'results', guarda lá o resultado de cada uma, na mesma ordem
+    using StatementError = std::pair<size_t, std::string>; // Índice da declaração de nível superior, mensagem
+    void checkFunctions(Program& program, const std::vector<uint32_t>& functions, std::vector<StatementError>& errors,
+                        std::vector<UnitRecord>* results);
+
+    // Fase 2 no modo incremental: reaproveita as POUs cujas dependências não mudaram
+    void checkChangedFunctions(Program& program, const std::vector<uint32_t>& functions, std::vector<StatementError>& errors);
+
+    // Tipo de uma declaração; nos analisadores de POU, a tabela de tipos está
+    // congelada e o tipo já foi registrado na primeira fase
+    TypeId declaredType(std::string_view name);
+    TypeId declaredArray(TypeId element, std::span<const std::pair<int, int>> dimensions);
+
+    // Visita a expressão, anota o tipo dela no nó e o devolve
+    TypeId typeOf(Expression& expression);
+
+    // Define uma variável ou array no escopo atual e devolve o slot reservado
+    uint32_t defineVariable(std::string_view name, TypeId type, SymbolType symbolType);
 };
 
 #endif // SEMANTIC_ANALYZER_HPP
@@ -0,0 +1,64 @@
+// source_file.cpp
+
+#include "source_file.hpp"
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SOURCE_FILE_HAS_MMAP 1
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+SourceFile::SourceFile(const std::string& path) {
+#ifdef SOURCE_FILE_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Não foi possível abrir o arquivo '" + path + "'.");
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Não foi possível ler o tamanho do arquivo '" + path + "'.");
+    }
+    size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Falha ao mapear o arquivo '" + path + "' em memória.");
+        }
+        // O scanner lê o arquivo do início ao fim
+        ::madvise(addr, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(addr);
+        mapped = true;
+    }
+    ::close(fd);
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Não foi possível abrir o arquivo '" + path + "'.");
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    fallback = contents.str();
+    data = fallback.data();
+    size = fallback.size();
+#endif
+}
+
+SourceFile::~SourceFile() {
+#ifdef SOURCE_FILE_HAS_MMAP
+    if (mapped) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+#endif
+}
+
+std::string_view SourceFile::text() const {
+    return std::string_view(data, size);
+}
@@ -0,0 +1,29 @@
+// source_file.hpp
+
+#ifndef SOURCE_FILE_HPP
+#define SOURCE_FILE_HPP
+
+#include <string>
+#include <string_view>
+
+// Arquivo-fonte mapeado em memória (somente leitura).
+// Os tokens produzidos pelo Scanner apontam diretamente para este mapeamento,
+// portanto o SourceFile deve sobreviver aos tokens e ao parsing.
+class SourceFile {
+public:
+    explicit SourceFile(const std::string& path);
+    ~SourceFile();
+
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    std::string_view text() const;
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    std::string fallback; // Usado quando mmap não está disponível
+};
+
+#endif // SOURCE_FILE_HPP
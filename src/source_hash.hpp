@@ -0,0 +1,35 @@
+// source_hash.hpp
+
+#ifndef SOURCE_HASH_HPP
+#define SOURCE_HASH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// Impressão digital de 64 bits de um trecho do fonte. Processa 8 bytes por
+// iteração (multiplicação e mistura, no estilo do FNV/wyhash), rápido o bastante
+// para recalcular a cada edição. Não é criptográfico: quem reaproveita
+// resultados pelo hash ainda compara o texto quando ele está disponível.
+inline uint64_t hashSource(std::string_view text) {
+    constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ull;
+    uint64_t hash = 0xCBF29CE484222325ull ^ (text.size() * MULTIPLIER);
+    const char* data = text.data();
+    size_t size = text.size();
+    size_t pos = 0;
+    for (; pos + 8 <= size; pos += 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, data + pos, 8);
+        hash = (hash ^ chunk) * MULTIPLIER;
+        hash ^= hash >> 29;
+    }
+    if (pos < size) {
+        uint64_t chunk = 0;
+        std::memcpy(&chunk, data + pos, size - pos);
+        hash = (hash ^ chunk) * MULTIPLIER;
+        hash ^= hash >> 29;
+    }
+    return hash ^ (hash >> 32);
+}
+
+#endif // SOURCE_HASH_HPP
@@ -1,30 +1,89 @@
 // symbol_table.cpp
 
 #include "symbol_table.hpp"
+#include <algorithm>
 
 void SymbolTable::enterScope() {
-    scopes.push_back({});
+    scopeStarts.push_back(static_cast<SymbolIndex>(symbols.size()));
 }
 
 void SymbolTable::exitScope() {
-    scopes.pop_back();
+    SymbolIndex start = scopeStarts.back();
+    scopeStarts.pop_back();
+    while (symbols.size() > start) {
+        const Symbol& symbol = symbols.back();
+        innermost[symbol.name] = symbol.shadowed;
+        symbols.pop_back();
+    }
+}
+
+void SymbolTable::clear() {
+    symbols.clear();
+    std::fill(innermost.begin(), innermost.end(), NO_SYMBOL);
+    scopeStarts.clear();
+    parameterList.clear();
+    signatures.resize(1);
+}
+
+Symbol& SymbolTable::define(std::string_view name, TypeId type, SymbolType symbolType) {
+    NameId id = names.intern(name);
+    if (id >= innermost.size()) {
+        innermost.resize(names.size(), NO_SYMBOL);
+    }
+
+    Symbol& symbol = symbols.emplace_back();
+    symbol.name = id;
+    symbol.type = type;
+    symbol.symbolType = symbolType;
+    symbol.shadowed = innermost[id];
+    innermost[id] = static_cast<SymbolIndex>(symbols.size() - 1);
+    return symbol;
+}
+
+SymbolIndex SymbolTable::visible(std::string_view name) const {
+    NameId id = names.find(name);
+    return id == NO_NAME ? NO_SYMBOL : innermost[id];
+}
+
+Symbol* SymbolTable::resolve(std::string_view name) {
+    SymbolIndex index = visible(name);
+    return index == NO_SYMBOL ? nullptr : &symbols[index];
+}
+
+const Symbol* SymbolTable::resolve(std::string_view name) const {
+    SymbolIndex index = visible(name);
+    return index == NO_SYMBOL ? nullptr : &symbols[index];
+}
+
+bool SymbolTable::declaredInCurrentScope(std::string_view name) const {
+    SymbolIndex index = visible(name);
+    SymbolIndex start = scopeStarts.empty() ? 0 : scopeStarts.back();
+    return index != NO_SYMBOL && index >= start;
+}
+
+void SymbolTable::setParameters(Symbol& symbol, std::span<const Parameter> parameters) {
+    symbol.signature = static_cast<uint32_t>(signatures.size());
+    signatures.emplace_back(static_cast<uint32_t>(parameterList.size()), static_cast<uint32_t>(parameters.size()));
+    parameterList.insert(parameterList.end(), parameters.begin(), parameters.end());
 }
 
-void SymbolTable::define(const std::string& name, const std::string& type, SymbolType symbolType) {
-    Symbol symbol(name, type, symbolType);
-    scopes.back()[name] = symbol;
+std::span<const Parameter> SymbolTable::parameters(const Symbol& symbol) const {
+    auto [first, count] = signatures[symbol.signature];
+    return std::span<const Parameter>(parameterList).subspan(first, count);
 }
 
-Symbol* SymbolTable::resolve(const std::string& name) {
-    for (auto scopeIt = scopes.rbegin(); scopeIt != scopes.rend(); ++scopeIt) {
-        auto it = scopeIt->find(name);
-        if (it != scopeIt->end()) {
-            return &(it->second);
+const Parameter* SymbolTable::findParameter(const Symbol& symbol, std::string_view name) const {
+    NameId id = names.find(name);
+    for (const Parameter& parameter : parameters(symbol)) {
+        if (parameter.name == id) {
+            return &parameter;
         }
     }
     return nullptr;
 }
 
-std::unordered_map<std::string, Symbol>& SymbolTable::currentScope() {
-    return scopes.back();
+size_t SymbolTable::bytesUsed() const {
+    return names.bytesUsed() + symbols.capacity() * sizeof(Symbol) +
+           (innermost.capacity() + scopeStarts.capacity()) * sizeof(uint32_t) + parameterList.capacity() * sizeof(Parameter) +
+           signatures.capacity() * sizeof(std::pair<uint32_t, uint32_t>);
 }
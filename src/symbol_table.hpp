@@ -3,42 +3,102 @@
 #ifndef SYMBOL_TABLE_HPP
 #define SYMBOL_TABLE_HPP
 
-#include <string>
-#include <unordered_map>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <utility>
 #include <vector>
-#include <memory>
+#include "ast.hpp"
+#include "name_table.hpp"
+#include "type_table.hpp"
 
-enum class SymbolType {
+enum class SymbolType : uint8_t {
     VARIABLE,
     FUNCTION,
     ARRAY,
+    FUNCTION_BLOCK,
     // Outros tipos, se necessário
 };
 
-struct Symbol {
-    std::string name;
-    std::string type;
-    SymbolType symbolType;
-    std::vector<std::pair<int, int>> dimensions; // Para arrays
-    std::vector<std::string> parameterTypes;     // Para funções
+// Índice de um símbolo na pilha da SymbolTable
+using SymbolIndex = uint32_t;
+inline constexpr SymbolIndex NO_SYMBOL = std::numeric_limits<SymbolIndex>::max();
 
-    Symbol() = default;
+// Símbolo compacto (24 bytes): o nome é um NameId, os limites de arrays ficam no
+// tipo (TypeTable) e os parâmetros de funções numa lista fora do símbolo
+struct Symbol {
+    NameId name = NO_NAME;
+    TypeId type = NO_TYPE;                 // Para funções, o tipo de retorno
+    SymbolType symbolType = SymbolType::VARIABLE;
+    Storage storage = Storage::UNRESOLVED; // Para variáveis e arrays: onde ficam em execução
+    uint32_t slot = 0;
+    uint32_t signature = 0;                // Para funções: ver SymbolTable::parameters
+    SymbolIndex shadowed = NO_SYMBOL;      // Símbolo de mesmo nome que este esconde
+};
+static_assert(sizeof(Symbol) == 24);
 
-    Symbol(const std::string& name, const std::string& type, SymbolType symbolType)
-        : name(name), type(type), symbolType(symbolType) {}
+// Parâmetro de uma POU (VAR_INPUT ou VAR_OUTPUT), na ordem da declaração
+struct Parameter {
+    NameId name;
+    TypeId type;
+    VarSection section;
+    uint32_t slot; // Slot no quadro da POU
 };
 
+// Tabela de símbolos com escopos aninhados.
+//
+// Os símbolos visíveis ficam numa única pilha, do escopo mais externo ao atual.
+// Para cada nome internado há o índice do símbolo visível mais interno, e cada
+// símbolo aponta para o que ele esconde (cadeia de sombreamento). Assim:
+//   - resolve() é uma busca de hash e um acesso a vetor, qualquer que seja a
+//     profundidade de escopos;
+//   - enterScope() só anota a altura da pilha, sem alocar;
+//   - exitScope() desempilha os k símbolos do escopo restaurando as cadeias
+//     (a própria pilha é o log de desfazer).
+//
+// Referências e ponteiros para símbolos valem até o próximo define().
 class SymbolTable {
 public:
     void enterScope();
     void exitScope();
-    void define(const std::string& name, const std::string& type, SymbolType symbolType);
-    Symbol* resolve(const std::string& name);
+    Symbol& define(std::string_view name, TypeId type, SymbolType symbolType);
+    Symbol* resolve(std::string_view name);
+    const Symbol* resolve(std::string_view name) const;
+
+    // Se 'name' já foi declarado no escopo atual
+    bool declaredInCurrentScope(std::string_view name) const;
+
+    // Parâmetros de uma função; os nomes vêm de intern()
+    void setParameters(Symbol& symbol, std::span<const Parameter> parameters);
+    std::span<const Parameter> parameters(const Symbol& symbol) const;
+    const Parameter* findParameter(const Symbol& symbol, std::string_view name) const;
 
-    std::unordered_map<std::string, Symbol>& currentScope();
+    NameId intern(std::string_view name) { return names.intern(name); }
+    std::string_view name(NameId id) const { return names.name(id); }
+    std::string_view name(const Symbol& symbol) const { return names.name(symbol.name); }
+
+    // Símbolos visíveis, do escopo mais externo ao atual
+    std::span<const Symbol> entries() const { return symbols; }
+
+    // Remove todos os símbolos; os nomes internados (e seus NameIds) são mantidos
+    void clear();
+
+    // Bytes ocupados pela tabela (capacidade reservada incluída)
+    size_t bytesUsed() const;
 
 private:
-    std::vector<std::unordered_map<std::string, Symbol>> scopes = {{}};
+    NameTable names;
+    std::vector<Symbol> symbols;
+    std::vector<SymbolIndex> innermost;   // Por NameId
+    std::vector<SymbolIndex> scopeStarts; // Altura da pilha na entrada de cada escopo aninhado
+
+    // Parâmetros de todas as funções, concatenados; signatures[s] é a faixa da assinatura s
+    // (a assinatura 0 é vazia)
+    std::vector<Parameter> parameterList;
+    std::vector<std::pair<uint32_t, uint32_t>> signatures = {{0, 0}};
+
+    SymbolIndex visible(std::string_view name) const;
 };
 
 #endif // SYMBOL_TABLE_HPP
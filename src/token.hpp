@@ -3,9 +3,10 @@
 #ifndef TOKEN_HPP
 #define TOKEN_HPP
 
-#include <string>
+#include <cstdint>
+#include <string_view>
 
-enum class TokenType {
+enum class TokenType : uint8_t {
     // Tokens de um caractere
     LEFT_PAREN,     // (
     RIGHT_PAREN,    // )
@@ -20,6 +21,7 @@ enum class TokenType {
     STAR,           // *
     SLASH,          // /
     ASSIGNMENT,     // :=
+    OUTPUT_ASSIGNMENT, // => (argumento de saída numa chamada)
     EQUAL_EQUAL,    // ==
     NOT_EQUAL,      // !=
     LESS,           // <
@@ -73,13 +75,31 @@ enum class TokenType {
     TIME_LITERAL
 };
 
+// Valor de literal já decodificado pelo Scanner
+enum class LiteralKind : uint8_t {
+    NONE,
+    INTEGER,    // intValue
+    REAL,       // realValue
+    DURATION    // durationNs (nanossegundos)
+};
+
+// O lexema é uma visão sobre o código-fonte (sem cópia): o buffer do fonte
+// precisa continuar vivo enquanto os tokens forem usados.
 struct Token {
     TokenType type;
-    std::string lexeme;
+    LiteralKind literal = LiteralKind::NONE;
     int line;
+    std::string_view lexeme;
+    union {
+        int64_t intValue;
+        double realValue;
+        int64_t durationNs;
+    };
+
+    Token() : type(TokenType::EOF_TOKEN), line(0), intValue(0) {}
 
-    Token(TokenType type, const std::string& lexeme, int line)
-        : type(type), lexeme(lexeme), line(line) {}
+    Token(TokenType type, std::string_view lexeme, int line)
+        : type(type), line(line), lexeme(lexeme), intValue(0) {}
 };
 
 #endif // TOKEN_HPP
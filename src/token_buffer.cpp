@@ -0,0 +1,78 @@
+// token_buffer.cpp
+
+#include "token_buffer.hpp"
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <stdexcept>
+
+static_assert(sizeof(TokenType) == sizeof(uint8_t), "TokenType deve caber em um byte");
+
+TokenBuffer::TokenBuffer(std::string_view source) : source(source) {
+    if (source.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Código-fonte grande demais para o buffer de tokens.");
+    }
+}
+
+void TokenBuffer::push(const Token& token) {
+    switch (token.literal) {
+        case LiteralKind::INTEGER:
+            literals.push_back({static_cast<uint32_t>(types.size()), token.literal, token.intValue});
+            break;
+        case LiteralKind::REAL:
+            literals.push_back({static_cast<uint32_t>(types.size()), token.literal, std::bit_cast<int64_t>(token.realValue)});
+            break;
+        case LiteralKind::DURATION:
+            literals.push_back({static_cast<uint32_t>(types.size()), token.literal, token.durationNs});
+            break;
+        case LiteralKind::NONE:
+            break;
+    }
+    types.push_back(static_cast<uint8_t>(token.type));
+    offsets.push_back(static_cast<uint32_t>(token.lexeme.data() - source.data()));
+    lengths.push_back(static_cast<uint32_t>(token.lexeme.size()));
+    lines.push_back(static_cast<uint32_t>(token.line));
+}
+
+void TokenBuffer::reserve(size_t count) {
+    types.reserve(count);
+    offsets.reserve(count);
+    lengths.reserve(count);
+    lines.reserve(count);
+}
+
+Token TokenBuffer::token(size_t index) const {
+    Token token(type(index), lexeme(index), line(index));
+    if (token.type != TokenType::NUMBER && token.type != TokenType::TIME_LITERAL) {
+        return token;
+    }
+
+    auto it = std::lower_bound(literals.begin(), literals.end(), index,
+                               [](const Literal& literal, size_t i) { return literal.index < i; });
+    if (it == literals.end() || it->index != index) {
+        return token;
+    }
+    token.literal = it->kind;
+    switch (it->kind) {
+        case LiteralKind::INTEGER:
+            token.intValue = it->bits;
+            break;
+        case LiteralKind::REAL:
+            token.realValue = std::bit_cast<double>(it->bits);
+            break;
+        case LiteralKind::DURATION:
+            token.durationNs = it->bits;
+            break;
+        case LiteralKind::NONE:
+            break;
+    }
+    return token;
+}
+
+double TokenBuffer::bytesPerToken() const {
+    if (types.empty()) return 0;
+    size_t bytes = types.capacity() * sizeof(uint8_t) +
+                   (offsets.capacity() + lengths.capacity() + lines.capacity()) * sizeof(uint32_t) +
+                   literals.capacity() * sizeof(Literal);
+    return static_cast<double>(bytes) / types.size();
+}
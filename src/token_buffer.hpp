@@ -0,0 +1,46 @@
+// token_buffer.hpp
+
+#ifndef TOKEN_BUFFER_HPP
+#define TOKEN_BUFFER_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "token.hpp"
+
+// Fluxo compacto de tokens em estrutura de arrays (SoA): os tipos ficam num
+// array denso de bytes e posição, tamanho e linha em arrays paralelos.
+// Os lexemas são reconstruídos como visões sobre o código-fonte original, e os
+// valores de literais ficam numa tabela à parte, ordenada pelo índice do token.
+class TokenBuffer {
+public:
+    explicit TokenBuffer(std::string_view source);
+
+    void push(const Token& token);
+    void reserve(size_t count);
+
+    size_t size() const { return types.size(); }
+    TokenType type(size_t index) const { return static_cast<TokenType>(types[index]); }
+    std::string_view lexeme(size_t index) const { return std::string_view(source.data() + offsets[index], lengths[index]); }
+    int line(size_t index) const { return static_cast<int>(lines[index]); }
+    Token token(size_t index) const;
+
+    // Bytes ocupados por token (capacidade reservada incluída)
+    double bytesPerToken() const;
+
+private:
+    std::string_view source;
+    std::vector<uint8_t> types;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+    std::vector<uint32_t> lines;
+
+    struct Literal {
+        uint32_t index;
+        LiteralKind kind;
+        int64_t bits; // Inteiro, duração ou bits do double
+    };
+    std::vector<Literal> literals;
+};
+
+#endif // TOKEN_BUFFER_HPP
@@ -0,0 +1,65 @@
+// token_class.hpp
+
+#ifndef TOKEN_CLASS_HPP
+#define TOKEN_CLASS_HPP
+
+#include <cstdint>
+#include <initializer_list>
+#include "token.hpp"
+
+static_assert(static_cast<unsigned>(TokenType::TIME_LITERAL) < 64, "TokenType não cabe numa máscara de 64 bits");
+
+// Conjunto de tipos de token como máscara de bits, montado em tempo de compilação.
+// Testar se um token pertence à classe é um único deslocamento e AND.
+class TokenClass {
+public:
+    constexpr TokenClass(std::initializer_list<TokenType> types) {
+        for (TokenType type : types) {
+            bits |= uint64_t{1} << static_cast<unsigned>(type);
+        }
+    }
+
+    constexpr bool contains(TokenType type) const {
+        return (bits >> static_cast<unsigned>(type)) & 1;
+    }
+
+private:
+    uint64_t bits = 0;
+};
+
+// Classes usadas pelo parser. Nenhuma contém EOF_TOKEN.
+namespace token_class {
+
+// Tipo de variável, de elemento de array ou de retorno
+inline constexpr TokenClass TYPE_NAME{TokenType::REAL, TokenType::INTEGER, TokenType::BOOLEAN, TokenType::IDENTIFIER};
+
+// Início e fim de unidade de programa (POU)
+inline constexpr TokenClass POU_START{TokenType::FUNCTION, TokenType::PROGRAM, TokenType::FUNCTION_BLOCK};
+inline constexpr TokenClass POU_END{TokenType::END_FUNCTION, TokenType::END_PROGRAM, TokenType::END_FUNCTION_BLOCK};
+
+// Seções de parâmetros de uma POU
+inline constexpr TokenClass PARAMETER_SECTION{TokenType::VAR_INPUT, TokenType::VAR_OUTPUT};
+
+// Tokens que encerram o bloco de um IF, WHILE ou FOR
+inline constexpr TokenClass BLOCK_END{TokenType::END_IF, TokenType::ELSE, TokenType::ELSIF,
+                                      TokenType::END_WHILE, TokenType::END_FOR};
+
+// Abertura e fechamento de blocos de comandos
+inline constexpr TokenClass BLOCK_START{TokenType::IF, TokenType::WHILE, TokenType::FOR};
+inline constexpr TokenClass BLOCK_CLOSE{TokenType::END_IF, TokenType::END_WHILE, TokenType::END_FOR};
+
+// Pontos de ressincronização após um erro de sintaxe: tokens que iniciam ou
+// encerram uma construção
+inline constexpr TokenClass SYNC_POINT{TokenType::IF, TokenType::WHILE, TokenType::FOR, TokenType::RETURN,
+                                       TokenType::ELSE, TokenType::ELSIF, TokenType::END_IF,
+                                       TokenType::END_WHILE, TokenType::END_FOR,
+                                       TokenType::VAR, TokenType::VAR_INPUT, TokenType::VAR_OUTPUT,
+                                       TokenType::VAR_GLOBAL, TokenType::END_VAR,
+                                       TokenType::FUNCTION, TokenType::PROGRAM, TokenType::FUNCTION_BLOCK,
+                                       TokenType::END_FUNCTION, TokenType::END_PROGRAM, TokenType::END_FUNCTION_BLOCK};
+
+inline constexpr TokenClass UNARY_OPERATOR{TokenType::NOT, TokenType::MINUS};
+
+} // namespace token_class
+
+#endif // TOKEN_CLASS_HPP
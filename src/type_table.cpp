@@ -0,0 +1,130 @@
+// type_table.cpp
+
+#include "type_table.hpp"
+
+namespace {
+
+// Nomes de ST são ASCII; evita a chamada dependente de locale de std::toupper
+constexpr char upper(char c) {
+    return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+std::string upperCase(std::string_view text) {
+    std::string result(text);
+    for (char& c : result) {
+        c = upper(c);
+    }
+    return result;
+}
+
+// Resultado de uma operação aritmética entre primitivos, indexado por [esquerda][direita]
+constexpr TypeId V = TypeTable::VOID, I = TypeTable::INTEGER, R = TypeTable::REAL, B = TypeTable::BOOLEAN;
+constexpr TypeId ARITHMETIC_RESULT[TypeTable::PRIMITIVE_COUNT][TypeTable::PRIMITIVE_COUNT] = {
+    //            VOID     INTEGER  REAL     BOOLEAN
+    /* VOID    */ {NO_TYPE, NO_TYPE, NO_TYPE, NO_TYPE},
+    /* INTEGER */ {NO_TYPE, I,       R,       NO_TYPE},
+    /* REAL    */ {NO_TYPE, R,       R,       NO_TYPE},
+    /* BOOLEAN */ {NO_TYPE, NO_TYPE, NO_TYPE, NO_TYPE},
+};
+static_assert(V == 0 && B == 3);
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (upper(a[i]) != b[i]) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+TypeTable::TypeTable() {
+    add(TypeKind::VOID, "VOID");
+    add(TypeKind::INTEGER, "INTEGER");
+    add(TypeKind::REAL, "REAL");
+    add(TypeKind::BOOLEAN, "BOOLEAN");
+}
+
+TypeId TypeTable::add(TypeKind kind, std::string name) {
+    TypeId id = static_cast<TypeId>(types.size());
+    byName.emplace(upperCase(name), id);
+    types.push_back(TypeInfo{kind, std::move(name), NO_TYPE, {}});
+    return id;
+}
+
+TypeId TypeTable::find(std::string_view name) const {
+    // Os primitivos são os nomes mais comuns; evita montar a chave para eles
+    for (TypeId id = VOID; id < PRIMITIVE_COUNT; id++) {
+        if (equalsIgnoreCase(name, types[id].name)) return id;
+    }
+    auto it = byName.find(upperCase(name));
+    return it != byName.end() ? it->second : NO_TYPE;
+}
+
+TypeId TypeTable::named(std::string_view name) {
+    TypeId id = find(name);
+    if (id != NO_TYPE) {
+        return id;
+    }
+    return add(TypeKind::USER, std::string(name));
+}
+
+TypeId TypeTable::findArray(TypeId element, std::span<const std::pair<int, int>> dimensions) const {
+    auto it = arrays.find(arrayName(element, dimensions));
+    return it != arrays.end() ? it->second : NO_TYPE;
+}
+
+TypeId TypeTable::arrayOf(TypeId element, std::span<const std::pair<int, int>> dimensions) {
+    std::string key = arrayName(element, dimensions);
+    auto it = arrays.find(key);
+    if (it != arrays.end()) {
+        return it->second;
+    }
+    TypeId id = static_cast<TypeId>(types.size());
+    types.push_back(TypeInfo{TypeKind::ARRAY, "", element, {dimensions.begin(), dimensions.end()}});
+    arrays.emplace(std::move(key), id);
+    return id;
+}
+
+TypeId TypeTable::functionBlock(std::string_view name) {
+    TypeId id = named(name);
+    if (types[id].kind == TypeKind::USER) {
+        types[id].kind = TypeKind::FUNCTION_BLOCK;
+    }
+    return id;
+}
+
+void TypeTable::resetFunctionBlocks() {
+    for (TypeInfo& info : types) {
+        if (info.kind == TypeKind::FUNCTION_BLOCK) {
+            info.kind = TypeKind::USER;
+        }
+    }
+}
+
+std::string TypeTable::toString(TypeId type) const {
+    if (type == NO_TYPE) {
+        return "?";
+    }
+    const TypeInfo& info = types[type];
+    if (info.kind != TypeKind::ARRAY) {
+        return info.name;
+    }
+    return arrayName(info.element, info.dimensions);
+}
+
+std::string TypeTable::arrayName(TypeId element, std::span<const std::pair<int, int>> dimensions) const {
+    std::string text = "ARRAY[";
+    for (size_t i = 0; i < dimensions.size(); i++) {
+        if (i > 0) text += ", ";
+        text += std::to_string(dimensions[i].first) + ".." + std::to_string(dimensions[i].second);
+    }
+    return text + "] OF " + toString(element);
+}
+
+TypeId TypeTable::arithmeticResult(TypeId left, TypeId right) const {
+    if (left >= PRIMITIVE_COUNT || right >= PRIMITIVE_COUNT) {
+        return NO_TYPE;
+    }
+    return ARITHMETIC_RESULT[left][right];
+}
@@ -0,0 +1,95 @@
+// type_table.hpp
+
+#ifndef TYPE_TABLE_HPP
+#define TYPE_TABLE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Identificador de um tipo na TypeTable. Tipos iguais têm o mesmo TypeId,
+// então comparar tipos é comparar inteiros.
+using TypeId = uint32_t;
+inline constexpr TypeId NO_TYPE = std::numeric_limits<TypeId>::max();
+
+enum class TypeKind : uint8_t {
+    VOID,
+    INTEGER,
+    REAL,
+    BOOLEAN,
+    ARRAY,
+    FUNCTION_BLOCK,
+    USER, // Nome de tipo ainda sem definição conhecida
+};
+
+struct TypeInfo {
+    TypeKind kind;
+    std::string name;                            // Nome do tipo (vazio para arrays)
+    TypeId element = NO_TYPE;                    // Para arrays
+    std::vector<std::pair<int, int>> dimensions; // Para arrays
+};
+
+// Tabela de tipos de uma compilação. Cada tipo distinto é registrado uma única
+// vez: nomes são comparados sem diferenciar maiúsculas (como em ST) e arrays
+// pelo tipo do elemento e pelos limites.
+class TypeTable {
+public:
+    // Tipos primitivos, sempre presentes e com estes índices
+    static constexpr TypeId VOID = 0;
+    static constexpr TypeId INTEGER = 1;
+    static constexpr TypeId REAL = 2;
+    static constexpr TypeId BOOLEAN = 3;
+    static constexpr TypeId PRIMITIVE_COUNT = 4;
+
+    TypeTable();
+
+    // Tipo com este nome: primitivo, bloco funcional ou tipo de usuário.
+    // Um nome ainda desconhecido é registrado como USER, pois a declaração
+    // pode vir depois do uso.
+    TypeId named(std::string_view name);
+
+    // Tipo de array com estes limites
+    TypeId arrayOf(TypeId element, std::span<const std::pair<int, int>> dimensions);
+
+    // Registra 'name' como bloco funcional (promove um USER de mesmo nome)
+    TypeId functionBlock(std::string_view name);
+
+    // Volta os blocos funcionais a USER, para registrá-los de novo numa nova
+    // versão do programa sem mudar os TypeIds
+    void resetFunctionBlocks();
+
+    // Consultas sem registro (NO_TYPE se o tipo não existe). Não modificam a
+    // tabela, então podem ser feitas de várias threads ao mesmo tempo.
+    TypeId find(std::string_view name) const;
+    TypeId findArray(TypeId element, std::span<const std::pair<int, int>> dimensions) const;
+
+    const TypeInfo& info(TypeId type) const { return types[type]; }
+    TypeKind kind(TypeId type) const { return types[type].kind; }
+
+    // Nome para mensagens de erro, ex.: "ARRAY[1..3, 0..2] OF REAL"
+    std::string toString(TypeId type) const;
+
+    // Consultas de compatibilidade, resolvidas por tabela para os primitivos
+    bool isNumeric(TypeId type) const { return type == INTEGER || type == REAL; }
+    bool isValue(TypeId type) const { return type > VOID && type < PRIMITIVE_COUNT; }
+
+    // Tipo do resultado de + - * / sobre estes operandos; NO_TYPE se inválido
+    TypeId arithmeticResult(TypeId left, TypeId right) const;
+
+    size_t size() const { return types.size(); }
+
+private:
+    std::vector<TypeInfo> types;
+    std::unordered_map<std::string, TypeId> byName; // Chave em maiúsculas
+    std::unordered_map<std::string, TypeId> arrays; // Chave: toString do array
+
+    TypeId add(TypeKind kind, std::string name);
+    std::string arrayName(TypeId element, std::span<const std::pair<int, int>> dimensions) const;
+};
+
+#endif // TYPE_TABLE_HPP
@@ -0,0 +1,50 @@
+// unit_splitter.cpp
+
+#include "unit_splitter.hpp"
+#include <stdexcept>
+
+UnitSplitter::UnitSplitter(std::string_view source, size_t offset, int line)
+    : source(source), scanner(source.substr(offset), line) {}
+
+bool UnitSplitter::next(UnitBoundary& boundary) {
+    for (;;) {
+        Token token;
+        try {
+            token = scanner.nextToken();
+        } catch (const std::runtime_error&) {
+            continue; // Erros léxicos são relatados pelo parser do trecho
+        }
+        if (token.type == TokenType::EOF_TOKEN) {
+            return false;
+        }
+        size_t offset = static_cast<size_t>(token.lexeme.data() - source.data());
+        switch (token.type) {
+            case TokenType::FUNCTION:
+            case TokenType::FUNCTION_BLOCK:
+            case TokenType::PROGRAM:
+                depth++;
+                if (depth == 1 && !inGlobals) {
+                    boundary = {offset, token.line};
+                    return true;
+                }
+                break;
+            case TokenType::END_FUNCTION:
+            case TokenType::END_FUNCTION_BLOCK:
+            case TokenType::END_PROGRAM:
+                if (depth > 0) depth--;
+                break;
+            case TokenType::VAR_GLOBAL:
+                if (depth == 0 && !inGlobals) {
+                    inGlobals = true;
+                    boundary = {offset, token.line};
+                    return true;
+                }
+                break;
+            case TokenType::END_VAR:
+                if (depth == 0) inGlobals = false;
+                break;
+            default:
+                break;
+        }
+    }
+}
@@ -0,0 +1,34 @@
+// unit_splitter.hpp
+
+#ifndef UNIT_SPLITTER_HPP
+#define UNIT_SPLITTER_HPP
+
+#include <cstddef>
+#include <string_view>
+#include "scanner.hpp"
+
+// Início de uma unidade de nível superior no fonte
+struct UnitBoundary {
+    size_t offset;
+    int line;
+};
+
+// Encontra as fronteiras de FUNCTION, FUNCTION_BLOCK, PROGRAM e VAR_GLOBAL de
+// nível superior, uma por vez. Pode começar no meio do fonte, desde que
+// 'offset' seja o início de uma unidade (fora de comentários e de POUs).
+// Os offsets devolvidos são relativos a 'source' inteiro.
+class UnitSplitter {
+public:
+    UnitSplitter(std::string_view source, size_t offset = 0, int line = 1);
+
+    // Próxima fronteira; false no fim do fonte
+    bool next(UnitBoundary& boundary);
+
+private:
+    std::string_view source;
+    Scanner scanner;
+    int depth = 0;          // Profundidade de FUNCTION/FUNCTION_BLOCK/PROGRAM
+    bool inGlobals = false; // Dentro de VAR_GLOBAL ... END_VAR de nível superior
+};
+
+#endif // UNIT_SPLITTER_HPP